@@ -6,8 +6,28 @@ set -euo pipefail
 # Output:
 #   emulator/web/pong.js
 #   emulator/web/pong.wasm
+#
+# By default the game is driven one game_tick() per iteration from emscripten_set_main_loop
+# (game.c is compiled with GAME_NO_MAIN and panel_emu.c provides main()), so no Asyncify
+# instrumentation is needed.
+#
+# PONG_ASYNCIFY=1 builds the legacy variant instead: game.c's own infinite loop, with delay_ms()
+# yielding through emscripten_sleep() under -sASYNCIFY. It is kept for comparison
+# (see compare_builds.sh).
+#
+# PONG_PARALLEL=1 adds -DPANEL_PARALLEL_SHIFT: HUB75-style six-line parallel shifting
+# (PushColumn) and the matching decoder in panel_emu.c, instead of the serial 192-bit chain.
+#
+# PONG_PROFILE=1 adds -DGAME_PROFILE: game.c times the phases of every tick and the page shows
+# per-phase min/mean/max/p99 live (see game_profile_stats() in game.h).
+#
+# PONG_SCANOUT_ISR=1 adds -DGAME_SCANOUT_ISR: game.c scans the panel from its scan timer handler
+# with double-buffered payload pages; panel_emu.c runs the timer on the virtual clock.
+#
+# OUT_DIR overrides the output directory (default: emulator/web).
 
 ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+OUT_DIR="${OUT_DIR:-$ROOT_DIR/emulator/web}"
 
 # Sanity check
 command -v emcc >/dev/null 2>&1 || {
@@ -15,12 +35,39 @@ command -v emcc >/dev/null 2>&1 || {
   exit 1
 }
 
+if [[ "${PONG_ASYNCIFY:-0}" == "1" ]]; then
+  VARIANT_FLAGS=(-sASYNCIFY -DPANEL_EMU_ASYNCIFY)
+  VARIANT_NAME="Asyncify"
+else
+  VARIANT_FLAGS=(-DGAME_NO_MAIN)
+  VARIANT_NAME="main loop"
+fi
+
+if [[ "${PONG_PARALLEL:-0}" == "1" ]]; then
+  VARIANT_FLAGS+=(-DPANEL_PARALLEL_SHIFT)
+  VARIANT_NAME="$VARIANT_NAME, parallel shift"
+fi
+
+if [[ "${PONG_PROFILE:-0}" == "1" ]]; then
+  VARIANT_FLAGS+=(-DGAME_PROFILE)
+  VARIANT_NAME="$VARIANT_NAME, profiled"
+fi
+
+if [[ "${PONG_SCANOUT_ISR:-0}" == "1" ]]; then
+  VARIANT_FLAGS+=(-DGAME_SCANOUT_ISR)
+  VARIANT_NAME="$VARIANT_NAME, timer scanout"
+fi
+
+mkdir -p "$OUT_DIR"
+
 emcc \
   "$ROOT_DIR/src/game.c" \
+  "$ROOT_DIR/src/input_log.c" \
   "$ROOT_DIR/emulator/src/panel_emu.c" \
+  -I"$ROOT_DIR/src" \
   -O2 \
-  -sASYNCIFY \
+  "${VARIANT_FLAGS[@]}" \
   -sALLOW_MEMORY_GROWTH \
-  -o "$ROOT_DIR/emulator/web/pong.js"
+  -o "$OUT_DIR/pong.js"
 
-echo "Built: emulator/web/pong.js and emulator/web/pong.wasm"
+echo "Built ($VARIANT_NAME): $OUT_DIR/pong.js and $OUT_DIR/pong.wasm"
@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Compare the default main-loop build of the emulator against the legacy Asyncify build.
+#
+# Builds both variants into a temporary directory and reports, for each:
+#   - pong.wasm and pong.js sizes in bytes,
+#   - WebAssembly.compile() + instantiate time for pong.wasm under Node (median of several runs).
+#
+# Per-frame CPU is reported live by the page itself ("CPU/frame" in the header, from the status
+# block's frameWorkUs word), so serve each build and compare the readouts at the same speed.
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+command -v node >/dev/null 2>&1 || {
+  echo "error: node not found (needed to time wasm compilation)." >&2
+  exit 1
+}
+
+OUT_DIR="$WORK_DIR/mainloop" PONG_ASYNCIFY=0 "$ROOT_DIR/emulator/scripts/build_web.sh" >/dev/null
+OUT_DIR="$WORK_DIR/asyncify" PONG_ASYNCIFY=1 "$ROOT_DIR/emulator/scripts/build_web.sh" >/dev/null
+
+printf "%-10s %12s %12s %14s\n" "variant" "wasm_bytes" "js_bytes" "instantiate_ms"
+for variant in mainloop asyncify; do
+  wasm="$WORK_DIR/$variant/pong.wasm"
+  js="$WORK_DIR/$variant/pong.js"
+  instantiate_ms="$(node -e '
+    const bytes = require("fs").readFileSync(process.argv[1]);
+    (async () => {
+      const times = [];
+      for (let i = 0; i < 9; i++) {
+        const start = process.hrtime.bigint();
+        const module = await WebAssembly.compile(bytes);
+        const imports = {};
+        for (const entry of WebAssembly.Module.imports(module)) {
+          imports[entry.module] = imports[entry.module] || {};
+          if (entry.kind === "function") imports[entry.module][entry.name] = () => 0;
+          if (entry.kind === "memory") imports[entry.module][entry.name] = new WebAssembly.Memory({ initial: 256 });
+          if (entry.kind === "table") imports[entry.module][entry.name] = new WebAssembly.Table({ initial: 64, element: "anyfunc" });
+          if (entry.kind === "global") imports[entry.module][entry.name] = 0;
+        }
+        await WebAssembly.instantiate(module, imports);
+        times.push(Number(process.hrtime.bigint() - start) / 1e6);
+      }
+      times.sort((a, b) => a - b);
+      console.log(times[times.length >> 1].toFixed(2));
+    })();
+  ' "$wasm")"
+  printf "%-10s %12d %12d %14s\n" "$variant" "$(wc -c < "$wasm")" "$(wc -c < "$js")" "$instantiate_ms"
+done
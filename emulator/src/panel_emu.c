@@ -7,36 +7,80 @@
 
   It is designed to behave like the coursework STM32 driver:
 
-  - The game code pushes individual bits via PushBit() into a shift-register chain.
+  - The game code pushes bits via PushBit() (or a whole row-pair via PushRow()) into a
+    shift-register chain.
   - The game selects a multiplexed row address with SelectRow().
   - The game calls PrepareLatch() and LatchRegister() to control when shifted bits are committed.
 
   To emulate this faithfully (rather than shortcutting via a framebuffer API), this file:
 
-  1) Stores the most recent 192 shifted bits (2 halves * 3 colour planes * 32 pixels) in an
-     emulated shift-register buffer.
-  2) On LatchRegister(), decodes those bits into a latched 32x32 RGB framebuffer (1-bit per channel).
-  3) Calls a JavaScript renderer (window.Emu.renderFrame) with a pointer to the framebuffer and the
-     currently selected row-pair so the browser can draw either:
-       - an integrated view (what a person perceives), or
-       - a row-scanning debug view (only the currently active row-pair).
+  1) Stores the most recent 192 shifted bits (2 halves * 3 colour planes * 32 pixels) in a
+     packed emulated shift register (three 64-bit words).
+  2) On LatchRegister(), decodes those bits into the latched bit-planes of the selected row-pair.
+     While a row-pair is lit, delay_us() integrates how long each pixel channel has been on, and
+     the 32x32 RGB framebuffer holds the perceived 8-bit intensity (on-time / row dwell * 255).
+     With 1-bit colour that is simply 0 or 255; with Binary Code Modulation (game.c colourDepth
+     > 1, one latch per intensity bit with a dwell weighted by 2^k) it reproduces the grey levels
+     a viewer would see.
+  3) Publishes its output state in a fixed status block in linear memory (EmuStatusBlock below):
+     framebuffer pointer, a generation counter bumped on every complete 16-row scan, the active
+     row-pair, the display-on flag and latch/scan counters. JavaScript keeps a cached typed-array
+     view of the block and pulls from it on its own animation-frame schedule, so in the integrated
+     view (what a person perceives) the game loop makes no output calls into JavaScript at all.
+     Only the row-scan debug view still calls window.Emu.renderFrame on every latch, so scanning
+     can be watched row by row.
 
   Joystick inputs are also emulated here:
   - getRawInput(channel) calls into JavaScript (window.Emu.getAdc) to obtain a value that mimics
     the ADC reading used on the STM32 build.
+  - Every reading since setupPanel() is recorded with its game cycle (input_log.h), so the page
+    can save the session ("Save input") for headless replay with native/bin/pong_replay.
 
-  Timing is handled by delay_ms():
-  - On WASM it yields using emscripten_sleep(), optionally respecting Pause/Step controls exposed
-    by JavaScript.
+  Timing is handled against a virtual clock: delay_us() (and delay_ms()) advances simulated time by
+  the requested time, now_us() reads it, and the emulator keeps simulated time in step with (wall time * speed). The speed
+  (0.1x-16x, or uncapped) is set from the page through the status block. Two builds exist:
+
+  - Default (main-loop) build: game.c is compiled with GAME_NO_MAIN and this file provides main(),
+    which registers runMainLoopFrame() with emscripten_set_main_loop(). Each browser frame runs
+    as many game_tick() calls as the virtual clock allows; delay_us() never blocks, so no Asyncify
+    instrumentation is needed. PANEL_EMU_NO_MAIN leaves main() out, for host harnesses that call
+    game_tick() themselves (native/tests/determinism.c).
+  - Legacy Asyncify build (PANEL_EMU_ASYNCIFY, selected by PONG_ASYNCIFY=1 in build_web.sh):
+    game.c's infinite loop runs as-is and delay_us() yields with emscripten_sleep() whenever
+    simulated time runs a frame ahead of wall time. Kept for comparison.
+
+  Pause/Step controls exposed by JavaScript are honoured in both builds.
+
+  Shift wiring follows panel.h: by default the data input is the serial 192-bit chain described
+  above. Building with PANEL_PARALLEL_SHIFT (PONG_PARALLEL=1 in build_web.sh) switches to the
+  HUB75-style decoder instead: six 32-bit chains, one per data line, clocked a column at a time
+  by PushColumn().
+
+  GAME_SCANOUT_ISR builds (PONG_SCANOUT_ISR=1 in build_web.sh) scan from game.c's timer handler;
+  here the "interrupt" is delivered by waitForInterrupt() on the virtual clock (see below).
+
+  getTimestamp() counts the browser's high-resolution clock in microseconds. In GAME_PROFILE builds
+  (PONG_PROFILE=1 in build_web.sh) the page polls the game's per-phase profile through
+  emu_get_profile_stats() and shows it live.
+
+  Every HAL primitive is counted in the shared counter layer (hal_stats.h). Once a second the page
+  calls emu_sample_hal_metrics() for the rates since its previous call: scans per second, bits
+  and wasted bits per scan, row dwell, ADC reads per tick and calls per tick for each primitive,
+  plus the game's target and measured refresh rates (game_refresh_stats()).
 
   Important: This file must be compiled with Emscripten (emcc) for the web build.
 */
 
 #include "panel.h"
+#include "game.h"
+#include "input_log.h"
+#include "hal_stats.h"
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #ifdef __EMSCRIPTEN__
   #include <emscripten/emscripten.h>
@@ -69,7 +113,7 @@
 
   Parameters:
     - framebuffer_ptr: pointer (in WASM linear memory) to PANEL_PIXEL_WIDTH*PANEL_PIXEL_HEIGHT*3 bytes.
-      Each pixel is stored as three bytes [R,G,B], where each channel is either 0 or 1.
+      Each pixel is stored as three bytes [R,G,B], each a perceived intensity 0..255.
     - active_row_pair: 0..15 indicating the currently selected multiplexed row address.
     - display_on:      0/1 indicating whether the display should be treated as enabled.
 
@@ -103,7 +147,7 @@ EM_JS(int, js_get_adc, (int channel), {
 
   Query JavaScript for whether the emulator is currently paused.
 
-  This allows delay_ms() to yield without running the game loop forward, and enables a step-by-step
+  This allows delay_us() to yield without running the game loop forward, and enables a step-by-step
   mode in the browser UI.
 */
 EM_JS(int, js_is_paused, (), {
@@ -118,7 +162,7 @@ EM_JS(int, js_is_paused, (), {
 
   Query JavaScript for whether a "single step" token is available.
 
-  When paused, delay_ms() will return once if a step token is consumed, letting the game advance
+  When paused, delay_us() will return once if a step token is consumed, letting the game advance
   in controlled increments.
 */
 EM_JS(int, js_consume_step, (), {
@@ -128,42 +172,82 @@ EM_JS(int, js_consume_step, (), {
   return 0;
 });
 
-/*
-  js_set_display_state
-
-  Notify JavaScript of whether the display should be treated as enabled.
-
-  This is used purely for UI/state display (e.g., showing "Display: on/off"), and does not affect
-  the underlying framebuffer state.
-*/
-EM_JS(void, js_set_display_state, (int on), {
-  if (window.EmuUI && typeof window.EmuUI.setDisplayEnabled === "function") {
-    window.EmuUI.setDisplayEnabled(!!on);
-  }
-});
-
 #else
-// Non-Emscripten stubs so the file can be compiled outside the browser if needed.
-static void js_render_frame(const uint8_t* framebuffer_ptr, int active_row_pair, int display_on) {
+// Non-Emscripten stubs so the file can be compiled outside the browser, e.g. into the native
+// determinism trace (native/tests/cross_target.sh). ADC readings then come from an optional host
+// callback (emu_host_set_input) instead of the page.
+static uint32_t (*hostInputHook)(int channel) = NULL;
+
+static inline void js_render_frame(const uint8_t* framebuffer_ptr, int active_row_pair, int display_on) {
   (void)framebuffer_ptr; (void)active_row_pair; (void)display_on;
 }
-static int js_get_adc(int channel) { (void)channel; return 0; }
-static int js_is_paused(void) { return 0; }
-static int js_consume_step(void) { return 0; }
-static void js_set_display_state(int on) { (void)on; }
+static inline int js_get_adc(int channel) {
+  return (hostInputHook != NULL) ? (int)hostInputHook(channel) : 0;
+}
+static inline int js_is_paused(void) { return 0; }
+static inline int js_consume_step(void) { return 0; }
 #endif
 
+// -----------------------------------------------------------------------------
+// Virtual clock (delay_us pacing)
+// -----------------------------------------------------------------------------
+
+// Wall-clock slack allowed before yielding: roughly one display frame.
+#define VIRTUAL_CLOCK_YIELD_MS        16.0
+
+// If simulated time falls this far behind (slow device, background tab), stop trying to catch up
+// and re-anchor the clock rather than running a burst of frames.
+#define VIRTUAL_CLOCK_MAX_LAG_MS      250.0
+
+// Speed multiplier in percent (100 = real time). 0 selects uncapped mode.
+#define VIRTUAL_CLOCK_DEFAULT_PERCENT 100u
+#define VIRTUAL_CLOCK_MIN_PERCENT     10u
+#define VIRTUAL_CLOCK_MAX_PERCENT     1600u
+
 // -----------------------------------------------------------------------------
 // Emulated panel internal state
 // -----------------------------------------------------------------------------
 
-// Latched 32x32 framebuffer stored as [R,G,B] bytes per pixel (each channel is 0 or 1).
+// Perceived 32x32 framebuffer stored as [R,G,B] bytes per pixel (each channel 0..255).
 static uint8_t latchedFramebufferRgb[PANEL_PIXEL_WIDTH * PANEL_PIXEL_HEIGHT * 3];
 
-// Most recent shifted bits, stored as a circular buffer to emulate a shift-register chain.
-static uint8_t shiftRegisterBits[PANEL_SHIFT_BITS];
-static int shiftRegisterOldestIndex = 0;  // index of the oldest (first) bit in the circular buffer
-static int shiftRegisterBitCount = 0;     // number of valid bits currently stored (<= PANEL_SHIFT_BITS)
+// Latched output bits: one 32-bit mask per row and colour plane (bit x = pixel x).
+static uint32_t latchedPlanes[PANEL_PIXEL_HEIGHT][3];
+
+/*
+  Dwell integration for perceived intensity.
+
+  rowPairDwellUs[r] is the time in microseconds row-pair r has been lit since it was last selected,
+  and pixelOnUs[] the part of that time each pixel channel was on. Both restart whenever the scan
+  moves to a different row-pair, so they always cover the most recent visit (all its BCM planes).
+*/
+static uint32_t rowPairDwellUs[PANEL_ROW_PAIRS];
+static uint32_t pixelOnUs[PANEL_PIXEL_WIDTH * PANEL_PIXEL_HEIGHT * 3];
+
+/*
+  Most recent shifted bits, stored as a packed 192-bit shift register.
+
+  Logical bit i (0 = oldest, 191 = most recently pushed) lives in shiftRegisterWords[i / 64],
+  bit (i % 64). Pushing a bit shifts the whole register one place towards index 0, dropping the
+  oldest bit, so once more than PANEL_SHIFT_BITS bits have been pushed the last 192 win, exactly
+  as in a fixed-length register chain.
+
+  With the game's push order each colour plane occupies one 32-bit half of a word (pixel x in bit
+  x), which is the PANEL_ROW_WORDS payload layout from panel.h.
+*/
+static uint64_t shiftRegisterWords[3];
+
+#ifdef PANEL_PARALLEL_SHIFT
+/*
+  HUB75 parallel data chains (PANEL_PARALLEL_SHIFT builds).
+
+  parallelChains[c] is the 32-bit chain fed by data line c (R1,G1,B1,R2,G2,B2, i.e. the
+  PANEL_COLUMN_* bit order). Each clock shifts every chain one place towards bit 0 and enters the
+  new column at bit 31, so after 32 columns the first one pushed sits at pixel 0 and chain c is
+  exactly payload word c.
+*/
+static uint32_t parallelChains[6];
+#endif
 
 // Current multiplexed row address (0..15). This selects a row-pair: top=r, bottom=r+16.
 static int selectedRowPairIndex = 0;
@@ -172,46 +256,142 @@ static int selectedRowPairIndex = 0;
 static bool latchLineIsLow = false;
 static bool displayIsEnabled = true;
 
+// Output-enable line (SetOutputEnable). While false every LED is blanked.
+static bool outputIsEnabled = true;
+
+// Latches since the last complete scan (copied into the status block when a scan completes).
+static uint32_t latchesInCurrentScan = 0;
+
+// Input recording since setupPanel(), and the last copy handed to JavaScript (with its end record).
+static InputLogWriter inputRecording;
+static InputLogWriter inputRecordingSnapshot;
+
+// Per-phase profile handed to JavaScript by emu_get_profile_stats().
+static uint32_t profileTable[GAME_PROFILE_PHASES][5];
+
+// HAL call counters (hal_stats.h), and the snapshot emu_sample_hal_metrics() last measured from.
+HalStats halStats;
+static HalStats halStatsSampled;
+static double halStatsSampledWallMs = 0.0;
+static int32_t halStatsSampledCycle = 0;
+
+// Metrics handed to JavaScript by emu_sample_hal_metrics() (layout documented there).
+#define HAL_METRIC_WORDS 21
+static double halMetrics[HAL_METRIC_WORDS];
+
+static double readWallClockMs(void);
+
+/*
+  EmuStatusBlock
+
+  Output state shared with JavaScript through linear memory. emulator.js obtains its address once
+  via emu_get_status_block() and reads it through a cached Uint32Array, rebuilding the view only
+  when WASM memory grows. Every field is 32 bits; the word offsets below are part of the contract
+  with emulator.js (STATUS_* constants) and must stay in sync.
+
+    [0] framebufferPtr    address of latchedFramebufferRgb
+    [1] framebufferBytes  size of the framebuffer in bytes
+    [2] generation        incremented every time a complete 16-row scan has been latched
+    [3] activeRowPair     row-pair selected at the most recent latch (0..15)
+    [4] displayOn         1 while the latch is high and output is enabled (display showing),
+                          0 while shifting or blanked
+    [5] latchCount        cumulative LatchRegister() calls
+    [6] scanCount         cumulative complete scans
+    [7] latchesInLastScan latches it took to complete the most recent scan (16 in normal scanning)
+    [8] rowScanMode       written by JavaScript: non-zero selects the row-scan debug view, in which
+                          LatchRegister() renders every latch via js_render_frame
+    [9] speedPercent      written by JavaScript: simulation speed in percent of real time
+                          (10..1600), or 0 for uncapped
+   [10] virtualTimeMs     simulated milliseconds accumulated by delay_us() (wraps at 2^32)
+   [11] yieldCount        number of times the game has yielded to the browser (one per main-loop
+                          frame, or per emscripten_sleep() in the Asyncify build)
+   [12] frameWorkUs       wall time spent running the game between the two most recent yields,
+                          in microseconds
+   [13] buildVariant      0 = main-loop build, 1 = legacy Asyncify build
+*/
+typedef struct {
+  uint32_t framebufferPtr;
+  uint32_t framebufferBytes;
+  uint32_t generation;
+  uint32_t activeRowPair;
+  uint32_t displayOn;
+  uint32_t latchCount;
+  uint32_t scanCount;
+  uint32_t latchesInLastScan;
+  uint32_t rowScanMode;
+  uint32_t speedPercent;
+  uint32_t virtualTimeMs;
+  uint32_t yieldCount;
+  uint32_t frameWorkUs;
+  uint32_t buildVariant;
+} EmuStatusBlock;
+
+static EmuStatusBlock statusBlock;
+
+/*
+  Virtual clock anchor.
+
+  Simulated time since the anchor, divided by the speed, is the wall time the game "should" have
+  taken. The anchor is reset whenever that relationship stops holding (speed change, pause, a long
+  stall), so none of those cause a burst of catch-up frames or a long sleep.
+*/
+static double virtualClockMs = 0.0;
+static double anchorVirtualMs = 0.0;
+static double anchorWallMs = 0.0;
+static double lastYieldWallMs = 0.0;
+static uint32_t anchorSpeedPercent = VIRTUAL_CLOCK_DEFAULT_PERCENT;
+
 /*
   shiftRegisterPushBit
 
-  Append one bit into the emulated shift-register buffer.
+  Shift one bit into the packed register.
 
   On the real panel, each clock pulse pushes the input bit one position along a chain of registers.
-  In this emulator we model that by storing the most recent PANEL_SHIFT_BITS bits. When more than
-  PANEL_SHIFT_BITS bits are pushed, the oldest bits are overwritten (exactly how a fixed-length
-  shift register behaves).
+  Here every word moves one place towards the oldest end (carrying its lowest bit into the top of
+  the previous word) and the new bit enters at logical index 191. The bit that falls off the
+  bottom of word 0 is the oldest one, which is how a fixed-length shift register overflows.
 */
 static inline void shiftRegisterPushBit(uint8_t bitValue) {
-  bitValue = (bitValue ? 1u : 0u);
-
-  if (shiftRegisterBitCount < PANEL_SHIFT_BITS) {
-    int writeIndex = (shiftRegisterOldestIndex + shiftRegisterBitCount) % PANEL_SHIFT_BITS;
-    shiftRegisterBits[writeIndex] = bitValue;
-    shiftRegisterBitCount++;
-  } else {
-    // Overwrite the oldest bit and advance the "oldest" pointer.
-    shiftRegisterOldestIndex = (shiftRegisterOldestIndex + 1) % PANEL_SHIFT_BITS;
-    int writeIndex = (shiftRegisterOldestIndex + PANEL_SHIFT_BITS - 1) % PANEL_SHIFT_BITS;
-    shiftRegisterBits[writeIndex] = bitValue;
-  }
+  shiftRegisterWords[0] = (shiftRegisterWords[0] >> 1) | (shiftRegisterWords[1] << 63);
+  shiftRegisterWords[1] = (shiftRegisterWords[1] >> 1) | (shiftRegisterWords[2] << 63);
+  shiftRegisterWords[2] = (shiftRegisterWords[2] >> 1) | ((uint64_t)(bitValue & 1u) << 63);
 }
 
 /*
-  shiftRegisterGetBit
-
-  Read a bit from the emulated shift-register buffer using a logical index.
+  shiftRegisterGetPlane
 
-  Parameters:
-    - logicalIndex: 0..PANEL_SHIFT_BITS-1, where 0 refers to the oldest stored bit and
-      PANEL_SHIFT_BITS-1 refers to the most recently pushed bit.
+  Return 32 consecutive logical bits starting at 32 * planeIndex (0..5) as one word, with the
+  oldest of them in bit 0.
 
   This indexing scheme matches how the game builds up each row payload: the first bits pushed
-  correspond to the earliest colour plane positions.
+  correspond to the earliest colour plane positions, so plane 0 is the top-row red plane and
+  bit x of it is pixel x.
+*/
+static inline uint32_t shiftRegisterGetPlane(int planeIndex) {
+  return (uint32_t)(shiftRegisterWords[planeIndex >> 1] >> ((planeIndex & 1) * 32));
+}
+
+/*
+  writeRowIntensities
+
+  Write the perceived [R,G,B] bytes of row y. With `fromLatchedBits`, each lit channel is shown at
+  full intensity; otherwise the channel's share of the row-pair's dwell is scaled to 0..255.
 */
-static inline uint8_t shiftRegisterGetBit(int logicalIndex) {
-  int physicalIndex = (shiftRegisterOldestIndex + logicalIndex) % PANEL_SHIFT_BITS;
-  return shiftRegisterBits[physicalIndex] & 1u;
+static void writeRowIntensities(int y, bool fromLatchedBits) {
+  uint8_t* row = &latchedFramebufferRgb[(y * PANEL_PIXEL_WIDTH) * 3];
+  const uint32_t* onUs = &pixelOnUs[(y * PANEL_PIXEL_WIDTH) * 3];
+  const uint32_t dwellUs = rowPairDwellUs[y & 0x0F];
+
+  for (int x = 0; x < PANEL_PIXEL_WIDTH; x++) {
+    for (int plane = 0; plane < 3; plane++) {
+      const int i = x * 3 + plane;
+      if (fromLatchedBits || dwellUs == 0) {
+        row[i] = ((latchedPlanes[y][plane] >> x) & 1u) ? 255u : 0u;
+      } else {
+        row[i] = (uint8_t)(((uint64_t)onUs[i] * 255u + dwellUs / 2u) / dwellUs);
+      }
+    }
+  }
 }
 
 /*
@@ -236,33 +416,199 @@ static inline uint8_t shiftRegisterGetBit(int logicalIndex) {
 */
 static void commitShiftRegisterToFramebufferForSelectedRow(void) {
   const int rowPair = (selectedRowPairIndex & 0x0F);
-  const int topRowY = rowPair;
-  const int bottomRowY = rowPair + 16;
 
-  for (int x = 0; x < PANEL_PIXEL_WIDTH; x++) {
-    // Top row planes
-    uint8_t topR = shiftRegisterGetBit(0 * PANEL_PIXEL_WIDTH + x);
-    uint8_t topG = shiftRegisterGetBit(1 * PANEL_PIXEL_WIDTH + x);
-    uint8_t topB = shiftRegisterGetBit(2 * PANEL_PIXEL_WIDTH + x);
-
-    // Bottom row planes
-    uint8_t bottomR = shiftRegisterGetBit(3 * PANEL_PIXEL_WIDTH + x);
-    uint8_t bottomG = shiftRegisterGetBit(4 * PANEL_PIXEL_WIDTH + x);
-    uint8_t bottomB = shiftRegisterGetBit(5 * PANEL_PIXEL_WIDTH + x);
-
-    int topPixelIndex = (topRowY * PANEL_PIXEL_WIDTH + x) * 3;
-    int bottomPixelIndex = (bottomRowY * PANEL_PIXEL_WIDTH + x) * 3;
-
-    latchedFramebufferRgb[topPixelIndex + 0] = topR;
-    latchedFramebufferRgb[topPixelIndex + 1] = topG;
-    latchedFramebufferRgb[topPixelIndex + 2] = topB;
-
-    latchedFramebufferRgb[bottomPixelIndex + 0] = bottomR;
-    latchedFramebufferRgb[bottomPixelIndex + 1] = bottomG;
-    latchedFramebufferRgb[bottomPixelIndex + 2] = bottomB;
+  // Top row planes, then bottom row planes (see the push order above). In parallel builds the
+  // six data chains already hold one plane each.
+  for (int plane = 0; plane < 3; plane++) {
+#ifdef PANEL_PARALLEL_SHIFT
+    latchedPlanes[rowPair][plane] = parallelChains[plane];
+    latchedPlanes[rowPair + 16][plane] = parallelChains[plane + 3];
+#else
+    latchedPlanes[rowPair][plane] = shiftRegisterGetPlane(plane);
+    latchedPlanes[rowPair + 16][plane] = shiftRegisterGetPlane(plane + 3);
+#endif
+  }
+
+  // Until this visit has dwelt, show the latched bits at full intensity.
+  if (rowPairDwellUs[rowPair] == 0) {
+    writeRowIntensities(rowPair, true);
+    writeRowIntensities(rowPair + 16, true);
   }
 }
 
+/*
+  integrateDwell
+
+  Account for `us` microseconds during which the selected row-pair shows its latched bits: add the
+  time to the row-pair's dwell and to every lit pixel channel, then refresh the perceived
+  intensities of both rows.
+*/
+static void integrateDwell(uint32_t us) {
+  if (us == 0 || !displayIsEnabled || !outputIsEnabled) return;
+
+  const int rowPair = (selectedRowPairIndex & 0x0F);
+  rowPairDwellUs[rowPair] += us;
+
+  for (int half = 0; half < 2; half++) {
+    const int y = rowPair + half * PANEL_ROW_PAIRS;
+    for (int plane = 0; plane < 3; plane++) {
+      uint32_t bits = latchedPlanes[y][plane];
+      while (bits) {
+        const int x = __builtin_ctz(bits);
+        bits &= bits - 1;
+        pixelOnUs[(y * PANEL_PIXEL_WIDTH + x) * 3 + plane] += us;
+      }
+    }
+    writeRowIntensities(y, false);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Functions exported to JavaScript
+// -----------------------------------------------------------------------------
+
+#ifndef EMSCRIPTEN_KEEPALIVE
+  #define EMSCRIPTEN_KEEPALIVE
+#endif
+
+/*
+  emu_get_status_block
+
+  Return the address of the EmuStatusBlock in linear memory. Called once by emulator.js after the
+  runtime initialises; the address never changes.
+*/
+EMSCRIPTEN_KEEPALIVE EmuStatusBlock* emu_get_status_block(void) {
+  return &statusBlock;
+}
+
+/*
+  emu_snapshot_input_recording
+
+  Copy the input recording so far, terminated with an end record at the current game cycle, and
+  return the copy's address in linear memory (0 if out of memory). Its length is returned by
+  emu_input_recording_snapshot_length(). The copy stays valid until the next snapshot; recording
+  carries on.
+*/
+EMSCRIPTEN_KEEPALIVE const uint8_t* emu_snapshot_input_recording(void) {
+  inputLogWriterFree(&inputRecordingSnapshot);
+
+  inputRecordingSnapshot = inputRecording;
+  inputRecordingSnapshot.bytes = (uint8_t*)malloc(inputRecording.capacity);
+  if (inputRecordingSnapshot.bytes == NULL) {
+    memset(&inputRecordingSnapshot, 0, sizeof(inputRecordingSnapshot));
+    return NULL;
+  }
+  memcpy(inputRecordingSnapshot.bytes, inputRecording.bytes, inputRecording.length);
+  if (!inputLogWriteEnd(&inputRecordingSnapshot, game_cycle())) {
+    inputLogWriterFree(&inputRecordingSnapshot);
+    return NULL;
+  }
+  return inputRecordingSnapshot.bytes;
+}
+
+EMSCRIPTEN_KEEPALIVE uint32_t emu_input_recording_snapshot_length(void) {
+  return (uint32_t)inputRecordingSnapshot.length;
+}
+
+/*
+  emu_get_profile_stats
+
+  Refresh the profile table and return its address: GAME_PROFILE_PHASES rows (GameProfilePhase
+  order) of five words each (samples, min, mean, max, p99 in nanoseconds; see
+  game_profile_stats()). Returns 0 when the build has no GAME_PROFILE or no tick has completed.
+*/
+EMSCRIPTEN_KEEPALIVE const uint32_t* emu_get_profile_stats(void) {
+  for (int phase = 0; phase < GAME_PROFILE_PHASES; phase++) {
+    GameProfileStats stats;
+    if (!game_profile_stats(phase, &stats)) return NULL;
+    profileTable[phase][0] = stats.samples;
+    profileTable[phase][1] = stats.minNs;
+    profileTable[phase][2] = stats.meanNs;
+    profileTable[phase][3] = stats.maxNs;
+    profileTable[phase][4] = stats.p99Ns;
+  }
+  return &profileTable[0][0];
+}
+
+/*
+  emu_sample_hal_metrics
+
+  Measure the HAL counters since the previous call (or setupPanel()) and return the address of
+  HAL_METRIC_WORDS doubles:
+
+    0 wall seconds measured       5 wasted bits per scan
+    1 game ticks measured         6 shift clocks per scan
+    2 complete scans per second   7 dwell per row visit (simulated ms)
+    3 latches per scan            8 ADC reads (getRawInput) per tick
+    4 bits shifted per scan       9..18 calls per tick: PushBit, PushRow, PushColumn, SelectRow,
+                                        PrepareLatch, LatchRegister, ClearRow, SetOutputEnable,
+                                        getRawInput, delay_us
+                                  19 target refresh rate (Hz)   20 measured refresh rate (Hz)
+*/
+EMSCRIPTEN_KEEPALIVE const double* emu_sample_hal_metrics(void) {
+  const double nowMs = readWallClockMs();
+  const int32_t nowCycle = game_cycle();
+  const double ticks = (double)(nowCycle - halStatsSampledCycle);
+
+  HalStatsDerived derived;
+  halStatsDerive(&halStatsSampled, &halStats, (nowMs - halStatsSampledWallMs) / 1000.0, ticks, &derived);
+  halMetrics[0] = derived.seconds;
+  halMetrics[1] = derived.ticks;
+  halMetrics[2] = derived.scansPerSecond;
+  halMetrics[3] = derived.latchesPerScan;
+  halMetrics[4] = derived.bitsPerScan;
+  halMetrics[5] = derived.wastedBitsPerScan;
+  halMetrics[6] = derived.clocksPerScan;
+  halMetrics[7] = derived.dwellMsPerRow;
+  halMetrics[8] = derived.adcReadsPerTick;
+
+  const uint64_t calls[10] = {
+    halStats.pushBitCalls - halStatsSampled.pushBitCalls,
+    halStats.pushRowCalls - halStatsSampled.pushRowCalls,
+    halStats.pushColumnCalls - halStatsSampled.pushColumnCalls,
+    halStats.selectRowCalls - halStatsSampled.selectRowCalls,
+    halStats.prepareLatchCalls - halStatsSampled.prepareLatchCalls,
+    halStats.latches - halStatsSampled.latches,
+    halStats.clearRowCalls - halStatsSampled.clearRowCalls,
+    halStats.outputEnableCalls - halStatsSampled.outputEnableCalls,
+    halStats.rawInputCalls - halStatsSampled.rawInputCalls,
+    halStats.delayCalls - halStatsSampled.delayCalls,
+  };
+  for (int i = 0; i < 10; i++) {
+    halMetrics[9 + i] = (ticks > 0) ? (double)calls[i] / ticks : 0.0;
+  }
+
+  GameRefreshStats refresh;
+  game_refresh_stats(&refresh);
+  halMetrics[19] = (refresh.targetPeriodUs > 0) ? 1e6 / (double)refresh.targetPeriodUs : 0.0;
+  halMetrics[20] = (refresh.measuredPeriodUs > 0) ? 1e6 / (double)refresh.measuredPeriodUs : 0.0;
+
+  halStatsSampled = halStats;
+  halStatsSampledWallMs = nowMs;
+  halStatsSampledCycle = nowCycle;
+  return halMetrics;
+}
+
+#ifndef __EMSCRIPTEN__
+/*
+  emu_host_set_input / emu_host_get_pixel
+
+  Host builds only: supply the getRawInput() readings from a callback (NULL reads 0), and read back
+  the latched bits of pixel (x, y) as bit 0 red, bit 1 green, bit 2 blue (0 when out of range), the
+  encoding of panelNativeGetPixel(), so the native trace harness can run on this backend.
+*/
+void emu_host_set_input(uint32_t (*hook)(int channel)) {
+  hostInputHook = hook;
+}
+
+uint8_t emu_host_get_pixel(int x, int y) {
+  if (x < 0 || x >= PANEL_PIXEL_WIDTH || y < 0 || y >= PANEL_PIXEL_HEIGHT) return 0;
+  return (uint8_t)(((latchedPlanes[y][0] >> x) & 1u) |
+                   (((latchedPlanes[y][1] >> x) & 1u) << 1) |
+                   (((latchedPlanes[y][2] >> x) & 1u) << 2));
+}
+#endif
+
 // -----------------------------------------------------------------------------
 // panel.h API implementations (Web/WASM)
 // -----------------------------------------------------------------------------
@@ -272,22 +618,49 @@ static void commitShiftRegisterToFramebufferForSelectedRow(void) {
 
   Initialise the emulated panel state.
 
-  This clears the latched framebuffer (all pixels off), clears the shift-register buffer, and
-  resets the selected row address to a known value. The shift register is treated as "fully valid"
-  containing zeros so that early reads behave deterministically.
+  This clears the latched framebuffer (all pixels off), clears the shift register, and resets the
+  selected row address to a known value. The shift register starts out holding 192 zeros so that
+  early reads behave deterministically.
 
-  The emulator also notifies the UI that the display is enabled.
+  It also (re)initialises the status block shared with JavaScript, with the display enabled.
 */
 void setupPanel(void) {
   memset(latchedFramebufferRgb, 0, sizeof(latchedFramebufferRgb));
-  memset(shiftRegisterBits, 0, sizeof(shiftRegisterBits));
-  shiftRegisterOldestIndex = 0;
-  shiftRegisterBitCount = PANEL_SHIFT_BITS; // treat as fully initialised with zeros
+  memset(latchedPlanes, 0, sizeof(latchedPlanes));
+  memset(rowPairDwellUs, 0, sizeof(rowPairDwellUs));
+  memset(pixelOnUs, 0, sizeof(pixelOnUs));
+  memset(shiftRegisterWords, 0, sizeof(shiftRegisterWords));
+#ifdef PANEL_PARALLEL_SHIFT
+  memset(parallelChains, 0, sizeof(parallelChains));
+#endif
   selectedRowPairIndex = 0;
   latchLineIsLow = false;
   displayIsEnabled = true;
+  outputIsEnabled = true;
+  latchesInCurrentScan = 0;
+
+  halStatsReset(&halStats);
+  halStatsSampled = halStats;
+  halStatsSampledWallMs = readWallClockMs();
+  halStatsSampledCycle = 0;
+
+  inputLogWriterFree(&inputRecording);
+  inputLogWriterInit(&inputRecording);
+
+  memset(&statusBlock, 0, sizeof(statusBlock));
+  statusBlock.framebufferPtr = (uint32_t)(uintptr_t)latchedFramebufferRgb;
+  statusBlock.framebufferBytes = (uint32_t)sizeof(latchedFramebufferRgb);
+  statusBlock.displayOn = 1;
+  statusBlock.speedPercent = VIRTUAL_CLOCK_DEFAULT_PERCENT;
+#ifdef PANEL_EMU_ASYNCIFY
+  statusBlock.buildVariant = 1;
+#endif
 
-  js_set_display_state(1);
+  virtualClockMs = 0.0;
+  anchorVirtualMs = 0.0;
+  anchorWallMs = 0.0;
+  lastYieldWallMs = 0.0;
+  anchorSpeedPercent = VIRTUAL_CLOCK_DEFAULT_PERCENT;
 }
 
 /*
@@ -309,14 +682,26 @@ void setupInput(void) {
 
   The browser supplies joystick position via sliders/keyboard. emulator.js maps that position into
   a raw value that mimics what the STM32 ADC would return, and this function forwards the request
-  to that JS mapping.
+  to that JS mapping. The reading is appended to the session's input recording.
 */
 uint32_t getRawInput(int channelValue) {
+  halStatsRawInput(&halStats);
   int raw = js_get_adc(channelValue);
   if (raw < 0) raw = 0;
+  inputLogWrite(&inputRecording, game_cycle(), channelValue, (uint32_t)raw);
   return (uint32_t)raw;
 }
 
+/*
+  publishDisplayState
+
+  The panel shows light only while the latch is high and output is enabled; mirror that into the
+  status block's displayOn word.
+*/
+static void publishDisplayState(void) {
+  statusBlock.displayOn = (displayIsEnabled && outputIsEnabled) ? 1u : 0u;
+}
+
 /*
   PrepareLatch
 
@@ -326,12 +711,14 @@ uint32_t getRawInput(int channelValue) {
   coursework code calls PrepareLatch() before shifting bits and then calls LatchRegister() to
   commit them.
 
-  In the emulator, we use this to update a UI-visible "display enabled" indicator.
+  In the emulator, we use this to update the "display enabled" flag in the status block, which the
+  page shows on its next animation frame.
 */
 void PrepareLatch(void) {
+  halStatsPrepareLatch(&halStats);
   latchLineIsLow = true;
   displayIsEnabled = false;
-  js_set_display_state(0);
+  publishDisplayState();
 }
 
 /*
@@ -344,21 +731,38 @@ void PrepareLatch(void) {
     1) Marks the display as enabled,
     2) Decodes the most recent 192 shifted bits into the latched framebuffer for the currently
        selected multiplexed row address,
-    3) Requests a render via JavaScript so the canvas reflects the updated state.
+    3) Updates the status block: latch counter, active row-pair and, when all 16 row-pairs have
+       been latched, the scan counter and generation. The page picks this up on its next
+       animation frame; nothing is sent to JavaScript here.
+    4) Only in the row-scan debug view, requests a render immediately so the canvas shows this
+       row-pair.
 */
 void LatchRegister(void) {
   latchLineIsLow = false;
   displayIsEnabled = true;
-  js_set_display_state(1);
 
   commitShiftRegisterToFramebufferForSelectedRow();
 
-  // Render on every latch so row scanning can be observed.
-  js_render_frame(latchedFramebufferRgb, (selectedRowPairIndex & 0x0F), (int)displayIsEnabled);
+  const int rowPair = (selectedRowPairIndex & 0x0F);
+  publishDisplayState();
+  statusBlock.activeRowPair = (uint32_t)rowPair;
+  statusBlock.latchCount++;
+  latchesInCurrentScan++;
+
+  if (halStatsLatch(&halStats)) {
+    statusBlock.scanCount++;
+    statusBlock.latchesInLastScan = latchesInCurrentScan;
+    statusBlock.generation++;
+    latchesInCurrentScan = 0;
+  }
+
+  if (statusBlock.rowScanMode) {
+    js_render_frame(latchedFramebufferRgb, rowPair, (int)(displayIsEnabled && outputIsEnabled));
+  }
 }
 
 /*
-  SelectRow
+  SelectRow / selectRowPair
 
   Select which multiplexed row address is currently active.
 
@@ -368,66 +772,409 @@ void LatchRegister(void) {
   This does not immediately change the framebuffer; it only affects where the next LatchRegister()
   commit is written.
 */
+static void selectRowPair(int rowPair) {
+  if (rowPair != selectedRowPairIndex) {
+    // A new visit to this row-pair: restart its dwell integration.
+    rowPairDwellUs[rowPair] = 0;
+    memset(&pixelOnUs[(rowPair * PANEL_PIXEL_WIDTH) * 3], 0, PANEL_PIXEL_WIDTH * 3 * sizeof(uint32_t));
+    memset(&pixelOnUs[((rowPair + 16) * PANEL_PIXEL_WIDTH) * 3], 0, PANEL_PIXEL_WIDTH * 3 * sizeof(uint32_t));
+  }
+  selectedRowPairIndex = rowPair;
+}
+
 void SelectRow(int row) {
-  selectedRowPairIndex = (row - 1) & 0x0F;
+  halStatsSelectRow(&halStats, row);
+  selectRowPair((row - 1) & 0x0F);
 }
 
+#ifdef PANEL_PARALLEL_SHIFT
+
+/*
+  PushColumn
+
+  Clock one column into the six parallel data chains: bit c of `rgb6` enters the top (bit 31) of
+  parallelChains[c] as every chain moves one place towards bit 0.
+*/
+static void clockColumn(uint8_t rgb6) {
+  for (int c = 0; c < 6; c++) {
+    parallelChains[c] = (parallelChains[c] >> 1) | ((uint32_t)((rgb6 >> c) & 1u) << 31);
+  }
+}
+
+void PushColumn(uint8_t rgb6) {
+  halStatsPushColumn(&halStats);
+  clockColumn(rgb6);
+}
+
+/*
+  PushBit
+
+  With parallel wiring there is no single data line: clock one column carrying `onoff` on all six
+  lines (see panel.h).
+*/
+void PushBit(int onoff) {
+  halStatsPushBit(&halStats);
+  clockColumn(onoff ? 0x3Fu : 0x00u);
+}
+
+/*
+  loadPayload
+
+  Send a row-pair payload as 32 columns. Column x carries bit x of every payload word, so once all
+  32 have been clocked in chain c equals payload word c; the chains are simply loaded with the
+  payload, which is the same end state as 32 PushColumn() calls.
+*/
+static void loadPayload(const uint32_t payload[PANEL_ROW_WORDS]) {
+  memcpy(parallelChains, payload, sizeof(parallelChains));
+}
+
+#else
+
 /*
   PushBit
 
   Shift one bit into the emulated shift register.
 
   The game code calls PushBit() for each colour plane bit (192 times per row-pair). This function
-  models the hardware behaviour by appending the bit to the end of a fixed-size shift-register
-  buffer, discarding the oldest bit if more than PANEL_SHIFT_BITS have been pushed.
+  models the hardware behaviour by shifting the bit into the end of the packed 192-bit register,
+  discarding the oldest bit.
 */
 void PushBit(int onoff) {
+  halStatsPushBit(&halStats);
   shiftRegisterPushBit((uint8_t)(onoff ? 1 : 0));
 }
 
+/*
+  loadPayload
+
+  Shift a complete 192-bit row-pair payload (see PANEL_ROW_WORDS in panel.h).
+
+  A full payload pushes every previously stored bit out of the register, so instead of 192
+  individual PushBit() calls the register simply becomes the payload: payload word w is logical
+  bits 32*w .. 32*w+31, i.e. one half of register word w / 2. Three word writes give exactly the
+  same result as pushing the bits one by one.
+*/
+static void loadPayload(const uint32_t payload[PANEL_ROW_WORDS]) {
+  shiftRegisterWords[0] = (uint64_t)payload[0] | ((uint64_t)payload[1] << 32);
+  shiftRegisterWords[1] = (uint64_t)payload[2] | ((uint64_t)payload[3] << 32);
+  shiftRegisterWords[2] = (uint64_t)payload[4] | ((uint64_t)payload[5] << 32);
+}
+
+#endif // PANEL_PARALLEL_SHIFT
+
+/*
+  PushRow
+
+  Shift one row-pair payload (see loadPayload()).
+*/
+void PushRow(const uint32_t payload[PANEL_ROW_WORDS]) {
+  halStatsPushRow(&halStats);
+  loadPayload(payload);
+}
+
 /*
   ClearRow
 
-  Clear the current shift-register payload for a given row by pushing 192 zero bits.
+  Clear the current shift-register payload for a given row by pushing 192 zero bits (32 zero
+  columns in PANEL_PARALLEL_SHIFT builds).
 
   The hardware driver selects a row address and shifts in zeros to ensure the displayed row-pair
-  is blank before new data is loaded. The emulator mirrors this behaviour exactly so that any
-  game logic relying on the clear step behaves consistently.
+  is blank before new data is loaded. The emulator mirrors this behaviour exactly (as one
+  all-zero payload) so that any game logic relying on the clear step behaves consistently. The
+  select and the zeros are counted as part of this call, not as SelectRow()/PushRow() calls.
 */
 void ClearRow(int row) {
-  SelectRow(row);
-  for (int bitIndex = 0; bitIndex < PANEL_SHIFT_BITS; bitIndex++) {
-    PushBit(0);
-  }
+  static const uint32_t zeroPayload[PANEL_ROW_WORDS] = {0};
+  halStatsClearRow(&halStats, row);
+  selectRowPair((row - 1) & 0x0F);
+  loadPayload(zeroPayload);
 }
 
 /*
-  delay_ms
+  SetOutputEnable
 
-  Provide a millisecond-scale delay that behaves appropriately for each build target.
+  Emulate the output-enable line. While output is disabled the panel is blanked: the status block
+  reports the display as off and delay_us() does not count the time towards any pixel's on-time,
+  so blanked intervals dim the perceived intensity exactly as they would on hardware.
+*/
+void SetOutputEnable(bool enabled) {
+  halStatsOutputEnable(&halStats, enabled);
+  outputIsEnabled = enabled;
+  publishDisplayState();
+}
 
-  - Browser/WASM (Emscripten):
-      Uses emscripten_sleep() so the JavaScript event loop can continue processing input and
-      rendering. Also honours Pause/Step controls by waiting while paused.
+/*
+  readWallClockMs
 
-  - Non-browser builds:
-      Falls back to a simple busy-wait loop (similar to the coursework hardware code). This is not
-      intended for precise timing; it exists only to keep the interface consistent.
+  Monotonic wall-clock time in milliseconds.
+*/
+static double readWallClockMs(void) {
+#ifdef __EMSCRIPTEN__
+  return emscripten_get_now();
+#else
+  return (double)clock() * 1000.0 / (double)CLOCKS_PER_SEC;
+#endif
+}
+
+/*
+  getTimestamp / getTimestampFrequency
+
+  Wall-clock microseconds (the browser clock's resolution may be coarser), truncated to 32 bits.
+*/
+uint32_t getTimestamp(void) {
+  return (uint32_t)(uint64_t)(readWallClockMs() * 1000.0);
+}
+
+uint32_t getTimestampFrequency(void) {
+  return 1000000u;
+}
+
+/*
+  delay_ms / now_us
+
+  delay_ms() is delay_us() (below, per build) in milliseconds. now_us() is the virtual clock in
+  microseconds, truncated to 32 bits: simulated time, so the game's row dwells are exact whatever
+  the browser's timer resolution.
 */
 void delay_ms(uint32_t ms) {
+  delay_us(ms * 1000u);
+}
+
+uint32_t now_us(void) {
+  return (uint32_t)(uint64_t)(virtualClockMs * 1000.0 + 0.5);
+}
+
+/*
+  startScanTimer / waitForInterrupt
+
+  The scan timer of GAME_SCANOUT_ISR builds, run cooperatively: WebAssembly has no interrupts, so
+  the handler runs from waitForInterrupt(), after delay_us() has advanced the virtual clock (and
+  integrated the lit row-pair's dwell) by one timer period. Periods are whole microseconds, at
+  least 1. The game waits in flipPages() for every scan, so the panel is refreshed exactly as
+  often as the interrupt would refresh it.
+*/
+static void (*scanTimerHandler)(void);
+static uint32_t scanTimerPeriodUs = 1000;
+
+void startScanTimer(void (*handler)(void), uint32_t frequencyHz) {
+  scanTimerHandler = handler;
+  scanTimerPeriodUs = (frequencyHz > 0 && frequencyHz < 1000000u) ? 1000000u / frequencyHz : 1u;
+}
+
+void waitForInterrupt(void) {
+  delay_us(scanTimerPeriodUs);
+  if (scanTimerHandler) scanTimerHandler();
+}
+
+/*
+  clampSpeedPercent
+
+  Sanitise the speed written by JavaScript: 0 means uncapped, anything else is clamped to the
+  supported 0.1x-16x range.
+*/
+static inline uint32_t clampSpeedPercent(uint32_t percent) {
+  if (percent == 0) return 0;
+  if (percent < VIRTUAL_CLOCK_MIN_PERCENT) return VIRTUAL_CLOCK_MIN_PERCENT;
+  if (percent > VIRTUAL_CLOCK_MAX_PERCENT) return VIRTUAL_CLOCK_MAX_PERCENT;
+  return percent;
+}
+
+/*
+  reanchorVirtualClock
+
+  Declare "now" to be in sync: simulated time from here on is measured against the current wall
+  time at the given speed.
+*/
+static inline void reanchorVirtualClock(double wallMs, uint32_t speedPercent) {
+  anchorVirtualMs = virtualClockMs;
+  anchorWallMs = wallMs;
+  anchorSpeedPercent = speedPercent;
+}
+
+#ifdef PANEL_EMU_ASYNCIFY
+// -----------------------------------------------------------------------------
+// Legacy Asyncify build: delay_us() yields from inside game.c's infinite loop
+// -----------------------------------------------------------------------------
+
+/*
+  yieldToBrowser
+
+  Hand control back to the JavaScript event loop for `ms` milliseconds (0 = just let pending
+  events and animation frames run). Outside the browser this is a busy-wait, similar to the
+  coursework hardware code; it is not intended for precise timing.
+*/
+static void yieldToBrowser(int ms) {
+  statusBlock.yieldCount++;
+  statusBlock.frameWorkUs = (uint32_t)((readWallClockMs() - lastYieldWallMs) * 1000.0);
 #ifdef __EMSCRIPTEN__
+  emscripten_sleep(ms);
+#else
+  const double untilMs = readWallClockMs() + (double)ms;
+  while (readWallClockMs() < untilMs) {
+    // Busy-wait.
+  }
+#endif
+  lastYieldWallMs = readWallClockMs();
+}
+
+/*
+  delay_us
+
+  Integrate the lit row-pair's dwell (see integrateDwell), then advance the virtual clock by `us`
+  microseconds, yielding to the browser only when needed.
+
+  The requested time is added to the virtual clock immediately. The wall time that simulated
+  time corresponds to is anchorWall + (virtual - anchorVirtual) / speed; if that is at least a
+  frame (VIRTUAL_CLOCK_YIELD_MS) in the future, we sleep until then with a single
+  emscripten_sleep(). Because the game dwells sixteen times per scan, this turns
+  sixteen clamped 1-4 ms browser timers per frame into about one, so pacing follows the
+  requested speed instead of the browser's timer granularity.
+
+  In uncapped mode (speedPercent 0) there is nothing to wait for, so we yield with
+  emscripten_sleep(0) once per frame's worth of wall time to keep input and rendering alive.
+  Whenever no yield is due for timing reasons but a frame's worth of wall time has passed (a
+  slow device), we also yield so the page stays responsive.
+
+  Pause/Step controls are honoured first; leaving a pause re-anchors the clock.
+
+  Non-browser builds run the same logic, with yieldToBrowser() busy-waiting instead of sleeping.
+*/
+void delay_us(uint32_t us) {
+  halStatsDelay(&halStats, us);
+  integrateDwell(us);
+
+  bool wasPaused = false;
   for (;;) {
     if (!js_is_paused()) break;
     if (js_consume_step()) break;
-    emscripten_sleep(16);
+    wasPaused = true;
+    yieldToBrowser(16);
+  }
+
+  virtualClockMs += (double)us / 1000.0;
+  statusBlock.virtualTimeMs = (uint32_t)(uint64_t)virtualClockMs;
+
+  const uint32_t speedPercent = clampSpeedPercent(statusBlock.speedPercent);
+  double nowMs = readWallClockMs();
+
+  if (wasPaused || speedPercent != anchorSpeedPercent) {
+    reanchorVirtualClock(nowMs, speedPercent);
+  }
+
+  if (speedPercent == 0) {
+    if (nowMs - lastYieldWallMs >= VIRTUAL_CLOCK_YIELD_MS) {
+      yieldToBrowser(0);
+    }
+    return;
+  }
+
+  const double dueWallMs =
+      anchorWallMs + (virtualClockMs - anchorVirtualMs) * 100.0 / (double)speedPercent;
+  const double aheadMs = dueWallMs - nowMs;
+
+  if (aheadMs >= VIRTUAL_CLOCK_YIELD_MS) {
+    yieldToBrowser((int)aheadMs);
+  } else if (aheadMs < -VIRTUAL_CLOCK_MAX_LAG_MS) {
+    reanchorVirtualClock(nowMs, speedPercent);
+  } else if (nowMs - lastYieldWallMs >= VIRTUAL_CLOCK_YIELD_MS) {
+    yieldToBrowser(0);
+  }
+}
+
+#else
+// -----------------------------------------------------------------------------
+// Main-loop build: the browser calls runMainLoopFrame(), which calls game_tick()
+// -----------------------------------------------------------------------------
+
+// Upper bound on wall time spent running ticks in one browser frame, leaving the rest of a 60 Hz
+// frame for input handling and presentation.
+#define MAIN_LOOP_FRAME_BUDGET_MS 12.0
+
+/*
+  delay_us
+
+  Integrate the lit row-pair's dwell, advance the virtual clock by `us` microseconds and return
+  immediately. Pacing happens between
+  ticks in runMainLoopFrame(), so nothing here ever blocks or unwinds the stack.
+*/
+void delay_us(uint32_t us) {
+  halStatsDelay(&halStats, us);
+  integrateDwell(us);
+  virtualClockMs += (double)us / 1000.0;
+  statusBlock.virtualTimeMs = (uint32_t)(uint64_t)virtualClockMs;
+}
+
+#ifndef PANEL_EMU_NO_MAIN
+/*
+  runMainLoopFrame
+
+  Called once per browser frame. Runs game ticks until simulated time catches up with
+  anchorVirtual + (now - anchorWall) * speed, bounded by MAIN_LOOP_FRAME_BUDGET_MS of wall time:
+
+  - Uncapped mode (speedPercent 0) simply runs ticks for the whole budget.
+  - If the game cannot keep up and falls more than VIRTUAL_CLOCK_MAX_LAG_MS behind (slow device,
+    background tab), the clock is re-anchored rather than running a burst of catch-up frames.
+  - While paused, at most one tick runs per consumed step token, and the clock is re-anchored so
+    resuming does not catch up on the paused time.
+*/
+static void runMainLoopFrame(void) {
+  const double frameStartMs = readWallClockMs();
+  const uint32_t speedPercent = clampSpeedPercent(statusBlock.speedPercent);
+  statusBlock.yieldCount++;
+
+  if (js_is_paused()) {
+    if (js_consume_step()) game_tick();
+    reanchorVirtualClock(frameStartMs, speedPercent);
+    statusBlock.frameWorkUs = (uint32_t)((readWallClockMs() - frameStartMs) * 1000.0);
+    return;
   }
 
-  if (ms > 0) {
-    emscripten_sleep((int)ms);
+  if (speedPercent != anchorSpeedPercent) {
+    reanchorVirtualClock(frameStartMs, speedPercent);
   }
+
+  const double budgetEndMs = frameStartMs + MAIN_LOOP_FRAME_BUDGET_MS;
+
+  if (speedPercent == 0) {
+    do {
+      game_tick();
+    } while (readWallClockMs() < budgetEndMs);
+  } else {
+    const double targetVirtualMs =
+        anchorVirtualMs + (frameStartMs - anchorWallMs) * (double)speedPercent / 100.0;
+
+    while (virtualClockMs < targetVirtualMs) {
+      game_tick();
+      if (readWallClockMs() >= budgetEndMs) break;
+    }
+
+    if (targetVirtualMs - virtualClockMs > VIRTUAL_CLOCK_MAX_LAG_MS) {
+      reanchorVirtualClock(frameStartMs, speedPercent);
+    }
+  }
+
+  statusBlock.frameWorkUs = (uint32_t)((readWallClockMs() - frameStartMs) * 1000.0);
+}
+
+/*
+  main
+
+  Entry point for the main-loop build (game.c is compiled with GAME_NO_MAIN). Initialises the game
+  and hands control to the browser, which calls runMainLoopFrame() once per animation frame.
+  Outside the browser the frames simply run back-to-back.
+*/
+int main(void) {
+  game_setup();
+  reanchorVirtualClock(readWallClockMs(), clampSpeedPercent(statusBlock.speedPercent));
+
+#ifdef __EMSCRIPTEN__
+  emscripten_set_main_loop(runMainLoopFrame, 0, false);
 #else
-  for (volatile unsigned int tmr = ms; tmr > 0; tmr--) {
-    __asm__("nop");
+  for (;;) {
+    runMainLoopFrame();
   }
 #endif
+  return 0;
 }
+#endif // PANEL_EMU_NO_MAIN
+#endif
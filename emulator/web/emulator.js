@@ -10,11 +10,20 @@
 
   1) Rendering:
      The C emulator (panel_emu.c) maintains a 32x32 RGB framebuffer in WASM memory. Each pixel is
-     stored as 3 bytes [R,G,B] where each channel is either 0 or 1.
-
-     panel_emu.c calls window.Emu.renderFrame(framebufferPtr, activeRowPair, displayOn) whenever the
-     emulated panel latches new row data. This file reads the framebuffer bytes from the WASM heap
-     and draws them onto a 32x32 <canvas> (scaled up by CSS).
+     stored as 3 bytes [R,G,B], each the perceived channel intensity 0..255 (only 0 or 255 with
+     1-bit colour; intermediate levels when the game uses Binary Code Modulation).
+
+     panel_emu.c publishes its output state in a status block in WASM memory (framebuffer pointer,
+     a generation counter bumped per complete 16-row scan, active row-pair, display flag and
+     latch/scan counters). This file keeps a cached typed-array view of that block and pulls from
+     it on its own schedule:
+       - integrated view: the animation-frame loop presents the framebuffer whenever the
+         generation has changed, i.e. at most once per completed scan and once per
+         requestAnimationFrame. The game loop makes no output calls into JavaScript.
+       - row-scan view: panel_emu.c calls window.Emu.renderFrame(framebufferPtr, activeRowPair,
+         displayOn) on every latch so scanning can be observed row by row.
+     Either way this file reads the framebuffer bytes from the WASM heap and draws them onto a
+     32x32 <canvas> (scaled up by CSS).
 
   2) Input:
      The HTML page provides two "joystick" sliders (and keyboard controls that drive them). This
@@ -26,6 +35,9 @@
      can honour these controls without blocking the browser. This file exposes that state via
      window.Emu.isPaused() and window.Emu.consumeStep().
 
+     delay_ms() runs a virtual clock paced against wall time; the speed selector (and the '[' / ']'
+     keys) write its speed (0.1x-16x, or uncapped) into the status block.
+
   Important design choice:
   - The C side already emulates the shift-register + latch + row-select behaviour. This file does
     not "redraw game objects" itself; it only displays the framebuffer produced by the C code.
@@ -63,10 +75,21 @@
     - "integrated": show the full framebuffer (what a person perceives after scan integration).
     - "row":        show only the currently selected row-pair (useful for debugging scanning).
 
-    This is toggled with the 'L' key.
+    This is toggled with the 'L' key, which also switches panel_emu.c's render policy through the
+    status block's rowScanMode word.
   */
   let scanDisplayMode = "integrated";
 
+  /*
+    Simulation speed
+
+    Percent of real time that panel_emu.c's virtual clock should run at (written to the status
+    block's speedPercent word). 0 means uncapped: run as fast as possible, yielding once per frame.
+    SPEED_STEPS_PERCENT lists the values offered by the page and the '[' / ']' shortcuts.
+  */
+  const SPEED_STEPS_PERCENT = [10, 25, 50, 100, 200, 400, 800, 1600, 0];
+  let simulationSpeedPercent = 100;
+
   // ---------------------------------------------------------------------------
   // Pause/step controls (used indirectly by delay_ms() in panel_emu.c)
   // ---------------------------------------------------------------------------
@@ -102,25 +125,73 @@
   let emscriptenModule = null;
 
   /*
-    getWasmHeapU8
+    Status block layout (word offsets into panel_emu.c's EmuStatusBlock; keep in sync).
+  */
+  const STATUS_FRAMEBUFFER_PTR = 0;
+  const STATUS_FRAMEBUFFER_BYTES = 1;
+  const STATUS_GENERATION = 2;
+  const STATUS_ACTIVE_ROW_PAIR = 3;
+  const STATUS_DISPLAY_ON = 4;
+  const STATUS_LATCH_COUNT = 5;
+  const STATUS_SCAN_COUNT = 6;
+  const STATUS_LATCHES_IN_LAST_SCAN = 7;
+  const STATUS_ROW_SCAN_MODE = 8;
+  const STATUS_SPEED_PERCENT = 9;
+  const STATUS_VIRTUAL_TIME_MS = 10;
+  const STATUS_YIELD_COUNT = 11;
+  const STATUS_FRAME_WORK_US = 12;
+  const STATUS_BUILD_VARIANT = 13;
+  const STATUS_WORD_COUNT = 14;
+
+  /*
+    Profile table layout (panel_emu.c's emu_get_profile_stats(); GameProfilePhase order in game.h,
+    five words per phase: samples, min, mean, max, p99 in nanoseconds).
+  */
+  const PROFILE_PHASE_NAMES = ["input", "drawing", "physics", "scanout", "delay", "other", "tick"];
+  const PROFILE_WORDS_PER_PHASE = 5;
+
+  /*
+    HAL metrics layout (panel_emu.c's emu_sample_hal_metrics(): 21 doubles, words 9..18 being
+    calls per tick for each primitive in this order, then the target and measured refresh rates).
+  */
+  const HAL_METRIC_WORDS = 21;
+  const HAL_PRIMITIVE_NAMES = [
+    "PushBit", "PushRow", "PushColumn", "SelectRow", "PrepareLatch",
+    "LatchRegister", "ClearRow", "SetOutputEnable", "getRawInput", "delay_us",
+  ];
+
+  /*
+    Cached heap views
+
+    Typed-array views are rebuilt only when the underlying ArrayBuffer changes, which happens when
+    WASM memory grows (-sALLOW_MEMORY_GROWTH detaches the old buffer). In steady state every access
+    reuses the same objects.
+  */
+  let cachedHeapBuffer = null;
+  let cachedHeapU8 = null;
+  let cachedStatusWords = null;
+  let statusBlockAddress = 0;
+
+  /*
+    findWasmMemoryBuffer
 
-    Return a Uint8Array view over the WASM linear memory.
+    Locate the ArrayBuffer backing WASM linear memory.
 
     Emscripten exposes the heap in slightly different ways depending on build settings. To keep
     this emulator robust, we support the common patterns:
       1) Module.HEAPU8
       2) globalThis.HEAPU8
-      3) new Uint8Array(memory.buffer) if a WebAssembly.Memory is exposed
+      3) an exposed WebAssembly.Memory object
 
     If no heap is available yet, returns null.
   */
-  function getWasmHeapU8() {
+  function findWasmMemoryBuffer() {
     if (emscriptenModule && emscriptenModule.HEAPU8 instanceof Uint8Array) {
-      return emscriptenModule.HEAPU8;
+      return emscriptenModule.HEAPU8.buffer;
     }
 
     if (globalThis.HEAPU8 instanceof Uint8Array) {
-      return globalThis.HEAPU8;
+      return globalThis.HEAPU8.buffer;
     }
 
     const memory =
@@ -128,11 +199,59 @@
       (emscriptenModule && emscriptenModule.asm && (emscriptenModule.asm.memory || emscriptenModule.asm["memory"])) ||
       globalThis.wasmMemory;
 
-    if (memory && memory.buffer) {
-      return new Uint8Array(memory.buffer);
-    }
+    return (memory && memory.buffer) ? memory.buffer : null;
+  }
 
-    return null;
+  /*
+    refreshHeapViews
+
+    Make sure cachedHeapU8/cachedStatusWords view the current memory buffer, rebuilding them only
+    if memory has grown since they were created.
+  */
+  function refreshHeapViews() {
+    const buffer = findWasmMemoryBuffer();
+    if (!buffer) return false;
+    if (buffer === cachedHeapBuffer) return true;
+
+    cachedHeapBuffer = buffer;
+    cachedHeapU8 = new Uint8Array(buffer);
+    cachedStatusWords = statusBlockAddress
+      ? new Uint32Array(buffer, statusBlockAddress, STATUS_WORD_COUNT)
+      : null;
+    return true;
+  }
+
+  /*
+    getWasmHeapU8
+
+    Return the cached Uint8Array view over the WASM linear memory (or null if unavailable).
+  */
+  function getWasmHeapU8() {
+    return refreshHeapViews() ? cachedHeapU8 : null;
+  }
+
+  /*
+    getStatusWords
+
+    Return the cached Uint32Array view over panel_emu.c's status block (or null before the block
+    address is known).
+  */
+  function getStatusWords() {
+    return refreshHeapViews() ? cachedStatusWords : null;
+  }
+
+  /*
+    bindStatusBlock
+
+    Ask panel_emu.c for the status block address (once) and build the cached view.
+  */
+  function bindStatusBlock() {
+    const getStatusBlock = emscriptenModule && emscriptenModule._emu_get_status_block;
+    if (typeof getStatusBlock !== "function") return;
+
+    statusBlockAddress = getStatusBlock() >>> 0;
+    cachedHeapBuffer = null;
+    refreshHeapViews();
   }
 
   // ---------------------------------------------------------------------------
@@ -206,7 +325,7 @@
 
     Parameters:
       - framebufferPtr: pointer (in WASM memory) to PANEL_WIDTH_PIXELS*PANEL_HEIGHT_PIXELS*3 bytes.
-                       Layout per pixel: [R,G,B] where each channel is 0 or 1.
+                       Layout per pixel: [R,G,B], each channel an intensity 0..255.
       - activeRowPair:  0..15 representing the currently selected row address.
       - displayOn:      boolean controlling whether the display should appear enabled.
 
@@ -242,7 +361,7 @@
       return;
     }
 
-    const framebufferRgbBits = heapU8.subarray(framebufferAddress, framebufferAddress + framebufferByteLength);
+    const framebufferRgb = heapU8.subarray(framebufferAddress, framebufferAddress + framebufferByteLength);
 
     const selectedRowPair = (activeRowPair & 0x0f);
     const topRowIndex = selectedRowPair;
@@ -257,13 +376,13 @@
         const sourceIndex = pixelIndex * 3;
         const destIndex = pixelIndex * 4;
 
-        const r = isRowVisible ? framebufferRgbBits[sourceIndex + 0] : 0;
-        const g = isRowVisible ? framebufferRgbBits[sourceIndex + 1] : 0;
-        const b = isRowVisible ? framebufferRgbBits[sourceIndex + 2] : 0;
+        const r = isRowVisible ? framebufferRgb[sourceIndex + 0] : 0;
+        const g = isRowVisible ? framebufferRgb[sourceIndex + 1] : 0;
+        const b = isRowVisible ? framebufferRgb[sourceIndex + 2] : 0;
 
-        panelRgbaBytes[destIndex + 0] = r ? 255 : 0;
-        panelRgbaBytes[destIndex + 1] = g ? 255 : 0;
-        panelRgbaBytes[destIndex + 2] = b ? 255 : 0;
+        panelRgbaBytes[destIndex + 0] = r;
+        panelRgbaBytes[destIndex + 1] = g;
+        panelRgbaBytes[destIndex + 2] = b;
         panelRgbaBytes[destIndex + 3] = 255;
       }
     }
@@ -272,34 +391,222 @@
   }
 
   // ---------------------------------------------------------------------------
-  // FPS counter (based on how often the panel latches)
+  // Presentation loop and rate readout
   // ---------------------------------------------------------------------------
 
-  let renderedLatchCount = 0;
-  let lastFpsTimestampMs = performance.now();
+  let presentedFrameCount = 0;
+  let lastRateTimestampMs = performance.now();
+  let lastRateLatchCount = 0;
+  let lastRateScanCount = 0;
+  let lastRateVirtualTimeMs = 0;
+  let lastRateYieldCount = 0;
+  let lastPresentedGeneration = -1;
+  let lastShownDisplayOn = -1;
+
+  /*
+    updateRateReadout
+
+    Once per second, report separate rates from the status block counters:
+      - latches/s: LatchRegister() calls (16 per scan),
+      - scans/s:   complete 16-row scans produced by the game,
+      - frames/s:  canvas presentations (at most the display refresh rate in integrated view),
+      - yields/s:  times the game handed control back to the browser,
+      - speed:     simulated milliseconds per wall-clock millisecond (1.0 = real time),
+      - CPU/frame: wall time the game ran between the two most recent yields, labelled with the
+                   build variant (main loop or Asyncify) so the two builds can be compared.
+  */
+  function updateRateReadout(nowMs, status) {
+    const elapsedMs = nowMs - lastRateTimestampMs;
+    if (elapsedMs < 1000) return;
+
+    const latchCount = status ? status[STATUS_LATCH_COUNT] : 0;
+    const scanCount = status ? status[STATUS_SCAN_COUNT] : 0;
+    const virtualTimeMs = status ? status[STATUS_VIRTUAL_TIME_MS] : 0;
+    const yieldCount = status ? status[STATUS_YIELD_COUNT] : 0;
+    const perSecond = 1000 / elapsedMs;
+
+    const rates = {
+      latches: ((latchCount - lastRateLatchCount) >>> 0) * perSecond,
+      scans: ((scanCount - lastRateScanCount) >>> 0) * perSecond,
+      frames: presentedFrameCount * perSecond,
+      yields: ((yieldCount - lastRateYieldCount) >>> 0) * perSecond,
+      speed: ((virtualTimeMs - lastRateVirtualTimeMs) >>> 0) / elapsedMs,
+      frameWorkMs: status ? status[STATUS_FRAME_WORK_US] / 1000 : 0,
+      variant: (status && status[STATUS_BUILD_VARIANT] === 1) ? "Asyncify" : "main loop",
+    };
+
+    lastRateLatchCount = latchCount;
+    lastRateScanCount = scanCount;
+    lastRateVirtualTimeMs = virtualTimeMs;
+    lastRateYieldCount = yieldCount;
+    presentedFrameCount = 0;
+    lastRateTimestampMs = nowMs;
+
+    if (window.EmuUI && typeof window.EmuUI.setRates === "function") {
+      window.EmuUI.setRates(rates);
+    } else if (window.EmuUI && typeof window.EmuUI.setFps === "function") {
+      window.EmuUI.setFps(rates.frames.toFixed(1));
+    }
+  }
 
   /*
-    updateFpsReadoutLoop
+    updateProfileReadout
+
+    Pull the per-phase frame profile (GAME_PROFILE builds only) and hand it to the page as one row
+    per phase with times in microseconds. Builds without the profile return 0 and show nothing.
+  */
+  function updateProfileReadout() {
+    const getProfileStats = emscriptenModule && emscriptenModule._emu_get_profile_stats;
+    if (typeof getProfileStats !== "function") return;
+    if (!window.EmuUI || typeof window.EmuUI.setProfile !== "function") return;
 
-    Update the on-screen FPS indicator once per second.
+    const address = getProfileStats() >>> 0;
+    const heapU8 = getWasmHeapU8();
+    if (!address || !heapU8) return;
+
+    const words = new Uint32Array(heapU8.buffer, address, PROFILE_PHASE_NAMES.length * PROFILE_WORDS_PER_PHASE);
+    const rows = PROFILE_PHASE_NAMES.map((name, phase) => {
+      const base = phase * PROFILE_WORDS_PER_PHASE;
+      return {
+        name: name,
+        samples: words[base],
+        minUs: words[base + 1] / 1000,
+        meanUs: words[base + 2] / 1000,
+        maxUs: words[base + 3] / 1000,
+        p99Us: words[base + 4] / 1000,
+      };
+    });
+    window.EmuUI.setProfile(rows);
+  }
+
+  /*
+    updateHalReadout
 
-    We treat "FPS" as "how many latch-driven renders occurred per second". This is useful for
-    validating scan performance and for ensuring the emulator remains responsive.
+    Sample the HAL counters (rates since the previous sample) and hand them to the page.
   */
-  function updateFpsReadoutLoop() {
-    const nowMs = performance.now();
+  function updateHalReadout() {
+    const sampleHalMetrics = emscriptenModule && emscriptenModule._emu_sample_hal_metrics;
+    if (typeof sampleHalMetrics !== "function") return;
+    if (!window.EmuUI || typeof window.EmuUI.setHalMetrics !== "function") return;
 
-    if (nowMs - lastFpsTimestampMs >= 1000) {
-      const fps = (renderedLatchCount * 1000) / (nowMs - lastFpsTimestampMs);
-      renderedLatchCount = 0;
-      lastFpsTimestampMs = nowMs;
+    const address = sampleHalMetrics() >>> 0;
+    const heapU8 = getWasmHeapU8();
+    if (!address || !heapU8) return;
+
+    const values = new Float64Array(heapU8.buffer, address, HAL_METRIC_WORDS);
+    window.EmuUI.setHalMetrics({
+      scansPerSecond: values[2],
+      latchesPerScan: values[3],
+      bitsPerScan: values[4],
+      wastedBitsPerScan: values[5],
+      clocksPerScan: values[6],
+      dwellMsPerRow: values[7],
+      adcReadsPerTick: values[8],
+      callsPerTick: HAL_PRIMITIVE_NAMES.map((name, i) => [name, values[9 + i]]),
+      refreshTargetHz: values[19],
+      refreshMeasuredHz: values[20],
+    });
+  }
 
-      if (window.EmuUI && typeof window.EmuUI.setFps === "function") {
-        window.EmuUI.setFps(fps.toFixed(1));
+  /*
+    animationFrameLoop
+
+    Runs once per requestAnimationFrame and pulls everything it needs from the status block:
+      - in the integrated view, presents the framebuffer if a new complete scan (generation) has
+        been published since the last presentation;
+      - once a second, refreshes the HAL call metrics and the frame profile (GAME_PROFILE builds)
+        with the rate readout;
+      - mirrors the display-on flag into the page header when it changes;
+      - keeps the JavaScript-owned words (row-scan mode, speed) applied, since setupPanel()
+        re-initialises the block when the game starts;
+      - drives the rate readout.
+  */
+  function animationFrameLoop(nowMs) {
+    const status = getStatusWords();
+
+    if (status) {
+      applyControlWords(status);
+
+      const generation = status[STATUS_GENERATION];
+      if (scanDisplayMode === "integrated" && generation !== lastPresentedGeneration) {
+        lastPresentedGeneration = generation;
+        logInitialHeapProbe(status[STATUS_FRAMEBUFFER_PTR]);
+        drawPanelFromFramebufferPointer(status[STATUS_FRAMEBUFFER_PTR], 0, true);
+        presentedFrameCount++;
+      }
+
+      const displayOn = status[STATUS_DISPLAY_ON];
+      if (displayOn !== lastShownDisplayOn) {
+        lastShownDisplayOn = displayOn;
+        if (window.EmuUI && typeof window.EmuUI.setDisplayEnabled === "function") {
+          window.EmuUI.setDisplayEnabled(!!displayOn);
+        }
       }
     }
 
-    requestAnimationFrame(updateFpsReadoutLoop);
+    if (nowMs - lastRateTimestampMs >= 1000) {
+      updateHalReadout();
+      updateProfileReadout();
+    }
+    updateRateReadout(nowMs, status);
+    requestAnimationFrame(animationFrameLoop);
+  }
+
+  /*
+    setScanDisplayMode
+
+    Switch between the integrated and row-scan views, and tell panel_emu.c which render policy to
+    use by writing the status block's rowScanMode word (per-latch renders are only requested in
+    the row-scan view).
+  */
+  function setScanDisplayMode(mode) {
+    scanDisplayMode = mode;
+    lastPresentedGeneration = -1;
+
+    const status = getStatusWords();
+    if (status) applyControlWords(status);
+  }
+
+  /*
+    setSimulationSpeed
+
+    Select a simulation speed in percent of real time (0 = uncapped) and pass it to panel_emu.c.
+  */
+  function setSimulationSpeed(percent) {
+    simulationSpeedPercent = percent >>> 0;
+
+    const status = getStatusWords();
+    if (status) applyControlWords(status);
+
+    if (window.EmuUI && typeof window.EmuUI.setSpeed === "function") {
+      window.EmuUI.setSpeed(simulationSpeedPercent);
+    }
+  }
+
+  /*
+    stepSimulationSpeed
+
+    Move one entry up or down SPEED_STEPS_PERCENT (used by the '[' / ']' shortcuts).
+  */
+  function stepSimulationSpeed(direction) {
+    const index = SPEED_STEPS_PERCENT.indexOf(simulationSpeedPercent);
+    const current = (index < 0) ? SPEED_STEPS_PERCENT.indexOf(100) : index;
+    const next = Math.max(0, Math.min(SPEED_STEPS_PERCENT.length - 1, current + direction));
+    setSimulationSpeed(SPEED_STEPS_PERCENT[next]);
+  }
+
+  /*
+    applyControlWords
+
+    Write the status block words owned by JavaScript: the row-scan render policy and the
+    simulation speed.
+  */
+  function applyControlWords(status) {
+    const rowScanMode = (scanDisplayMode === "row") ? 1 : 0;
+    if (status[STATUS_ROW_SCAN_MODE] !== rowScanMode) status[STATUS_ROW_SCAN_MODE] = rowScanMode;
+    if (status[STATUS_SPEED_PERCENT] !== simulationSpeedPercent) {
+      status[STATUS_SPEED_PERCENT] = simulationSpeedPercent;
+    }
   }
 
   // ---------------------------------------------------------------------------
@@ -311,7 +618,7 @@
   /*
     logInitialHeapProbe
 
-    Log a single diagnostic message the first time we receive a render callback from C.
+    Log a single diagnostic message the first time we receive a framebuffer pointer from C.
 
     This helps verify that:
       - the framebuffer pointer is plausible,
@@ -333,6 +640,34 @@
     }
   }
 
+  /*
+    saveInputRecording
+
+    Download the session's joystick recording (every getRawInput() reading since boot, in the
+    input_log.h format) as pong-input.pil. Replay it headless with native/bin/pong_replay.
+  */
+  function saveInputRecording() {
+    const snapshot = emscriptenModule && emscriptenModule._emu_snapshot_input_recording;
+    const snapshotLength = emscriptenModule && emscriptenModule._emu_input_recording_snapshot_length;
+    if (typeof snapshot !== "function" || typeof snapshotLength !== "function") return;
+
+    const address = snapshot() >>> 0;
+    const length = snapshotLength() >>> 0;
+    const heapU8 = getWasmHeapU8();
+    if (!address || !heapU8) return;
+
+    const bytes = heapU8.slice(address, address + length);
+    const link = document.createElement("a");
+    link.href = URL.createObjectURL(new Blob([bytes], { type: "application/octet-stream" }));
+    link.download = "pong-input.pil";
+    link.click();
+    URL.revokeObjectURL(link.href);
+
+    if (window.EmuUI && typeof window.EmuUI.log === "function") {
+      window.EmuUI.log("[emu] saved input recording (" + length + " bytes)");
+    }
+  }
+
   // ---------------------------------------------------------------------------
   // Public API called from panel_emu.c (via EM_JS)
   // ---------------------------------------------------------------------------
@@ -344,14 +679,15 @@
       Called by index.html once the Emscripten runtime signals that the WASM module has initialised.
 
       Responsibilities:
-        - store the module reference so we can access the heap,
+        - store the module reference and bind the cached status block view,
         - initialise the canvas,
-        - wire up UI buttons (Start/Pause/Step/Reset),
-        - install keyboard shortcuts (L toggles scan mode, Space toggles pause),
-        - start the FPS update loop.
+        - wire up UI buttons (Start/Pause/Step/Reset/Save input) and the speed selector,
+        - install keyboard shortcuts (L toggles scan mode, Space toggles pause, [ / ] change speed),
+        - start the animation-frame presentation loop.
     */
     onWasmReady(moduleHandle) {
       emscriptenModule = moduleHandle;
+      bindStatusBlock();
 
       if (!panelCanvas) initialisePanelCanvas();
 
@@ -373,9 +709,17 @@
       });
       if (resetButton) resetButton.addEventListener("click", () => location.reload());
 
+      const saveInputButton = document.getElementById("btnSaveInput");
+      if (saveInputButton) saveInputButton.addEventListener("click", saveInputRecording);
+
+      const speedSelect = document.getElementById("speed");
+      if (speedSelect) {
+        speedSelect.addEventListener("change", () => setSimulationSpeed(Number(speedSelect.value) | 0));
+      }
+
       window.addEventListener("keydown", (e) => {
         if (e.code === "KeyL") {
-          scanDisplayMode = (scanDisplayMode === "integrated") ? "row" : "integrated";
+          setScanDisplayMode((scanDisplayMode === "integrated") ? "row" : "integrated");
 
           if (window.EmuUI && typeof window.EmuUI.log === "function") {
             window.EmuUI.log("[emu] scanMode = " + scanDisplayMode);
@@ -385,25 +729,30 @@
         if (e.code === "Space") {
           isRuntimePaused = !isRuntimePaused;
         }
+
+        if (e.code === "BracketLeft") stepSimulationSpeed(-1);
+        if (e.code === "BracketRight") stepSimulationSpeed(+1);
       });
 
-      requestAnimationFrame(updateFpsReadoutLoop);
+      setScanDisplayMode(scanDisplayMode);
+      setSimulationSpeed(simulationSpeedPercent);
+      requestAnimationFrame(animationFrameLoop);
     },
 
     /*
       renderFrame
 
-      Called by panel_emu.c whenever the emulated panel latches data (LatchRegister()).
+      Called by panel_emu.c on every latch (LatchRegister()) while the row-scan view is active.
 
       The parameters come directly from C:
         - framebufferPtr is a pointer into WASM memory
         - activeRowPair is the currently selected multiplexed row index
         - displayOn indicates whether the display is enabled
 
-      We increment the FPS counter, optionally log the one-time heap probe, and then draw.
+      We count the presentation, optionally log the one-time heap probe, and then draw.
     */
     renderFrame(framebufferPtr, activeRowPair, displayOn) {
-      renderedLatchCount++;
+      presentedFrameCount++;
 
       logInitialHeapProbe(framebufferPtr);
 
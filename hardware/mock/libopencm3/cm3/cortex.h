@@ -0,0 +1,16 @@
+/*
+  libopencm3/cm3/cortex.h (host mock)
+
+  Stand-in for the interrupt mask used by panel_hw.c; see libopencm3_mock.h. The mask (PRIMASK) is
+  only recorded: nothing preempts the host, so there is nothing for it to hold off.
+*/
+
+#ifndef MOCK_LIBOPENCM3_CORTEX_H
+#define MOCK_LIBOPENCM3_CORTEX_H
+
+#include <stdint.h>
+
+// Set (mask != 0) or clear the interrupt mask; returns the previous mask.
+uint32_t cm_mask_interrupts(uint32_t mask);
+
+#endif // MOCK_LIBOPENCM3_CORTEX_H
@@ -0,0 +1,21 @@
+/*
+  libopencm3/cm3/dwt.h (host mock)
+
+  Stand-in for the DWT cycle counter; see libopencm3_mock.h. The count starts wherever the test
+  sets it with mockDwtSetCycles(), and every read advances it by MOCK_DWT_CYCLES_PER_READ, so a
+  busy-wait on the counter ends.
+*/
+
+#ifndef MOCK_LIBOPENCM3_DWT_H
+#define MOCK_LIBOPENCM3_DWT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cycles that pass per dwt_read_cycle_counter() call: about one turn of a polling loop.
+#define MOCK_DWT_CYCLES_PER_READ 16u
+
+bool dwt_enable_cycle_counter(void);
+uint32_t dwt_read_cycle_counter(void);
+
+#endif // MOCK_LIBOPENCM3_DWT_H
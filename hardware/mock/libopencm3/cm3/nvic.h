@@ -0,0 +1,27 @@
+/*
+  libopencm3/cm3/nvic.h (host mock)
+
+  Stand-in for the NVIC calls and the TIM2 vector used by panel_hw.c; see libopencm3_mock.h.
+  __WFI() (normally a `wfi` instruction) becomes mockWaitForInterrupt(), which delivers the next
+  timer interrupt synchronously.
+*/
+
+#ifndef MOCK_LIBOPENCM3_NVIC_H
+#define MOCK_LIBOPENCM3_NVIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NVIC_TIM2_IRQ 28
+#define MOCK_NVIC_IRQS 82
+
+void nvic_enable_irq(uint8_t irqn);
+void nvic_disable_irq(uint8_t irqn);
+
+// The TIM2 interrupt vector, defined by the driver (the mock's default does nothing).
+void tim2_isr(void);
+
+void mockWaitForInterrupt(void);
+#define __WFI() mockWaitForInterrupt()
+
+#endif // MOCK_LIBOPENCM3_NVIC_H
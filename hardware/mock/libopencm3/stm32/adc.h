@@ -0,0 +1,60 @@
+/*
+  libopencm3/stm32/adc.h (host mock)
+
+  Stand-in for the STM32F3 ADC calls used by panel_hw.c; see libopencm3_mock.h. The converter is
+  modelled at the level of conversions (channel values set by the test, conversion time from the
+  sample time) rather than analogue behaviour.
+*/
+
+#ifndef MOCK_LIBOPENCM3_ADC_H
+#define MOCK_LIBOPENCM3_ADC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ADC1 0u
+#define MOCK_ADC_COUNT 1
+#define MOCK_ADC_CHANNELS 19
+
+#define ADC_CCR_CKMODE_CKX  0x0
+#define ADC_CCR_CKMODE_DIV1 0x1
+#define ADC_CCR_CKMODE_DIV2 0x2
+#define ADC_CCR_CKMODE_DIV4 0x3
+
+// Sample times (SMP codes; the F3 values are 1.5 .. 601.5 ADC clocks).
+#define ADC_SMPR_SMP_1DOT5CYC   0x0
+#define ADC_SMPR_SMP_2DOT5CYC   0x1
+#define ADC_SMPR_SMP_4DOT5CYC   0x2
+#define ADC_SMPR_SMP_7DOT5CYC   0x3
+#define ADC_SMPR_SMP_19DOT5CYC  0x4
+#define ADC_SMPR_SMP_61DOT5CYC  0x5
+#define ADC_SMPR_SMP_181DOT5CYC 0x6
+#define ADC_SMPR_SMP_601DOT5CYC 0x7
+
+#define ADC_CFGR1_RES_12_BIT 0x0
+#define ADC_CFGR1_RES_10_BIT 0x1
+#define ADC_CFGR1_RES_8_BIT  0x2
+#define ADC_CFGR1_RES_6_BIT  0x3
+
+// Regular data register, as an lvalue whose address can be handed to the DMA.
+volatile uint32_t* mockAdcDataRegister(uint32_t adc);
+#define ADC_DR(adc) (*mockAdcDataRegister(adc))
+
+void adc_power_on(uint32_t adc);
+void adc_power_off(uint32_t adc);
+void adc_set_clk_prescale(uint32_t adc, uint32_t prescaler);
+void adc_disable_external_trigger_regular(uint32_t adc);
+void adc_set_right_aligned(uint32_t adc);
+void adc_set_sample_time_on_all_channels(uint32_t adc, uint8_t time);
+void adc_set_resolution(uint32_t adc, uint16_t resolution);
+void adc_set_single_conversion_mode(uint32_t adc);
+void adc_set_continuous_conversion_mode(uint32_t adc);
+void adc_set_regular_sequence(uint32_t adc, uint8_t length, uint8_t channel[]);
+void adc_enable_dma(uint32_t adc);
+void adc_disable_dma(uint32_t adc);
+void adc_enable_dma_circular_mode(uint32_t adc);
+void adc_start_conversion_regular(uint32_t adc);
+bool adc_eoc(uint32_t adc);
+uint32_t adc_read_regular(uint32_t adc);
+
+#endif // MOCK_LIBOPENCM3_ADC_H
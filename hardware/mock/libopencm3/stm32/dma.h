@@ -0,0 +1,57 @@
+/*
+  libopencm3/stm32/dma.h (host mock)
+
+  Stand-in for the STM32F3 DMA calls used by panel_hw.c; see libopencm3_mock.h. Addresses are
+  uintptr_t here (uint32_t on the target, where the two are the same width) so that host
+  pointers survive the round trip.
+*/
+
+#ifndef MOCK_LIBOPENCM3_DMA_H
+#define MOCK_LIBOPENCM3_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DMA1 0u
+
+#define DMA_CHANNEL1 1
+#define DMA_CHANNEL2 2
+#define DMA_CHANNEL3 3
+#define DMA_CHANNEL4 4
+#define DMA_CHANNEL5 5
+#define DMA_CHANNEL6 6
+#define DMA_CHANNEL7 7
+#define MOCK_DMA_CHANNELS 7
+
+#define DMA_CCR_PSIZE_8BIT  (0x0 << 8)
+#define DMA_CCR_PSIZE_16BIT (0x1 << 8)
+#define DMA_CCR_PSIZE_32BIT (0x2 << 8)
+#define DMA_CCR_MSIZE_8BIT  (0x0 << 10)
+#define DMA_CCR_MSIZE_16BIT (0x1 << 10)
+#define DMA_CCR_MSIZE_32BIT (0x2 << 10)
+#define DMA_CCR_PL_LOW       (0x0 << 12)
+#define DMA_CCR_PL_MEDIUM    (0x1 << 12)
+#define DMA_CCR_PL_HIGH      (0x2 << 12)
+#define DMA_CCR_PL_VERY_HIGH (0x3 << 12)
+
+// Channel interrupt flags (ISR/IFCR bits, per channel).
+#define DMA_GIF  (1 << 0)
+#define DMA_TCIF (1 << 1)
+
+void dma_channel_reset(uint32_t dma, uint8_t channel);
+void dma_set_peripheral_address(uint32_t dma, uint8_t channel, uintptr_t address);
+void dma_set_memory_address(uint32_t dma, uint8_t channel, uintptr_t address);
+void dma_set_number_of_data(uint32_t dma, uint8_t channel, uint16_t number);
+void dma_set_read_from_peripheral(uint32_t dma, uint8_t channel);
+void dma_set_read_from_memory(uint32_t dma, uint8_t channel);
+void dma_enable_memory_increment_mode(uint32_t dma, uint8_t channel);
+void dma_set_peripheral_size(uint32_t dma, uint8_t channel, uint32_t peripheral_size);
+void dma_set_memory_size(uint32_t dma, uint8_t channel, uint32_t memory_size);
+void dma_enable_circular_mode(uint32_t dma, uint8_t channel);
+void dma_set_priority(uint32_t dma, uint8_t channel, uint32_t prio);
+void dma_enable_channel(uint32_t dma, uint8_t channel);
+void dma_disable_channel(uint32_t dma, uint8_t channel);
+bool dma_get_interrupt_flag(uint32_t dma, uint8_t channel, uint32_t interrupts);
+void dma_clear_interrupt_flags(uint32_t dma, uint8_t channel, uint32_t interrupts);
+
+#endif // MOCK_LIBOPENCM3_DMA_H
@@ -0,0 +1,64 @@
+/*
+  libopencm3/stm32/gpio.h (host mock)
+
+  Stand-in for the libopencm3 GPIO calls and the BSRR register used by panel_hw.c; see
+  libopencm3_mock.h. Ports are small indices into the mock's register file rather than
+  addresses.
+
+  GPIO_BSRR(port) is an lvalue, as on the target. A store to it is applied to the port's output
+  register by the next mock call (or mockGpioFlush()), so every write is seen in program order.
+*/
+
+#ifndef MOCK_LIBOPENCM3_GPIO_H
+#define MOCK_LIBOPENCM3_GPIO_H
+
+#include <stdint.h>
+
+#define GPIOA 0u
+#define GPIOB 1u
+#define GPIOC 2u
+#define MOCK_GPIO_PORTS 3
+
+#define GPIO0  (1u << 0)
+#define GPIO1  (1u << 1)
+#define GPIO2  (1u << 2)
+#define GPIO3  (1u << 3)
+#define GPIO4  (1u << 4)
+#define GPIO5  (1u << 5)
+#define GPIO6  (1u << 6)
+#define GPIO7  (1u << 7)
+#define GPIO8  (1u << 8)
+#define GPIO9  (1u << 9)
+#define GPIO10 (1u << 10)
+#define GPIO11 (1u << 11)
+#define GPIO12 (1u << 12)
+#define GPIO13 (1u << 13)
+#define GPIO14 (1u << 14)
+#define GPIO15 (1u << 15)
+
+#define GPIO_MODE_INPUT  0x0
+#define GPIO_MODE_OUTPUT 0x1
+#define GPIO_MODE_AF     0x2
+#define GPIO_MODE_ANALOG 0x3
+
+#define GPIO_PUPD_NONE     0x0
+#define GPIO_PUPD_PULLUP   0x1
+#define GPIO_PUPD_PULLDOWN 0x2
+
+#define GPIO_OTYPE_PP 0x0
+#define GPIO_OTYPE_OD 0x1
+
+#define GPIO_OSPEED_2MHZ   0x0
+#define GPIO_OSPEED_25MHZ  0x1
+#define GPIO_OSPEED_50MHZ  0x2
+#define GPIO_OSPEED_100MHZ 0x3
+
+volatile uint32_t* mockGpioBsrr(uint32_t gpioport);
+#define GPIO_BSRR(port) (*mockGpioBsrr(port))
+
+void gpio_set(uint32_t gpioport, uint16_t gpios);
+void gpio_clear(uint32_t gpioport, uint16_t gpios);
+void gpio_mode_setup(uint32_t gpioport, uint8_t mode, uint8_t pull_up_down, uint16_t gpios);
+void gpio_set_output_options(uint32_t gpioport, uint8_t otype, uint8_t speed, uint16_t gpios);
+
+#endif // MOCK_LIBOPENCM3_GPIO_H
@@ -0,0 +1,30 @@
+/*
+  libopencm3/stm32/rcc.h (host mock)
+
+  Stand-in for the libopencm3 RCC calls and clock frequencies used by panel_hw.c; see libopencm3_mock.h.
+*/
+
+#ifndef MOCK_LIBOPENCM3_RCC_H
+#define MOCK_LIBOPENCM3_RCC_H
+
+#include <stdint.h>
+
+// AHB clock in Hz (reset value: the 8 MHz HSI, as on the board before any clock setup).
+extern uint32_t rcc_ahb_frequency;
+// APB1 clock in Hz (reset value: HSI with the APB1 prescaler at 1, so TIM2 runs at this rate too).
+extern uint32_t rcc_apb1_frequency;
+
+enum rcc_periph_clken {
+  RCC_GPIOA,
+  RCC_GPIOB,
+  RCC_GPIOC,
+  RCC_ADC12,
+  RCC_DMA1,
+  RCC_TIM2,
+  RCC_TIM3,
+  RCC_PERIPH_COUNT
+};
+
+void rcc_periph_clock_enable(enum rcc_periph_clken clken);
+
+#endif // MOCK_LIBOPENCM3_RCC_H
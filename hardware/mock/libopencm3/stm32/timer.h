@@ -0,0 +1,32 @@
+/*
+  libopencm3/stm32/timer.h (host mock)
+
+  Stand-in for the general-purpose timer calls used by panel_hw.c; see libopencm3_mock.h. TIM2's
+  update event "happens" when mockWaitForInterrupt() is called; TIM3's update event only serves
+  as the DMA request that plays a memory-to-GPIO transfer.
+*/
+
+#ifndef MOCK_LIBOPENCM3_TIMER_H
+#define MOCK_LIBOPENCM3_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TIM2 0u
+#define TIM3 1u
+#define MOCK_TIMER_COUNT 2
+
+#define TIM_DIER_UIE (1 << 0)
+#define TIM_DIER_UDE (1 << 8)
+#define TIM_SR_UIF   (1 << 0)
+
+void timer_set_prescaler(uint32_t timer_peripheral, uint32_t value);
+void timer_set_period(uint32_t timer_peripheral, uint32_t period);
+void timer_enable_irq(uint32_t timer_peripheral, uint32_t irq);
+void timer_disable_irq(uint32_t timer_peripheral, uint32_t irq);
+void timer_enable_counter(uint32_t timer_peripheral);
+void timer_disable_counter(uint32_t timer_peripheral);
+bool timer_get_flag(uint32_t timer_peripheral, uint32_t flag);
+void timer_clear_flag(uint32_t timer_peripheral, uint32_t flag);
+
+#endif // MOCK_LIBOPENCM3_TIMER_H
@@ -0,0 +1,693 @@
+/*
+  libopencm3_mock.c
+
+  What this file does
+  -------------------
+  Implementation of the host-side libopencm3 stand-in described in libopencm3_mock.h.
+*/
+
+#include "libopencm3_mock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Mock register file
+// -----------------------------------------------------------------------------
+
+typedef struct {
+  uint32_t moder;          // two bits per pin, GPIO_MODE_*
+  uint16_t odr;
+  volatile uint32_t bsrr;  // last store through GPIO_BSRR(), applied by flushBsrr()
+} MockGpioPort;
+
+typedef struct {
+  bool powered;
+  bool continuous;
+  bool started;
+  bool dmaRequests;
+  bool dmaCircular;
+  uint8_t sampleTime;
+  uint16_t resolution;
+  uint8_t sequence[16];
+  int sequenceLength;
+  uint32_t channelValue[MOCK_ADC_CHANNELS];
+  uint32_t pendingWaitClocks; // conversion started in single mode, not yet waited for
+  volatile uint32_t dr;
+} MockAdc;
+
+typedef struct {
+  bool enabled;
+  bool fromPeripheral;
+  bool memoryIncrement;
+  bool circular;
+  uint32_t peripheralSize;
+  uint32_t memorySize;
+  uint32_t priority;
+  uintptr_t peripheralAddress;
+  uintptr_t memoryAddress;
+  uint16_t number;     // CNDTR reload value
+  uint16_t remaining;  // CNDTR
+  uint32_t flags;      // DMA_TCIF
+} MockDmaChannel;
+
+typedef struct {
+  uint32_t prescaler;
+  uint32_t period;
+  uint32_t dier;
+  uint32_t sr;
+  bool counting;
+} MockTimer;
+
+uint32_t rcc_ahb_frequency = 8000000u;
+uint32_t rcc_apb1_frequency = 8000000u;
+
+static bool rccEnabled[RCC_PERIPH_COUNT];
+static MockGpioPort gpioPorts[MOCK_GPIO_PORTS];
+static int pendingBsrrPort = -1;
+static MockAdc adcs[MOCK_ADC_COUNT];
+static MockAdcStats adcStats;
+static MockDmaChannel dmaChannels[MOCK_DMA_CHANNELS + 1]; // indexed by DMA_CHANNELn (1-based)
+static uint32_t dwtCycles;
+static uint32_t interruptMask;
+static MockTimer timers[MOCK_TIMER_COUNT];
+static MockTimerStats timerStats;
+static bool nvicEnabled[MOCK_NVIC_IRQS];
+
+// Pin-level panel model (mockPanelAttach()). The register is stored like panel_native.c's: logical
+// bit i (0 = oldest, 191 = newest) in shiftRegister[i / 64], bit i % 64; in parallel wiring chain
+// c holds data line c, newest column at bit 31.
+typedef struct {
+  bool attached;
+  MockPanelWiring wiring;
+  uint64_t shiftRegister[3];
+  uint32_t chains[6];
+  uint32_t latchedPlanes[32][3]; // bit x = pixel x; planes red, green, blue
+  uint32_t latchedRowMask;
+} MockPanel;
+
+static MockPanel panel;
+static MockPanelStats panelStats;
+
+static void panelClearState(void);
+static void dmaTransferToGpio(MockDmaChannel* c);
+static void panelObserve(int port, uint16_t before, uint16_t after);
+
+// ADC clocks per sample time, times two (the F3 sample times end in .5).
+static const uint32_t sampleTimeHalfClocks[8] = {3, 5, 9, 15, 39, 123, 363, 1203};
+
+void mockReset(void) {
+  memset(rccEnabled, 0, sizeof(rccEnabled));
+  memset(gpioPorts, 0, sizeof(gpioPorts));
+  pendingBsrrPort = -1;
+  memset(adcs, 0, sizeof(adcs));
+  memset(&adcStats, 0, sizeof(adcStats));
+  memset(dmaChannels, 0, sizeof(dmaChannels));
+  dwtCycles = 0;
+  interruptMask = 0;
+  memset(timers, 0, sizeof(timers));
+  memset(&timerStats, 0, sizeof(timerStats));
+  memset(nvicEnabled, 0, sizeof(nvicEnabled));
+  rcc_ahb_frequency = 8000000u;
+  rcc_apb1_frequency = 8000000u;
+  panelClearState();
+  memset(&panelStats, 0, sizeof(panelStats));
+}
+
+// -----------------------------------------------------------------------------
+// RCC
+// -----------------------------------------------------------------------------
+
+void rcc_periph_clock_enable(enum rcc_periph_clken clken) {
+  if ((int)clken >= 0 && clken < RCC_PERIPH_COUNT) rccEnabled[clken] = true;
+}
+
+bool mockRccEnabled(enum rcc_periph_clken clken) {
+  return ((int)clken >= 0 && clken < RCC_PERIPH_COUNT) ? rccEnabled[clken] : false;
+}
+
+// -----------------------------------------------------------------------------
+// GPIO
+// -----------------------------------------------------------------------------
+
+/*
+  flushBsrr
+
+  Apply the last GPIO_BSRR() store: the low half sets pins, the high half resets them (set wins
+  when both name a pin, as on the target).
+*/
+static void flushBsrr(void) {
+  if (pendingBsrrPort < 0) return;
+  MockGpioPort* port = &gpioPorts[pendingBsrrPort];
+  const uint32_t value = port->bsrr;
+  const uint16_t before = port->odr;
+  const int index = pendingBsrrPort;
+  pendingBsrrPort = -1;
+  port->odr = (uint16_t)((port->odr & ~(value >> 16)) | (value & 0xFFFFu));
+  panelObserve(index, before, port->odr);
+}
+
+volatile uint32_t* mockGpioBsrr(uint32_t gpioport) {
+  flushBsrr();
+  panelStats.gpioWrites++;
+  MockGpioPort* port = &gpioPorts[gpioport % MOCK_GPIO_PORTS];
+  port->bsrr = 0;
+  pendingBsrrPort = (int)(gpioport % MOCK_GPIO_PORTS);
+  return &port->bsrr;
+}
+
+void gpio_set(uint32_t gpioport, uint16_t gpios) {
+  *mockGpioBsrr(gpioport) = gpios;
+  flushBsrr();
+}
+
+void gpio_clear(uint32_t gpioport, uint16_t gpios) {
+  *mockGpioBsrr(gpioport) = (uint32_t)gpios << 16;
+  flushBsrr();
+}
+
+void gpio_mode_setup(uint32_t gpioport, uint8_t mode, uint8_t pull_up_down, uint16_t gpios) {
+  (void)pull_up_down;
+  flushBsrr();
+  MockGpioPort* port = &gpioPorts[gpioport % MOCK_GPIO_PORTS];
+  for (int pin = 0; pin < 16; pin++) {
+    if (gpios & (1u << pin)) {
+      port->moder = (port->moder & ~(3u << (2 * pin))) | ((uint32_t)(mode & 3u) << (2 * pin));
+    }
+  }
+}
+
+void gpio_set_output_options(uint32_t gpioport, uint8_t otype, uint8_t speed, uint16_t gpios) {
+  (void)gpioport;
+  (void)otype;
+  (void)speed;
+  (void)gpios;
+  flushBsrr();
+}
+
+void mockGpioFlush(void) {
+  flushBsrr();
+}
+
+uint16_t mockGpioOutput(uint32_t gpioport) {
+  flushBsrr();
+  return gpioPorts[gpioport % MOCK_GPIO_PORTS].odr;
+}
+
+uint8_t mockGpioMode(uint32_t gpioport, int pin) {
+  flushBsrr();
+  return (uint8_t)((gpioPorts[gpioport % MOCK_GPIO_PORTS].moder >> (2 * pin)) & 3u);
+}
+
+// -----------------------------------------------------------------------------
+// Panel model
+// -----------------------------------------------------------------------------
+
+static void panelClearState(void) {
+  memset(panel.shiftRegister, 0, sizeof(panel.shiftRegister));
+  memset(panel.chains, 0, sizeof(panel.chains));
+  memset(panel.latchedPlanes, 0, sizeof(panel.latchedPlanes));
+  panel.latchedRowMask = 0;
+}
+
+/*
+  panelClock
+
+  A rising clock edge: shift in the data pin of `odr` (the panel port's new output), or in
+  parallel wiring one column from the data port.
+*/
+static void panelClock(uint16_t odr) {
+  const MockPanelWiring* w = &panel.wiring;
+  panelStats.clockEdges++;
+  if (w->parallel) {
+    const uint32_t rgb6 = ((uint32_t)gpioPorts[w->dataPort % MOCK_GPIO_PORTS].odr >> w->dataShift) & 0x3Fu;
+    for (int c = 0; c < 6; c++) {
+      panel.chains[c] = (panel.chains[c] >> 1) | (((rgb6 >> c) & 1u) << 31);
+    }
+    return;
+  }
+  const uint64_t bit = (odr & w->dataPin) ? 1u : 0u;
+  panel.shiftRegister[0] = (panel.shiftRegister[0] >> 1) | (panel.shiftRegister[1] << 63);
+  panel.shiftRegister[1] = (panel.shiftRegister[1] >> 1) | (panel.shiftRegister[2] << 63);
+  panel.shiftRegister[2] = (panel.shiftRegister[2] >> 1) | (bit << 63);
+}
+
+/*
+  panelLatch
+
+  A rising latch edge: decode the A..D pins of `odr` and copy the register into that row-pair,
+  one colour plane per 32 bits (see PANEL_ROW_WORDS in panel.h).
+*/
+static void panelLatch(uint16_t odr) {
+  const MockPanelWiring* w = &panel.wiring;
+  int address = 0;
+  for (int i = 0; i < 4; i++) {
+    if (odr & w->addressPins[i]) address |= 1 << i;
+  }
+  const int top = (address - w->rowOffset) & 0x0F;
+  const int bottom = top + 16;
+
+  if (w->parallel) {
+    for (int plane = 0; plane < 3; plane++) {
+      panel.latchedPlanes[top][plane] = panel.chains[plane];
+      panel.latchedPlanes[bottom][plane] = panel.chains[plane + 3];
+    }
+  } else {
+    panel.latchedPlanes[top][0] = (uint32_t)panel.shiftRegister[0];
+    panel.latchedPlanes[top][1] = (uint32_t)(panel.shiftRegister[0] >> 32);
+    panel.latchedPlanes[top][2] = (uint32_t)panel.shiftRegister[1];
+    panel.latchedPlanes[bottom][0] = (uint32_t)(panel.shiftRegister[1] >> 32);
+    panel.latchedPlanes[bottom][1] = (uint32_t)panel.shiftRegister[2];
+    panel.latchedPlanes[bottom][2] = (uint32_t)(panel.shiftRegister[2] >> 32);
+  }
+
+  panelStats.latches++;
+  panel.latchedRowMask |= 1u << top;
+  if (panel.latchedRowMask == 0xFFFFu) {
+    panel.latchedRowMask = 0;
+    panelStats.scans++;
+  }
+}
+
+/*
+  panelObserve
+
+  Called with a port's output before and after every change. Only the panel port's clock and
+  latch edges act; the data and address pins are sampled at those edges.
+*/
+static void panelObserve(int port, uint16_t before, uint16_t after) {
+  if (!panel.attached || port != (int)(panel.wiring.port % MOCK_GPIO_PORTS)) return;
+  const uint16_t rising = (uint16_t)(~before & after);
+  if (rising & panel.wiring.clockPin) panelClock(after);
+  if (rising & panel.wiring.latchPin) panelLatch(after);
+}
+
+void mockPanelAttach(const MockPanelWiring* wiring) {
+  flushBsrr();
+  panel.attached = (wiring != NULL);
+  if (wiring != NULL) panel.wiring = *wiring;
+  panelClearState();
+}
+
+uint8_t mockPanelPixel(int x, int y) {
+  flushBsrr();
+  if (x < 0 || x >= 32 || y < 0 || y >= 32) return 0;
+  return (uint8_t)(((panel.latchedPlanes[y][0] >> x) & 1u) |
+                   (((panel.latchedPlanes[y][1] >> x) & 1u) << 1) |
+                   (((panel.latchedPlanes[y][2] >> x) & 1u) << 2));
+}
+
+const MockPanelStats* mockPanelStats(void) {
+  flushBsrr();
+  return &panelStats;
+}
+
+// -----------------------------------------------------------------------------
+// DMA
+// -----------------------------------------------------------------------------
+
+static MockDmaChannel* dmaChannel(uint32_t dma, uint8_t channel) {
+  (void)dma;
+  return (channel >= 1 && channel <= MOCK_DMA_CHANNELS) ? &dmaChannels[channel] : &dmaChannels[0];
+}
+
+void dma_channel_reset(uint32_t dma, uint8_t channel) {
+  memset(dmaChannel(dma, channel), 0, sizeof(MockDmaChannel));
+}
+
+void dma_set_peripheral_address(uint32_t dma, uint8_t channel, uintptr_t address) {
+  dmaChannel(dma, channel)->peripheralAddress = address;
+}
+
+void dma_set_memory_address(uint32_t dma, uint8_t channel, uintptr_t address) {
+  dmaChannel(dma, channel)->memoryAddress = address;
+}
+
+void dma_set_number_of_data(uint32_t dma, uint8_t channel, uint16_t number) {
+  MockDmaChannel* c = dmaChannel(dma, channel);
+  c->number = number;
+  c->remaining = number;
+}
+
+void dma_set_read_from_peripheral(uint32_t dma, uint8_t channel) {
+  dmaChannel(dma, channel)->fromPeripheral = true;
+}
+
+void dma_set_read_from_memory(uint32_t dma, uint8_t channel) {
+  dmaChannel(dma, channel)->fromPeripheral = false;
+}
+
+void dma_enable_memory_increment_mode(uint32_t dma, uint8_t channel) {
+  dmaChannel(dma, channel)->memoryIncrement = true;
+}
+
+void dma_set_peripheral_size(uint32_t dma, uint8_t channel, uint32_t peripheral_size) {
+  dmaChannel(dma, channel)->peripheralSize = peripheral_size;
+}
+
+void dma_set_memory_size(uint32_t dma, uint8_t channel, uint32_t memory_size) {
+  dmaChannel(dma, channel)->memorySize = memory_size;
+}
+
+void dma_enable_circular_mode(uint32_t dma, uint8_t channel) {
+  dmaChannel(dma, channel)->circular = true;
+}
+
+void dma_set_priority(uint32_t dma, uint8_t channel, uint32_t prio) {
+  dmaChannel(dma, channel)->priority = prio;
+}
+
+void dma_enable_channel(uint32_t dma, uint8_t channel) {
+  MockDmaChannel* c = dmaChannel(dma, channel);
+  c->enabled = true;
+  if (channel == DMA_CHANNEL3) dmaTransferToGpio(c);
+}
+
+void dma_disable_channel(uint32_t dma, uint8_t channel) {
+  dmaChannel(dma, channel)->enabled = false;
+}
+
+bool dma_get_interrupt_flag(uint32_t dma, uint8_t channel, uint32_t interrupts) {
+  return (dmaChannel(dma, channel)->flags & interrupts) != 0;
+}
+
+void dma_clear_interrupt_flags(uint32_t dma, uint8_t channel, uint32_t interrupts) {
+  dmaChannel(dma, channel)->flags &= ~interrupts;
+}
+
+uint16_t mockDmaRemaining(uint32_t dma, uint8_t channel) {
+  return dmaChannel(dma, channel)->remaining;
+}
+
+/*
+  dmaTransferFromAdc
+
+  Service one ADC request on DMA1 channel 1 (ADC1's channel on the F3): copy ADC_DR to memory at
+  the channel's current position with its memory size, then step or reload the count. Returns
+  true when this transfer was the last of the count.
+*/
+static bool dmaTransferFromAdc(MockAdc* adc) {
+  MockDmaChannel* c = &dmaChannels[DMA_CHANNEL1];
+  if (!c->enabled || !c->fromPeripheral || c->remaining == 0) return false;
+  if (c->peripheralAddress != (uintptr_t)&adc->dr) return false;
+
+  const uint32_t index = c->memoryIncrement ? (uint32_t)(c->number - c->remaining) : 0u;
+  if (c->memorySize == DMA_CCR_MSIZE_8BIT) {
+    ((volatile uint8_t*)c->memoryAddress)[index] = (uint8_t)adc->dr;
+  } else if (c->memorySize == DMA_CCR_MSIZE_16BIT) {
+    ((volatile uint16_t*)c->memoryAddress)[index] = (uint16_t)adc->dr;
+  } else {
+    ((volatile uint32_t*)c->memoryAddress)[index] = adc->dr;
+  }
+  adcStats.dmaTransfers++;
+
+  c->remaining--;
+  if (c->remaining != 0) return false;
+  if (c->circular) c->remaining = c->number;
+  return true;
+}
+
+/*
+  dmaTransferToGpio
+
+  Play an enabled memory-to-peripheral transfer on DMA1 channel 3 (TIM3_UP's channel on the F3)
+  whose peripheral address is a GPIO port's BSRR: one store per TIM3 update event, all of them at
+  once here, each applied to the pins (and the panel model) before the next. Nothing moves unless
+  TIM3 is counting with its DMA request enabled, as on the target.
+*/
+static void dmaTransferToGpio(MockDmaChannel* c) {
+  const MockTimer* trigger = &timers[TIM3];
+  if (!c->enabled || c->fromPeripheral || c->remaining == 0) return;
+  if (!trigger->counting || !(trigger->dier & TIM_DIER_UDE)) return;
+
+  int port = -1;
+  for (int p = 0; p < MOCK_GPIO_PORTS; p++) {
+    if (c->peripheralAddress == (uintptr_t)&gpioPorts[p].bsrr) port = p;
+  }
+  if (port < 0) return;
+
+  while (c->remaining > 0) {
+    const uint32_t index = c->memoryIncrement ? (uint32_t)(c->number - c->remaining) : 0u;
+    const uint32_t value = (c->memorySize == DMA_CCR_MSIZE_16BIT)
+                               ? ((const volatile uint16_t*)c->memoryAddress)[index]
+                               : ((const volatile uint32_t*)c->memoryAddress)[index];
+    *mockGpioBsrr((uint32_t)port) = value;
+    flushBsrr();
+    panelStats.dmaGpioWrites++;
+    c->remaining--;
+  }
+  c->flags |= DMA_TCIF | DMA_GIF;
+}
+
+// -----------------------------------------------------------------------------
+// ADC
+// -----------------------------------------------------------------------------
+
+volatile uint32_t* mockAdcDataRegister(uint32_t adc) {
+  return &adcs[adc % MOCK_ADC_COUNT].dr;
+}
+
+void adc_power_on(uint32_t adc) {
+  adcs[adc % MOCK_ADC_COUNT].powered = true;
+}
+
+void adc_power_off(uint32_t adc) {
+  MockAdc* a = &adcs[adc % MOCK_ADC_COUNT];
+  a->powered = false;
+  a->started = false;
+}
+
+void adc_set_clk_prescale(uint32_t adc, uint32_t prescaler) {
+  (void)adc;
+  (void)prescaler;
+}
+
+void adc_disable_external_trigger_regular(uint32_t adc) {
+  (void)adc;
+}
+
+void adc_set_right_aligned(uint32_t adc) {
+  (void)adc;
+}
+
+void adc_set_sample_time_on_all_channels(uint32_t adc, uint8_t time) {
+  adcs[adc % MOCK_ADC_COUNT].sampleTime = (uint8_t)(time & 7u);
+}
+
+void adc_set_resolution(uint32_t adc, uint16_t resolution) {
+  adcs[adc % MOCK_ADC_COUNT].resolution = resolution;
+}
+
+void adc_set_single_conversion_mode(uint32_t adc) {
+  adcs[adc % MOCK_ADC_COUNT].continuous = false;
+}
+
+void adc_set_continuous_conversion_mode(uint32_t adc) {
+  adcs[adc % MOCK_ADC_COUNT].continuous = true;
+}
+
+void adc_set_regular_sequence(uint32_t adc, uint8_t length, uint8_t channel[]) {
+  MockAdc* a = &adcs[adc % MOCK_ADC_COUNT];
+  a->sequenceLength = (length > 16) ? 16 : length;
+  for (int i = 0; i < a->sequenceLength; i++) a->sequence[i] = channel[i];
+}
+
+void adc_enable_dma(uint32_t adc) {
+  adcs[adc % MOCK_ADC_COUNT].dmaRequests = true;
+}
+
+void adc_disable_dma(uint32_t adc) {
+  adcs[adc % MOCK_ADC_COUNT].dmaRequests = false;
+}
+
+void adc_enable_dma_circular_mode(uint32_t adc) {
+  adcs[adc % MOCK_ADC_COUNT].dmaCircular = true;
+}
+
+uint32_t mockAdcConversionClocks(uint32_t adc) {
+  // sample time + 12.5 clocks for a 12-bit result, in half clocks, rounded up
+  return (sampleTimeHalfClocks[adcs[adc % MOCK_ADC_COUNT].sampleTime] + 25u + 1u) / 2u;
+}
+
+/*
+  convert
+
+  One conversion of `channel`: the result lands in ADC_DR (masked to the configured resolution)
+  and, in DMA mode, is handed to the DMA. Unless the ADC's DMA circular mode is on, its DMA
+  requests stop after the DMA's last transfer (one-shot mode).
+*/
+static void convert(MockAdc* a, int channel) {
+  static const uint32_t resolutionMask[4] = {0xFFFu, 0x3FFu, 0xFFu, 0x3Fu};
+  const uint32_t value = (channel >= 0 && channel < MOCK_ADC_CHANNELS) ? a->channelValue[channel] : 0u;
+  a->dr = value & resolutionMask[a->resolution & 3u];
+  adcStats.conversions++;
+  if (a->dmaRequests && dmaTransferFromAdc(a) && !a->dmaCircular) a->dmaRequests = false;
+}
+
+void adc_start_conversion_regular(uint32_t adc) {
+  MockAdc* a = &adcs[adc % MOCK_ADC_COUNT];
+  if (!a->powered) return;
+  if (a->continuous) {
+    a->started = true;
+    return;
+  }
+  // Single mode: the sequence converts at once; the driver's adc_eoc() wait is what it costs.
+  for (int i = 0; i < a->sequenceLength; i++) {
+    convert(a, a->sequence[i]);
+  }
+  a->pendingWaitClocks += (uint32_t)a->sequenceLength * mockAdcConversionClocks(adc);
+}
+
+bool adc_eoc(uint32_t adc) {
+  MockAdc* a = &adcs[adc % MOCK_ADC_COUNT];
+  adcStats.eocPolls++;
+  if (a->pendingWaitClocks != 0) {
+    adcStats.blockingReads++;
+    adcStats.busyWaitClocks += a->pendingWaitClocks;
+    a->pendingWaitClocks = 0;
+  }
+  return true;
+}
+
+uint32_t adc_read_regular(uint32_t adc) {
+  return adcs[adc % MOCK_ADC_COUNT].dr;
+}
+
+void mockAdcSetChannel(int channel, uint32_t value) {
+  if (channel >= 0 && channel < MOCK_ADC_CHANNELS) adcs[0].channelValue[channel] = value;
+}
+
+bool mockAdcRunSequences(uint32_t adc, uint32_t count) {
+  MockAdc* a = &adcs[adc % MOCK_ADC_COUNT];
+  if (!a->powered || !a->started || !a->continuous) return false;
+  for (uint32_t n = 0; n < count; n++) {
+    for (int i = 0; i < a->sequenceLength; i++) {
+      convert(a, a->sequence[i]);
+    }
+  }
+  return true;
+}
+
+bool mockAdcIsContinuous(uint32_t adc) {
+  return adcs[adc % MOCK_ADC_COUNT].continuous;
+}
+
+int mockAdcSequence(uint32_t adc, uint8_t* channels, int capacity) {
+  const MockAdc* a = &adcs[adc % MOCK_ADC_COUNT];
+  for (int i = 0; i < a->sequenceLength && i < capacity; i++) channels[i] = a->sequence[i];
+  return a->sequenceLength;
+}
+
+const MockAdcStats* mockAdcStats(void) {
+  return &adcStats;
+}
+
+// -----------------------------------------------------------------------------
+// DWT
+// -----------------------------------------------------------------------------
+
+bool dwt_enable_cycle_counter(void) {
+  return true;
+}
+
+uint32_t dwt_read_cycle_counter(void) {
+  const uint32_t cycles = dwtCycles;
+  dwtCycles += MOCK_DWT_CYCLES_PER_READ;
+  return cycles;
+}
+
+void mockDwtSetCycles(uint32_t cycles) {
+  dwtCycles = cycles;
+}
+
+// -----------------------------------------------------------------------------
+// Interrupt mask
+// -----------------------------------------------------------------------------
+
+uint32_t cm_mask_interrupts(uint32_t mask) {
+  const uint32_t previous = interruptMask;
+  interruptMask = (mask != 0);
+  return previous;
+}
+
+// -----------------------------------------------------------------------------
+// TIM2 and NVIC
+// -----------------------------------------------------------------------------
+
+static MockTimer* timer(uint32_t timer_peripheral) {
+  return &timers[timer_peripheral % MOCK_TIMER_COUNT];
+}
+
+void timer_set_prescaler(uint32_t timer_peripheral, uint32_t value) {
+  timer(timer_peripheral)->prescaler = value;
+}
+
+void timer_set_period(uint32_t timer_peripheral, uint32_t period) {
+  timer(timer_peripheral)->period = period;
+}
+
+void timer_enable_irq(uint32_t timer_peripheral, uint32_t irq) {
+  timer(timer_peripheral)->dier |= irq;
+}
+
+void timer_disable_irq(uint32_t timer_peripheral, uint32_t irq) {
+  timer(timer_peripheral)->dier &= ~irq;
+}
+
+void timer_enable_counter(uint32_t timer_peripheral) {
+  timer(timer_peripheral)->counting = true;
+}
+
+void timer_disable_counter(uint32_t timer_peripheral) {
+  timer(timer_peripheral)->counting = false;
+}
+
+bool timer_get_flag(uint32_t timer_peripheral, uint32_t flag) {
+  return (timer(timer_peripheral)->sr & flag) != 0;
+}
+
+void timer_clear_flag(uint32_t timer_peripheral, uint32_t flag) {
+  timer(timer_peripheral)->sr &= ~flag;
+}
+
+uint32_t mockTimerUpdateHz(uint32_t timer_peripheral) {
+  const MockTimer* t = timer(timer_peripheral);
+  return rcc_apb1_frequency / (t->prescaler + 1) / (t->period + 1);
+}
+
+const MockTimerStats* mockTimerStats(void) {
+  return &timerStats;
+}
+
+void nvic_enable_irq(uint8_t irqn) {
+  if (irqn < MOCK_NVIC_IRQS) nvicEnabled[irqn] = true;
+}
+
+void nvic_disable_irq(uint8_t irqn) {
+  if (irqn < MOCK_NVIC_IRQS) nvicEnabled[irqn] = false;
+}
+
+__attribute__((weak)) void tim2_isr(void) {
+}
+
+/*
+  mockWaitForInterrupt
+
+  What `wfi` would wait for: TIM2's next update event, delivered to tim2_isr() when the update
+  interrupt and the NVIC line are enabled. With nothing to wake it the core would sleep forever,
+  so the mock stops the test instead.
+*/
+void mockWaitForInterrupt(void) {
+  MockTimer* t = timer(TIM2);
+  if (!t->counting || !(t->dier & TIM_DIER_UIE) || !nvicEnabled[NVIC_TIM2_IRQ]) {
+    fprintf(stderr, "libopencm3_mock: __WFI() with no interrupt enabled to wake it\n");
+    abort();
+  }
+  timerStats.updates++;
+  const uint32_t updateHz = mockTimerUpdateHz(TIM2);
+  if (updateHz > 0) dwtCycles += rcc_ahb_frequency / updateHz;
+  t->sr |= TIM_SR_UIF;
+  timerStats.interrupts++;
+  tim2_isr();
+}
@@ -0,0 +1,247 @@
+/*
+  libopencm3_mock.h
+
+  What this file does
+  -------------------
+  Host-side (Linux/macOS) stand-in for the parts of libopencm3 that hardware/panel_hw.c uses, so
+  the real STM32 driver can be compiled and unit-tested without a board. Build with
+  -Ihardware/mock so that panel_hw.c's "libopencm3/..." includes resolve to the headers in this
+  directory, and link libopencm3_mock.c.
+
+  The mock models registers, not electrons:
+
+  - RCC: which peripheral clocks were enabled, and rcc_ahb_frequency.
+  - GPIO: per-port mode and output registers. gpio_set()/gpio_clear() and stores to GPIO_BSRR()
+    update the output register in program order.
+  - ADC1: configuration (sample time, resolution, regular sequence, continuous/single mode, DMA
+    requests) and one value per channel set by the test. A single conversion completes as soon
+    as it is started; the time the driver would have spun on adc_eoc() for it is accumulated in
+    MockAdcStats.busyWaitClocks (sample time + 12.5 ADC clocks per conversion).
+  - DMA1: the channel registers. mockAdcRunSequences() plays the continuous ADC scan: every
+    conversion lands in ADC_DR and, if DMA is enabled on both sides and the channel's peripheral
+    address is ADC_DR, is moved to memory with the channel's size, increment and circular
+    settings.
+  - DWT: a cycle counter at rcc_ahb_frequency that moves MOCK_DWT_CYCLES_PER_READ cycles per
+    read (so the driver's calibrated delay_us() spins for a deterministic number of reads), and
+    by one TIM2 period per mockWaitForInterrupt(). The test can also set it.
+  - The interrupt mask (cm_mask_interrupts()), recorded only.
+  - DMA1 channel 3 from memory to a GPIO port's BSRR, requested by TIM3's update event (the F3's
+    mapping): once the channel is enabled with TIM3 counting and its DMA request (UDE) enabled,
+    the whole count is stored to BSRR word by word, and the transfer-complete flag is set.
+  - TIM2 and the NVIC: prescaler, period, update interrupt enable and counter enable, and whether
+    the TIM2 line is enabled in the NVIC. Time does not pass on its own: __WFI() (the driver's
+    wait for an interrupt) runs mockWaitForInterrupt(), which counts one update event, advances
+    the cycle counter by one period and calls the driver's tim2_isr() if the interrupt would be
+    delivered.
+
+  Every GPIO register store is counted (gpio_set()/gpio_clear() are one BSRR store each), and the
+  output pins can be wired to a pin-level model of the LED panel (mockPanelAttach()). The model
+  sees each store as it is applied: a rising edge on the clock pin shifts the data pin (or the six
+  parallel data lines) into a 192-bit register, and a rising edge on the latch pin copies that
+  register into a decoded 32x32 framebuffer at the row-pair given by the A..D address pins. The
+  framebuffer is laid out like panel_native.c's and panel_emu.c's, so frames driven by the real
+  panel_hw.c can be compared with theirs pixel for pixel.
+
+  Everything except the panel wiring is reset by mockReset().
+*/
+
+#ifndef LIBOPENCM3_MOCK_H
+#define LIBOPENCM3_MOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "libopencm3/stm32/rcc.h"
+#include "libopencm3/stm32/gpio.h"
+#include "libopencm3/stm32/adc.h"
+#include "libopencm3/stm32/dma.h"
+#include "libopencm3/stm32/timer.h"
+#include "libopencm3/cm3/cortex.h"
+#include "libopencm3/cm3/dwt.h"
+#include "libopencm3/cm3/nvic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  MockAdcStats
+
+  What the ADC has done since mockReset():
+
+    - conversions:     conversions completed (single and scanned)
+    - eocPolls:        adc_eoc() calls
+    - blockingReads:   single conversions whose end the driver waited for with adc_eoc()
+    - busyWaitClocks:  ADC clocks spent in those waits
+    - dmaTransfers:    results moved to memory by the DMA
+*/
+typedef struct {
+  uint64_t conversions;
+  uint64_t eocPolls;
+  uint64_t blockingReads;
+  uint64_t busyWaitClocks;
+  uint64_t dmaTransfers;
+} MockAdcStats;
+
+/*
+  MockPanelWiring
+
+  Which pins drive the panel. Pins are GPIOn masks; the address, clock, latch and serial data pins
+  are on `port`.
+
+    - addressPins: A, B, C, D (A is the address LSB).
+    - rowOffset:   address of row-pair 0. The coursework driver selects row-pair i with address
+                   i + 1 (SelectRow(i + 1)), which the emulators mirror, so 1 gives frames
+                   comparable with theirs.
+    - parallel:    HUB75 wiring (PANEL_PARALLEL_SHIFT builds): R1,G1,B1,R2,G2,B2 on six
+                   consecutive pins of `dataPort` from `dataShift`, instead of `dataPin`.
+*/
+typedef struct {
+  uint32_t port;
+  uint16_t addressPins[4];
+  uint16_t clockPin;
+  uint16_t latchPin;
+  uint16_t dataPin;
+  int rowOffset;
+  bool parallel;
+  uint32_t dataPort;
+  int dataShift;
+} MockPanelWiring;
+
+/*
+  MockPanelStats
+
+  What the GPIO and the panel model have seen since mockReset():
+
+    - gpioWrites:   GPIO register stores on any port, attached panel or not
+    - dmaGpioWrites: of those, stores made by the DMA rather than the CPU
+    - clockEdges:   rising clock edges (each shifts one bit, or one six-bit column)
+    - latches:      rising latch edges
+    - scans:        complete frames (every row-pair latched at least once since the last one)
+
+  Register writes per frame are gpioWrites / scans over a run.
+*/
+typedef struct {
+  uint64_t gpioWrites;
+  uint64_t dmaGpioWrites;
+  uint64_t clockEdges;
+  uint64_t latches;
+  uint64_t scans;
+} MockPanelStats;
+
+/*
+  MockTimerStats
+
+  What TIM2 has done since mockReset():
+
+    - updates:      update events (one per mockWaitForInterrupt() with the counter running)
+    - interrupts:   of those, delivered to tim2_isr()
+*/
+typedef struct {
+  uint64_t updates;
+  uint64_t interrupts;
+} MockTimerStats;
+
+/*
+  mockReset
+
+  Return every mocked peripheral to its reset state, clear the panel model's register and
+  framebuffer and zero the statistics. The panel stays attached.
+*/
+void mockReset(void);
+
+/*
+  mockRccEnabled
+
+  True when rcc_periph_clock_enable() has been called for `clken`.
+*/
+bool mockRccEnabled(enum rcc_periph_clken clken);
+
+/*
+  mockGpioFlush / mockGpioOutput / mockGpioMode
+
+  Apply any pending GPIO_BSRR store, then read a port's output register or the mode of one pin.
+*/
+void mockGpioFlush(void);
+uint16_t mockGpioOutput(uint32_t gpioport);
+uint8_t mockGpioMode(uint32_t gpioport, int pin);
+
+/*
+  mockPanelAttach
+
+  Wire the panel model to the GPIO outputs (NULL detaches it). Its register and framebuffer start
+  cleared.
+*/
+void mockPanelAttach(const MockPanelWiring* wiring);
+
+/*
+  mockPanelPixel
+
+  Apply any pending GPIO_BSRR store, then return the latched colour of pixel (x, y) as a 3-bit
+  value (bit 0 = red, bit 1 = green, bit 2 = blue), as panelNativeGetPixel() does.
+*/
+uint8_t mockPanelPixel(int x, int y);
+
+const MockPanelStats* mockPanelStats(void);
+
+/*
+  mockAdcSetChannel
+
+  Set the value the ADC converts on `channel` (0..MOCK_ADC_CHANNELS-1).
+*/
+void mockAdcSetChannel(int channel, uint32_t value);
+
+/*
+  mockAdcRunSequences
+
+  Run `count` complete regular sequences of a started continuous-mode ADC (see the file comment).
+  Returns false, doing nothing, if the ADC is not powered, started and in continuous mode.
+*/
+bool mockAdcRunSequences(uint32_t adc, uint32_t count);
+
+/*
+  mockAdcConversionClocks
+
+  ADC clocks one conversion takes with the current sample time: sample time + 12.5, rounded up.
+*/
+uint32_t mockAdcConversionClocks(uint32_t adc);
+
+/*
+  mockAdcIsContinuous / mockAdcSequence
+
+  Inspect the configuration: continuous mode, and the regular sequence (returns its length and
+  copies up to `capacity` channels into `channels`).
+*/
+bool mockAdcIsContinuous(uint32_t adc);
+int mockAdcSequence(uint32_t adc, uint8_t* channels, int capacity);
+
+const MockAdcStats* mockAdcStats(void);
+
+/*
+  mockDmaRemaining
+
+  The channel's remaining transfer count (CNDTR), which a circular channel reloads at zero.
+*/
+uint16_t mockDmaRemaining(uint32_t dma, uint8_t channel);
+
+/*
+  mockDwtSetCycles
+
+  Set the cycle count; the next dwt_read_cycle_counter() returns it.
+*/
+void mockDwtSetCycles(uint32_t cycles);
+
+/*
+  mockTimerUpdateHz
+
+  The timer's update rate with the current prescaler and period, clocked at rcc_apb1_frequency.
+*/
+uint32_t mockTimerUpdateHz(uint32_t timer);
+
+const MockTimerStats* mockTimerStats(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // LIBOPENCM3_MOCK_H
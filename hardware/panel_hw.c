@@ -1,50 +1,236 @@
 #include "libopencm3/stm32/rcc.h"  //Needed to enable the clock
 #include "libopencm3/stm32/gpio.h" //Needed to define things on the GPIO
 #include "libopencm3/stm32/adc.h"  //Needed to convert analogue signals to digital
+#include "libopencm3/stm32/dma.h"  //Moves the joystick conversions to memory (and waveforms to GPIOC)
+#include "libopencm3/stm32/timer.h" //TIM2 scan timer, TIM3 paces the waveform DMA
+#include "libopencm3/cm3/dwt.h"    //Cycle counter for getTimestamp(), now_us() and delay_us()
+#include "libopencm3/cm3/cortex.h" //Interrupt mask around now_us()'s update
+#include "libopencm3/cm3/nvic.h"   //TIM2 interrupt
+#include "hal_stats.h"             //HAL call counters
+#include "panel_hw_inline.h"       //Pin map and the PANEL_HW_INLINE register-store primitives
+#ifdef PANEL_HW_DMA_SHIFT
+#include "panel_waveform.h"        //BSRR waveforms played by DMA
+#endif
+#include <stdbool.h>
 #include <unistd.h>
 
-#define LEDPANEL_PORT GPIOC
+#ifdef PANEL_HW_DMA_SHIFT
+#if defined(PANEL_PARALLEL_SHIFT) || defined(PANEL_HW_INLINE)
+#error "PANEL_HW_DMA_SHIFT drives the serial wiring through its own out-of-line primitives"
+#endif
+#endif
 
-#define A_PIN GPIO2
-#define B_PIN GPIO3
-#define C_PIN GPIO4
-#define D_PIN GPIO5
-#define INP_PIN GPIO6
-#define CLK_PIN GPIO7
-#define LAT_PIN GPIO8
 #define IOPORT GPIOA
 #define JOYSTICK_A_PORT GPIOA
 #define JOYSTICK_B_PORT GPIOC
 #define ADC_REG ADC1
 
+// Joystick channels (left up/down, right up/down). Unless PANEL_HW_ADC_POLLED is defined, ADC1
+// scans them continuously and DMA1 channel 1 (ADC1's request line) copies each result into
+// adcSamples in circular mode, so getRawInput() is a load from memory with no conversion to wait
+// for. PANEL_HW_ADC_POLLED keeps the original one-conversion-per-call driver.
+#ifndef PANEL_HW_ADC_POLLED
+#define JOYSTICK_CHANNELS 4
+#define ADC_DMA DMA1
+#define ADC_DMA_CHANNEL DMA_CHANNEL1
+static uint8_t joystickChannels[JOYSTICK_CHANNELS] = {1, 2, 6, 7};
+static volatile uint16_t adcSamples[JOYSTICK_CHANNELS];
+#endif
+
 uint32_t getRawInput(int channelValue);
-void delay_ms(uint32_t ms); // assume 1Mhz clock
+void delay_ms(uint32_t ms);
+void delay_us(uint32_t us);
+uint32_t now_us(void);
+uint32_t getTimestamp(void);
+uint32_t getTimestampFrequency(void);
+void startScanTimer(void (*handler)(void), uint32_t frequencyHz);
+void waitForInterrupt(void);
 void PrepareLatch(void);
 void LatchRegister(void);
 void SelectRow(int row);
 void PushBit(int onoff);
+void PushRow(const uint32_t payload[6]);
+#ifdef PANEL_PARALLEL_SHIFT
+void PushColumn(uint8_t rgb6);
+#endif
 void ClearRow(int row);
+void SetOutputEnable(bool enabled);
 void setupPanel(void);
 void setupInput(void);
+
+// HAL call counters (see hal_stats.h): a plain global so a debugger can read them while the game
+// runs, e.g. `print halStats` or `print halStats.wastedBits` in gdb
+HalStats halStats;
+
+#ifdef PANEL_HW_SHIFT_TIMING
+// DWT cycles taken to shift 192 bits (one row-pair), measured once by setupPanel() for the
+// out-of-line primitives below and for the inline ones in panel_hw_inline.h (PANEL_HW_INLINE
+// builds). Divide by 192 for clocks per shifted bit; read with `print shiftTiming` in gdb.
+typedef struct
+{
+  uint32_t pushBitCycles;       // 192 PushBit() calls
+  uint32_t pushBitInlineCycles; // 192 panelHwPushBit()
+  uint32_t pushRowCycles;       // one PushRow() call
+  uint32_t pushRowInlineCycles; // one panelHwPushRow()
+} ShiftTiming;
+
+ShiftTiming shiftTiming;
+
+static void measureShiftTiming(void);
+#endif
+
+#ifndef PANEL_HW_DMA_SHIFT
+static void driveRowAddress(int row);
+static void shiftPayload(const uint32_t payload[6]);
+#endif
+
+// Called from tim2_isr() once startScanTimer() has run
+static void (*volatile scanTimerHandler)(void);
+
+#ifndef __WFI
+#define __WFI() __asm__ volatile("wfi")
+#endif
+
+#ifdef PANEL_HW_DMA_SHIFT
+// The panel primitives append their BSRR stores to `waveform` (panel_waveform.h) instead of
+// writing GPIOC. playWaveform() hands the recorded words to DMA1 channel 3, which TIM3's update
+// event (its DMA request line on the F3) paces at PANEL_HW_DMA_WORD_HZ stores per second into
+// GPIOC's BSRR, and starts recording into the other buffer. The words are played before every
+// dwell (delay_us) and at the end of every scan timer interrupt, so a slot is on the pins before
+// its dwell starts while the CPU goes back to the game.
+#ifndef PANEL_HW_DMA_WORD_HZ
+#define PANEL_HW_DMA_WORD_HZ 4000000u // the panel clock toggles at half this rate
+#endif
+// The longest slot is a ClearRow followed by a full slot (PrepareLatch, PushRow, blank, SelectRow,
+// LatchRegister, unblank): 774 words, 772 without the blanking. Each buffer holds one, so a slot
+// is played in a single transfer.
+#define PANEL_HW_DMA_SLOT_WORDS_MAX (1 + PANEL_WAVEFORM_ROW_WORDS + PANEL_WAVEFORM_SLOT_WORDS)
+#ifndef PANEL_HW_DMA_WORDS
+#define PANEL_HW_DMA_WORDS 1024 // per buffer
+#endif
+_Static_assert(PANEL_HW_DMA_WORDS >= PANEL_HW_DMA_SLOT_WORDS_MAX,
+               "a ClearRow slot must fit in one waveform buffer");
+#define WAVEFORM_DMA DMA1
+#define WAVEFORM_DMA_CHANNEL DMA_CHANNEL3
+#define WAVEFORM_TIMER TIM3
+
+static uint32_t waveformWords[2][PANEL_HW_DMA_WORDS];
+static int waveformBuffer = 0;
+static bool waveformPlaying = false;
+static PanelWaveform waveform = {waveformWords[0], 0, PANEL_HW_DMA_WORDS};
+
+static void setupWaveformDma(void);
+static void playWaveform(void);
+static PanelWaveform *reserveWaveform(uint32_t words);
+#endif
  
 
-void delay_ms(uint32_t ms) // assume 1Mhz clock
+// now_us() extends the DWT cycle counter (which wraps every 2^32 cycles, about 60 s at 72 MHz)
+// into a microsecond clock: nowUs is the time at cycle count nowUsCycles, and both only move in
+// whole microseconds, so no fraction is lost between reads. It must be read at least once per
+// wrap, which the game's scan does many times over.
+static uint32_t nowUs;
+static uint32_t nowUsCycles;
+
+void delay_ms(uint32_t ms)
+{
+  delay_us(ms * 1000u);
+}
+
+// Busy-waits on now_us(), so the time holds at any CPU clock; needs the cycle counter, which
+// setupPanel() enables
+void delay_us(uint32_t us)
+{
+  halStatsDelay(&halStats, us);
+#ifdef PANEL_HW_DMA_SHIFT
+  playWaveform();
+#endif
+  uint32_t start = now_us();
+  while (now_us() - start < us)
+    ;
+}
+
+// Microseconds from the DWT cycle count at rcc_ahb_frequency (a whole number of MHz). Interrupts
+// are masked while nowUs is updated, as the scan timer interrupt reads the clock too.
+uint32_t now_us(void)
+{
+  uint32_t cyclesPerUs = (rcc_ahb_frequency >= 1000000u) ? rcc_ahb_frequency / 1000000u : 1u;
+  uint32_t masked = cm_mask_interrupts(1);
+  uint32_t elapsedUs = (dwt_read_cycle_counter() - nowUsCycles) / cyclesPerUs;
+  nowUsCycles += elapsedUs * cyclesPerUs;
+  nowUs += elapsedUs;
+  uint32_t now = nowUs;
+  cm_mask_interrupts(masked);
+  return now;
+}
+
+// DWT cycle counter, enabled in setupPanel(); counts CPU (AHB) clock cycles
+uint32_t getTimestamp(void)
+{
+  return dwt_read_cycle_counter();
+}
+
+uint32_t getTimestampFrequency(void)
+{
+  return rcc_ahb_frequency;
+}
+
+// TIM2 update interrupt at frequencyHz. The timer counts at 1 MHz from the APB1 clock, which at
+// reset is the 8 MHz HSI with the APB1 prescaler at 1 (so TIM2's clock is not doubled).
+void startScanTimer(void (*handler)(void), uint32_t frequencyHz)
+{
+  uint32_t period = (frequencyHz > 0) ? 1000000u / frequencyHz : 1;
+  if (period < 1)
+    period = 1;
+
+  scanTimerHandler = handler;
+  rcc_periph_clock_enable(RCC_TIM2);
+  timer_set_prescaler(TIM2, rcc_apb1_frequency / 1000000u - 1);
+  timer_set_period(TIM2, period - 1);
+  timer_clear_flag(TIM2, TIM_SR_UIF);
+  timer_enable_irq(TIM2, TIM_DIER_UIE);
+  nvic_enable_irq(NVIC_TIM2_IRQ);
+  timer_enable_counter(TIM2);
+}
+
+void tim2_isr(void)
+{
+  timer_clear_flag(TIM2, TIM_SR_UIF);
+  if (scanTimerHandler)
+    scanTimerHandler();
+#ifdef PANEL_HW_DMA_SHIFT
+  playWaveform();
+#endif
+}
+
+// Sleep until the next interrupt (the scan timer's, or any other)
+void waitForInterrupt(void)
 {
-  for (volatile unsigned int tmr = ms; tmr > 0; tmr--)
-    __asm__("nop");
+  __WFI();
 }
+
+#ifndef PANEL_HW_DMA_SHIFT
+
 void PrepareLatch(void)
 {
+  halStatsPrepareLatch(&halStats);
   gpio_clear(LEDPANEL_PORT, LAT_PIN);
 }
 
 void LatchRegister(void)
 {
+  halStatsLatch(&halStats);
   // set the latch pin, which will display what is in the register
   gpio_set(LEDPANEL_PORT, LAT_PIN);
 }
 
 void SelectRow(int row)
+{
+  halStatsSelectRow(&halStats, row);
+  driveRowAddress(row);
+}
+
+static void driveRowAddress(int row)
 {
   if (row % 2 == 1)
   {
@@ -83,9 +269,52 @@ void SelectRow(int row)
   }
 }
 
+#ifdef PANEL_PARALLEL_SHIFT
+
+static void clockColumn(uint8_t rgb6)
+{
+  // clock low, then all six data lines in one BSRR write (set the 1s, reset the 0s), then clock
+  // high to shift the column into the six chains
+  uint32_t bits = ((uint32_t)rgb6 << DATA_PIN_SHIFT) & DATA_PINS;
+  GPIO_BSRR(LEDPANEL_PORT) = (uint32_t)CLK_PIN << 16;
+  GPIO_BSRR(DATA_PORT) = ((DATA_PINS & ~bits) << 16) | bits;
+  GPIO_BSRR(LEDPANEL_PORT) = CLK_PIN;
+}
+
+void PushColumn(uint8_t rgb6)
+{
+  halStatsPushColumn(&halStats);
+  clockColumn(rgb6);
+}
+
+void PushBit(int onoff)
+{
+  // no single data line in this wiring: clock one column with onoff on every line
+  halStatsPushBit(&halStats);
+  clockColumn(onoff ? 0x3F : 0x00);
+}
+
+static void shiftPayload(const uint32_t payload[6])
+{
+  // 32 clocks instead of 192: column x carries bit x of each of the six plane words
+  for (int x = 0; x < 32; x++)
+  {
+    uint8_t rgb6 = (uint8_t)(((payload[0] >> x) & 1u) |
+                             (((payload[1] >> x) & 1u) << 1) |
+                             (((payload[2] >> x) & 1u) << 2) |
+                             (((payload[3] >> x) & 1u) << 3) |
+                             (((payload[4] >> x) & 1u) << 4) |
+                             (((payload[5] >> x) & 1u) << 5));
+    clockColumn(rgb6);
+  }
+}
+
+#else
+
 void PushBit(int onoff)
 {
   // clear the clock, push a 1 or 0, and set the clock to push it in
+  halStatsPushBit(&halStats);
   gpio_clear(LEDPANEL_PORT, CLK_PIN);
 
   if (onoff)
@@ -96,18 +325,155 @@ void PushBit(int onoff)
   gpio_set(LEDPANEL_PORT, CLK_PIN);
 }
 
-void ClearRow(int row)
+static void shiftPayload(const uint32_t payload[6])
 {
-  SelectRow(row);
-  // 192 bits: 2 panel halfs, 3 bits per pixel, 32 pixels per half
-  for (int b = 0; b < 192; b++)
+  // 192 bits: 6 words of 32, least significant bit first (see PANEL_ROW_WORDS in panel.h).
+  // Each bit is two BSRR writes instead of three gpio calls: clock low together with the data
+  // level, then clock high to shift it in.
+  for (int w = 0; w < 6; w++)
   {
-    PushBit(0);
+    uint32_t word = payload[w];
+    for (int b = 0; b < 32; b++)
+    {
+      if (word & 1u)
+        GPIO_BSRR(LEDPANEL_PORT) = ((uint32_t)CLK_PIN << 16) | INP_PIN;
+      else
+        GPIO_BSRR(LEDPANEL_PORT) = ((uint32_t)CLK_PIN << 16) | ((uint32_t)INP_PIN << 16);
+      GPIO_BSRR(LEDPANEL_PORT) = CLK_PIN;
+      word >>= 1;
+    }
   }
 }
 
+#endif // PANEL_PARALLEL_SHIFT
+
+void PushRow(const uint32_t payload[6])
+{
+  halStatsPushRow(&halStats);
+  shiftPayload(payload);
+}
+
+void ClearRow(int row)
+{
+  static const uint32_t zeroPayload[6] = {0};
+  // counted as one ClearRow call, not as a SelectRow and a PushRow
+  halStatsClearRow(&halStats, row);
+  driveRowAddress(row);
+  // 192 bits: 2 panel halfs, 3 bits per pixel, 32 pixels per half (32 clocks when parallel)
+  shiftPayload(zeroPayload);
+}
+
+void SetOutputEnable(bool enabled)
+{
+  halStatsOutputEnable(&halStats, enabled);
+  // OE is active low: drive it low to light the LEDs, high to blank them
+  if (enabled)
+    gpio_clear(LEDPANEL_PORT, OE_PIN);
+  else
+    gpio_set(LEDPANEL_PORT, OE_PIN);
+}
+
+#else // PANEL_HW_DMA_SHIFT
+
+void PrepareLatch(void)
+{
+  halStatsPrepareLatch(&halStats);
+  panelWaveformPrepareLatch(reserveWaveform(1));
+}
+
+void LatchRegister(void)
+{
+  halStatsLatch(&halStats);
+  panelWaveformLatch(reserveWaveform(1));
+}
+
+void SelectRow(int row)
+{
+  halStatsSelectRow(&halStats, row);
+  panelWaveformSelectRow(reserveWaveform(1), row);
+}
+
+void PushBit(int onoff)
+{
+  halStatsPushBit(&halStats);
+  panelWaveformPushBit(reserveWaveform(2), onoff);
+}
+
+void PushRow(const uint32_t payload[6])
+{
+  halStatsPushRow(&halStats);
+  panelWaveformPushRow(reserveWaveform(PANEL_WAVEFORM_ROW_WORDS), payload);
+}
+
+void ClearRow(int row)
+{
+  halStatsClearRow(&halStats, row);
+  panelWaveformClearRow(reserveWaveform(1 + PANEL_WAVEFORM_ROW_WORDS), row);
+}
+
+void SetOutputEnable(bool enabled)
+{
+  halStatsOutputEnable(&halStats, enabled);
+  panelWaveformOutputEnable(reserveWaveform(1), enabled);
+}
+
+// Room for `words` more words, playing what has been recorded first if the buffer is full
+static PanelWaveform *reserveWaveform(uint32_t words)
+{
+  if (waveform.length + words > waveform.capacity)
+    playWaveform();
+  return &waveform;
+}
+
+static void playWaveform(void)
+{
+  if (waveform.length == 0)
+    return;
+
+  // the previous buffer is normally long finished: a slot plays in about 100 us, a dwell is 1 ms
+  while (waveformPlaying && !dma_get_interrupt_flag(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, DMA_TCIF))
+    ;
+  dma_disable_channel(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL);
+  dma_clear_interrupt_flags(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, DMA_TCIF);
+  dma_set_memory_address(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, (uintptr_t)waveform.words);
+  dma_set_number_of_data(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, (uint16_t)waveform.length);
+  dma_enable_channel(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL);
+  waveformPlaying = true;
+
+  waveformBuffer ^= 1;
+  waveform.words = waveformWords[waveformBuffer];
+  waveform.length = 0;
+}
+
+static void setupWaveformDma(void)
+{
+  uint32_t period = rcc_apb1_frequency / PANEL_HW_DMA_WORD_HZ;
+  if (period < 1)
+    period = 1;
+
+  rcc_periph_clock_enable(RCC_DMA1);
+  dma_channel_reset(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL);
+  dma_set_peripheral_address(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, (uintptr_t)&GPIO_BSRR(LEDPANEL_PORT));
+  dma_set_read_from_memory(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL);
+  dma_enable_memory_increment_mode(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL);
+  dma_set_peripheral_size(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, DMA_CCR_PSIZE_32BIT);
+  dma_set_memory_size(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, DMA_CCR_MSIZE_32BIT);
+  dma_set_priority(WAVEFORM_DMA, WAVEFORM_DMA_CHANNEL, DMA_CCR_PL_VERY_HIGH);
+
+  // one DMA request per update event
+  rcc_periph_clock_enable(RCC_TIM3);
+  timer_set_prescaler(WAVEFORM_TIMER, 0);
+  timer_set_period(WAVEFORM_TIMER, period - 1);
+  timer_enable_irq(WAVEFORM_TIMER, TIM_DIER_UDE);
+  timer_enable_counter(WAVEFORM_TIMER);
+}
+
+#endif // PANEL_HW_DMA_SHIFT
+
 void setupPanel()
 {
+  halStatsReset(&halStats);
+
   rcc_periph_clock_enable(RCC_GPIOA); // Enable clock
   rcc_periph_clock_enable(RCC_GPIOC); // Enable clock
 
@@ -142,8 +508,72 @@ void setupPanel()
   // Latch Pin
   gpio_mode_setup(LEDPANEL_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, LAT_PIN);
   gpio_set_output_options(LEDPANEL_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, LAT_PIN);
+
+#ifdef PANEL_PARALLEL_SHIFT
+  // Parallel data pins R1,G1,B1,R2,G2,B2
+  rcc_periph_clock_enable(RCC_GPIOB);
+  gpio_mode_setup(DATA_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, DATA_PINS);
+  gpio_set_output_options(DATA_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, DATA_PINS);
+#endif
+
+  // Output Enable Pin (start with output enabled)
+  gpio_mode_setup(LEDPANEL_PORT, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, OE_PIN);
+  gpio_set_output_options(LEDPANEL_PORT, GPIO_OTYPE_PP, GPIO_OSPEED_100MHZ, OE_PIN);
+#ifdef PANEL_HW_DMA_SHIFT
+  setupWaveformDma();
+  SetOutputEnable(true);
+  playWaveform();
+#else
+  SetOutputEnable(true);
+#endif
+
+  // Cycle counter for getTimestamp() (the GAME_PROFILE frame profile), now_us() and delay_us()
+  dwt_enable_cycle_counter();
+  nowUsCycles = dwt_read_cycle_counter();
+
+#ifdef PANEL_HW_SHIFT_TIMING
+  measureShiftTiming();
+  halStatsReset(&halStats); // the measurement's shifts are not the game's
+#ifdef PANEL_HW_DMA_SHIFT
+  waveform.length = 0; // nor are the words it recorded
+#endif
+#endif
+}
+
+#ifdef PANEL_HW_SHIFT_TIMING
+
+static void measureShiftTiming(void)
+{
+  // Alternating bits, so the data line changes on every clock. The out-of-line functions are
+  // called through pointers, as game.c calls them from another file; the inline ones are
+  // expanded into the loop, as they are in game.c's scan loop.
+  static const uint32_t payload[6] = {0x55555555u, 0xAAAAAAAAu, 0x55555555u,
+                                      0xAAAAAAAAu, 0x55555555u, 0xAAAAAAAAu};
+  void (*volatile pushBit)(int) = PushBit;
+  void (*volatile pushRow)(const uint32_t *) = PushRow;
+  uint32_t start;
+
+  start = dwt_read_cycle_counter();
+  for (int i = 0; i < 192; i++)
+    pushBit(i & 1);
+  shiftTiming.pushBitCycles = dwt_read_cycle_counter() - start;
+
+  start = dwt_read_cycle_counter();
+  for (int i = 0; i < 192; i++)
+    panelHwPushBit(i & 1);
+  shiftTiming.pushBitInlineCycles = dwt_read_cycle_counter() - start;
+
+  start = dwt_read_cycle_counter();
+  pushRow(payload);
+  shiftTiming.pushRowCycles = dwt_read_cycle_counter() - start;
+
+  start = dwt_read_cycle_counter();
+  panelHwPushRow(payload);
+  shiftTiming.pushRowInlineCycles = dwt_read_cycle_counter() - start;
 }
 
+#endif // PANEL_HW_SHIFT_TIMING
+
 // Function to configure GPIO registers
 void setupInput()
 {
@@ -158,11 +588,54 @@ void setupInput()
   adc_set_sample_time_on_all_channels(ADC_REG, ADC_SMPR_SMP_61DOT5CYC); // Set up sample time
   adc_set_resolution(ADC_REG, ADC_CFGR1_RES_12_BIT);                    // Get a good resolution
 
+#ifndef PANEL_HW_ADC_POLLED
+  // Scan the four joystick channels over and over; each result raises a DMA request
+  adc_set_continuous_conversion_mode(ADC_REG);
+  adc_set_regular_sequence(ADC_REG, JOYSTICK_CHANNELS, joystickChannels);
+  adc_enable_dma_circular_mode(ADC_REG);
+  adc_enable_dma(ADC_REG);
+
+  // DMA1 channel 1: ADC1 data register -> adcSamples[0..3], 16 bits each, wrapping forever
+  rcc_periph_clock_enable(RCC_DMA1);
+  dma_channel_reset(ADC_DMA, ADC_DMA_CHANNEL);
+  dma_set_peripheral_address(ADC_DMA, ADC_DMA_CHANNEL, (uintptr_t)&ADC_DR(ADC_REG));
+  dma_set_memory_address(ADC_DMA, ADC_DMA_CHANNEL, (uintptr_t)adcSamples);
+  dma_set_number_of_data(ADC_DMA, ADC_DMA_CHANNEL, JOYSTICK_CHANNELS);
+  dma_set_read_from_peripheral(ADC_DMA, ADC_DMA_CHANNEL);
+  dma_enable_memory_increment_mode(ADC_DMA, ADC_DMA_CHANNEL);
+  dma_set_peripheral_size(ADC_DMA, ADC_DMA_CHANNEL, DMA_CCR_PSIZE_16BIT);
+  dma_set_memory_size(ADC_DMA, ADC_DMA_CHANNEL, DMA_CCR_MSIZE_16BIT);
+  dma_enable_circular_mode(ADC_DMA, ADC_DMA_CHANNEL);
+  dma_set_priority(ADC_DMA, ADC_DMA_CHANNEL, DMA_CCR_PL_HIGH);
+  dma_enable_channel(ADC_DMA, ADC_DMA_CHANNEL);
+#endif
+
   adc_power_on(ADC_REG); // Finished setup, turn on ADC register 1
+
+#ifndef PANEL_HW_ADC_POLLED
+  adc_start_conversion_regular(ADC_REG); // Runs from now on; never waited for
+#endif
 }
 
+#ifndef PANEL_HW_ADC_POLLED
+
+uint32_t getRawInput(int channelValue)
+{
+  // The latest scanned result for a joystick channel; other channels are not scanned and read 0
+  halStatsRawInput(&halStats);
+  for (int i = 0; i < JOYSTICK_CHANNELS; i++)
+  {
+    if (joystickChannels[i] == channelValue)
+      return adcSamples[i];
+  }
+  return 0;
+}
+
+#else
+
 uint32_t getRawInput(int channelValue)
 {                                                     // For setting up channels for each direction
+  halStatsRawInput(&halStats);
   uint8_t channelArray[1] = {channelValue};           // Define a channel that we want to look at
   adc_set_regular_sequence(ADC_REG, 1, channelArray); // Set up the channel
   adc_start_conversion_regular(ADC_REG);              // Start converting the analogue signal
@@ -172,4 +645,6 @@ uint32_t getRawInput(int channelValue)
 
   uint32_t value = adc_read_regular(ADC_REG); // Read the value from the register and channel
   return value;
-}
\ No newline at end of file
+}
+
+#endif // PANEL_HW_ADC_POLLED
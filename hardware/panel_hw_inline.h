@@ -0,0 +1,188 @@
+/*
+  panel_hw_inline.h
+
+  What this file does
+  -------------------
+  The STM32 panel wiring (pin map) and a header-only implementation of the panel.h shift
+  primitives that panel_hw.c's out-of-line functions can't match: every GPIO access is one store
+  to the port's BSRR register, with the set/reset word looked up or computed instead of branched
+  on.
+
+    - PushBit: two BSRR stores per bit (clock low together with the data level from
+      panelHwDataWords, then clock high) instead of a PushBit() call making three libopencm3
+      calls (gpio_clear CLK, gpio_set/gpio_clear INP, gpio_set CLK).
+    - SelectRow: one BSRR store of panelHwRowWords[row], which sets the address pins that are 1
+      and resets the ones that are 0, instead of four branches and four gpio calls.
+    - PrepareLatch, LatchRegister, SetOutputEnable: one BSRR store each.
+    - PushRow / ClearRow / PushColumn: the same stores in a loop (parallel builds write all six
+      data lines in the column's store, as panel_hw.c does).
+
+  panel_hw.c includes this header for the pin map. Defining PANEL_HW_INLINE (for every file of a
+  hardware build, e.g. `make CPPFLAGS=-DPANEL_HW_INLINE` in hardware/) makes panel.h include it
+  too and map the primitive names onto the panelHw*() functions below, so game.c compiles to
+  inline register stores without any change to its source. The HAL counters (hal_stats.h) are
+  recorded exactly as by the out-of-line functions.
+*/
+
+#ifndef PANEL_HW_INLINE_H
+#define PANEL_HW_INLINE_H
+
+#include "libopencm3/stm32/gpio.h"
+#include "hal_stats.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LEDPANEL_PORT GPIOC
+
+#define A_PIN GPIO2
+#define B_PIN GPIO3
+#define C_PIN GPIO4
+#define D_PIN GPIO5
+#define INP_PIN GPIO6
+#define CLK_PIN GPIO7
+#define LAT_PIN GPIO8
+#define OE_PIN GPIO9 // output enable, active low
+
+// HUB75 parallel data lines (PANEL_PARALLEL_SHIFT builds): R1,G1,B1,R2,G2,B2 on six consecutive
+// pins of one port, in PANEL_COLUMN_* bit order, so a column is written with one BSRR store.
+#define DATA_PORT GPIOB
+#define DATA_PIN_SHIFT 0
+#define DATA_PINS ((uint32_t)0x3F << DATA_PIN_SHIFT) // PB0..PB5
+
+// Defined in panel_hw.c.
+extern HalStats halStats;
+
+/*
+  PANEL_HW_SET / PANEL_HW_RESET
+
+  BSRR words: the low half sets pins, the high half resets them.
+*/
+#define PANEL_HW_SET(pins) ((uint32_t)(pins))
+#define PANEL_HW_RESET(pins) ((uint32_t)(pins) << 16)
+#define PANEL_HW_LEVEL(pins, on) ((on) ? PANEL_HW_SET(pins) : PANEL_HW_RESET(pins))
+
+/*
+  panelHwDataWords
+
+  Clock low with the data line low ([0]) or high ([1]): the first store of every serial bit.
+*/
+static const uint32_t panelHwDataWords[2] = {
+  PANEL_HW_RESET(CLK_PIN) | PANEL_HW_RESET(INP_PIN),
+  PANEL_HW_RESET(CLK_PIN) | PANEL_HW_SET(INP_PIN),
+};
+
+/*
+  panelHwRowWords
+
+  Row address r (0..15) on A..D, LSB on A: every address pin is either set or reset, so one store
+  replaces whatever address was driven before. SelectRow(row) uses entry row & 15, which is what
+  driving the four low bits of `row` one pin at a time gives.
+*/
+#define PANEL_HW_ROW_WORD(r) (PANEL_HW_LEVEL(A_PIN, (r) & 1) | PANEL_HW_LEVEL(B_PIN, (r) & 2) | \
+                              PANEL_HW_LEVEL(C_PIN, (r) & 4) | PANEL_HW_LEVEL(D_PIN, (r) & 8))
+
+static const uint32_t panelHwRowWords[16] = {
+  PANEL_HW_ROW_WORD(0),  PANEL_HW_ROW_WORD(1),  PANEL_HW_ROW_WORD(2),  PANEL_HW_ROW_WORD(3),
+  PANEL_HW_ROW_WORD(4),  PANEL_HW_ROW_WORD(5),  PANEL_HW_ROW_WORD(6),  PANEL_HW_ROW_WORD(7),
+  PANEL_HW_ROW_WORD(8),  PANEL_HW_ROW_WORD(9),  PANEL_HW_ROW_WORD(10), PANEL_HW_ROW_WORD(11),
+  PANEL_HW_ROW_WORD(12), PANEL_HW_ROW_WORD(13), PANEL_HW_ROW_WORD(14), PANEL_HW_ROW_WORD(15),
+};
+
+static inline void panelHwDriveRowAddress(int row) {
+  GPIO_BSRR(LEDPANEL_PORT) = panelHwRowWords[row & 0x0F];
+}
+
+#ifdef PANEL_PARALLEL_SHIFT
+
+/*
+  panelHwClockColumn
+
+  Clock low, all six data lines in one store (set the 1s, reset the 0s), clock high.
+*/
+static inline void panelHwClockColumn(uint8_t rgb6) {
+  const uint32_t bits = ((uint32_t)rgb6 << DATA_PIN_SHIFT) & DATA_PINS;
+  GPIO_BSRR(LEDPANEL_PORT) = PANEL_HW_RESET(CLK_PIN);
+  GPIO_BSRR(DATA_PORT) = PANEL_HW_RESET(DATA_PINS & ~bits) | bits;
+  GPIO_BSRR(LEDPANEL_PORT) = PANEL_HW_SET(CLK_PIN);
+}
+
+static inline void panelHwShiftPayload(const uint32_t payload[6]) {
+  // column x carries bit x of each of the six plane words
+  for (int x = 0; x < 32; x++) {
+    const uint8_t rgb6 = (uint8_t)(((payload[0] >> x) & 1u) |
+                                   (((payload[1] >> x) & 1u) << 1) |
+                                   (((payload[2] >> x) & 1u) << 2) |
+                                   (((payload[3] >> x) & 1u) << 3) |
+                                   (((payload[4] >> x) & 1u) << 4) |
+                                   (((payload[5] >> x) & 1u) << 5));
+    panelHwClockColumn(rgb6);
+  }
+}
+
+static inline void panelHwPushColumn(uint8_t rgb6) {
+  halStatsPushColumn(&halStats);
+  panelHwClockColumn(rgb6);
+}
+
+static inline void panelHwPushBit(int onoff) {
+  halStatsPushBit(&halStats);
+  panelHwClockColumn(onoff ? 0x3F : 0x00);
+}
+
+#else
+
+static inline void panelHwShiftPayload(const uint32_t payload[6]) {
+  // 192 bits, least significant bit of word 0 first
+  for (int w = 0; w < 6; w++) {
+    uint32_t word = payload[w];
+    for (int b = 0; b < 32; b++) {
+      GPIO_BSRR(LEDPANEL_PORT) = panelHwDataWords[word & 1u];
+      GPIO_BSRR(LEDPANEL_PORT) = PANEL_HW_SET(CLK_PIN);
+      word >>= 1;
+    }
+  }
+}
+
+static inline void panelHwPushBit(int onoff) {
+  halStatsPushBit(&halStats);
+  GPIO_BSRR(LEDPANEL_PORT) = panelHwDataWords[onoff != 0];
+  GPIO_BSRR(LEDPANEL_PORT) = PANEL_HW_SET(CLK_PIN);
+}
+
+#endif // PANEL_PARALLEL_SHIFT
+
+static inline void panelHwPrepareLatch(void) {
+  halStatsPrepareLatch(&halStats);
+  GPIO_BSRR(LEDPANEL_PORT) = PANEL_HW_RESET(LAT_PIN);
+}
+
+static inline void panelHwLatchRegister(void) {
+  halStatsLatch(&halStats);
+  GPIO_BSRR(LEDPANEL_PORT) = PANEL_HW_SET(LAT_PIN);
+}
+
+static inline void panelHwSelectRow(int row) {
+  halStatsSelectRow(&halStats, row);
+  panelHwDriveRowAddress(row);
+}
+
+static inline void panelHwPushRow(const uint32_t payload[6]) {
+  halStatsPushRow(&halStats);
+  panelHwShiftPayload(payload);
+}
+
+static inline void panelHwClearRow(int row) {
+  static const uint32_t zeroPayload[6] = {0};
+  // counted as one ClearRow call, not as a SelectRow and a PushRow
+  halStatsClearRow(&halStats, row);
+  panelHwDriveRowAddress(row);
+  panelHwShiftPayload(zeroPayload);
+}
+
+static inline void panelHwSetOutputEnable(bool enabled) {
+  halStatsOutputEnable(&halStats, enabled);
+  // OE is active low
+  GPIO_BSRR(LEDPANEL_PORT) = PANEL_HW_LEVEL(OE_PIN, !enabled);
+}
+
+#endif // PANEL_HW_INLINE_H
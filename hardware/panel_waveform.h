@@ -0,0 +1,113 @@
+/*
+  panel_waveform.h
+
+  What this file does
+  -------------------
+  Generates the panel's GPIO waveform as a buffer of BSRR words instead of driving the pins:
+  every word is one store to LEDPANEL_PORT's BSRR register (pin map in panel_hw_inline.h), and
+  playing the words in order, at any pace, drives the panel exactly as the store-per-call
+  primitives would.
+
+    - panelWaveformPushRow: 192 bits x 2 words (clock low with the data level, then clock high),
+      least significant bit of payload word 0 first, i.e. displayRow()'s PANEL_ROW_WORDS order.
+    - panelWaveformSelectRow / panelWaveformClearRow: one address word (both), then 384 words of
+      zeros (ClearRow).
+    - panelWaveformPrepareLatch / panelWaveformLatch / panelWaveformOutputEnable: one word each.
+    - panelWaveformBuildSlot: a whole row-pair slot, PANEL_WAVEFORM_SLOT_WORDS words.
+
+  panel_hw.c's PANEL_HW_DMA_SHIFT driver records the HAL calls with these functions and plays the
+  words to GPIOC's BSRR with timer-triggered DMA. Nothing here touches a register, so the same code
+  runs on the host, where the libopencm3 mock's panel model decodes the words
+  (native/tests/hw_waveform_test.c).
+
+  Serial wiring only: the parallel data lines are on another port (DATA_PORT), which one DMA
+  stream into one BSRR register cannot reach.
+*/
+
+#ifndef PANEL_WAVEFORM_H
+#define PANEL_WAVEFORM_H
+
+#include "panel_hw_inline.h" // pin map, PANEL_HW_SET/RESET, panelHwDataWords, panelHwRowWords
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PANEL_WAVEFORM_ROW_WORDS (2 * 192)
+
+// PrepareLatch, PushRow, blank, SelectRow, LatchRegister, unblank
+#define PANEL_WAVEFORM_SLOT_WORDS (PANEL_WAVEFORM_ROW_WORDS + 5)
+
+/*
+  PanelWaveform
+
+  `length` words of `words` (room for `capacity`) are filled. The append functions below do not
+  check the capacity; callers make room first.
+*/
+typedef struct {
+  uint32_t* words;
+  uint32_t length;
+  uint32_t capacity;
+} PanelWaveform;
+
+static inline void panelWaveformAppend(PanelWaveform* waveform, uint32_t word) {
+  waveform->words[waveform->length++] = word;
+}
+
+static inline void panelWaveformPrepareLatch(PanelWaveform* waveform) {
+  panelWaveformAppend(waveform, PANEL_HW_RESET(LAT_PIN));
+}
+
+static inline void panelWaveformLatch(PanelWaveform* waveform) {
+  panelWaveformAppend(waveform, PANEL_HW_SET(LAT_PIN));
+}
+
+static inline void panelWaveformSelectRow(PanelWaveform* waveform, int row) {
+  panelWaveformAppend(waveform, panelHwRowWords[row & 0x0F]);
+}
+
+// OE is active low
+static inline void panelWaveformOutputEnable(PanelWaveform* waveform, bool enabled) {
+  panelWaveformAppend(waveform, PANEL_HW_LEVEL(OE_PIN, !enabled));
+}
+
+static inline void panelWaveformPushBit(PanelWaveform* waveform, int onoff) {
+  uint32_t* out = waveform->words + waveform->length;
+  out[0] = panelHwDataWords[onoff != 0];
+  out[1] = PANEL_HW_SET(CLK_PIN);
+  waveform->length += 2;
+}
+
+static inline void panelWaveformPushRow(PanelWaveform* waveform, const uint32_t payload[6]) {
+  uint32_t* out = waveform->words + waveform->length;
+  for (int w = 0; w < 6; w++) {
+    uint32_t word = payload[w];
+    for (int b = 0; b < 32; b++) {
+      *out++ = panelHwDataWords[word & 1u];
+      *out++ = PANEL_HW_SET(CLK_PIN);
+      word >>= 1;
+    }
+  }
+  waveform->length += PANEL_WAVEFORM_ROW_WORDS;
+}
+
+static inline void panelWaveformClearRow(PanelWaveform* waveform, int row) {
+  static const uint32_t zeroPayload[6] = {0};
+  panelWaveformSelectRow(waveform, row);
+  panelWaveformPushRow(waveform, zeroPayload);
+}
+
+/*
+  panelWaveformBuildSlot
+
+  One row-pair slot with output-enable blanking (game.c's scanBlankOutputEnable order): shift the
+  payload, blank, drive address `row` (SelectRow()'s argument), latch, unblank.
+*/
+static inline void panelWaveformBuildSlot(PanelWaveform* waveform, int row, const uint32_t payload[6]) {
+  panelWaveformPrepareLatch(waveform);
+  panelWaveformPushRow(waveform, payload);
+  panelWaveformOutputEnable(waveform, false);
+  panelWaveformSelectRow(waveform, row);
+  panelWaveformLatch(waveform);
+  panelWaveformOutputEnable(waveform, true);
+}
+
+#endif // PANEL_WAVEFORM_H
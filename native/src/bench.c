@@ -0,0 +1,225 @@
+/*
+  bench.c
+
+  What this file does
+  -------------------
+  Throughput benchmark for the native build. It links the game code (src/game.c, built with
+  GAME_NO_MAIN so this file provides main()) against panel_native.c with delays disabled and
+  reports:
+
+    1) Scanout throughput: updateDisplay() called back-to-back on a representative frame
+       (borders, net and start text). This isolates updateDisplay -> scanPanel -> PushRow
+       (the frame is static, so the cached row-pair payloads are built once).
+       Reported as latches/sec, complete 16-row scans/sec and shifted bits/sec, plus latches
+       and bits per scan (which grow with the colour depth game.c was built with; see
+       `make bench-depth`), and shift clocks per scan (6x fewer with PANEL_PARALLEL_SHIFT; see
+       `make bench-parallel`).
+
+    2) Refresh rate: a few scans of the same frame with real delays, timed against the target
+       refresh rate the row dwell was built for (game_refresh_stats(); set it with
+       GAME_DEFINES=-DrefreshRateHz=N or -DrowDwellUs=N).
+
+    3) Game throughput: the full game loop (input, drawing, physics, scanout) driven by a simple
+       scripted player, driven through game_tick(), reported as game ticks/sec.
+
+  Usage:
+    pong_bench [scanout_scans] [game_ticks]
+
+  Output is one "key value" pair per line so it can be diffed or scraped by CI.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "panel.h"
+#include "panel_native.h"
+#include "game.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Joystick raw extremes expected by game.c (same calibration as emulator.js).
+#define JOYSTICK_RAW_TOP     555
+#define JOYSTICK_RAW_BOTTOM  105
+
+// Paddle travel used by game.c's convertInputToPaddlePosition (panelHeight - paddleHeight - borderWidth).
+#define PADDLE_MAX_Y 27
+
+#define DEFAULT_SCANOUT_SCANS 20000
+#define DEFAULT_GAME_TICKS    20000
+#define REFRESH_SCANS         16
+
+// -----------------------------------------------------------------------------
+// Game symbols (src/game.c)
+// -----------------------------------------------------------------------------
+
+extern int gameMode;
+extern int cycle;
+extern int32_t ballY; // Q16.16
+
+void initGameMatrix(void);
+void drawBorders(void);
+void drawNet(void);
+void displayStart(void);
+void updateDisplay(void);
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+/*
+  nowSeconds
+
+  Monotonic wall-clock time in seconds.
+*/
+static double nowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/*
+  paddleYToRaw
+
+  Inverse of game.c's convertInputToPaddlePosition: the raw reading that puts a paddle at y.
+*/
+static uint32_t paddleYToRaw(float y) {
+  if (y < 0.0f) y = 0.0f;
+  if (y > (float)PADDLE_MAX_Y) y = (float)PADDLE_MAX_Y;
+  float norm = y / (float)PADDLE_MAX_Y;
+  return (uint32_t)((float)JOYSTICK_RAW_TOP + norm * (float)(JOYSTICK_RAW_BOTTOM - JOYSTICK_RAW_TOP));
+}
+
+/*
+  scriptedPlayerInput
+
+  Input hook for the game benchmark. On the start and win screens both joysticks are held at full
+  deflection so the game moves on as soon as it allows. During play the left paddle tracks the
+  ball and the right paddle sweeps up and down, so rallies, misses, serves and wins all occur.
+*/
+static uint32_t scriptedPlayerInput(int channel) {
+  const bool isLeft = (channel == 1 || channel == 2);
+  if (!isLeft && channel != 6 && channel != 7) return 0;
+
+  if (gameMode == 0 || gameMode == 3) {
+    return JOYSTICK_RAW_TOP;
+  }
+
+  if (isLeft) {
+    return paddleYToRaw((float)ballY / 65536.0f - 2.0f);
+  }
+
+  int phase = cycle % (2 * PADDLE_MAX_Y);
+  int sweepY = (phase < PADDLE_MAX_Y) ? phase : (2 * PADDLE_MAX_Y - phase);
+  return paddleYToRaw((float)sweepY);
+}
+
+// -----------------------------------------------------------------------------
+// Benchmarks
+// -----------------------------------------------------------------------------
+
+/*
+  runScanoutBenchmark
+
+  Draw a representative frame, then time `scans` back-to-back updateDisplay() calls.
+*/
+static void runScanoutBenchmark(uint64_t scans) {
+  setupPanel();
+  setupInput();
+  panelNativeSetDelayEnabled(false);
+
+  initGameMatrix();
+  drawBorders();
+  drawNet();
+  displayStart();
+
+  panelNativeResetCounters();
+  double start = nowSeconds();
+  for (uint64_t i = 0; i < scans; i++) {
+    updateDisplay();
+  }
+  double elapsed = nowSeconds() - start;
+
+  const PanelNativeCounters* c = panelNativeCounters();
+  printf("scanout.scans %llu\n", (unsigned long long)c->scans);
+  printf("scanout.seconds %.6f\n", elapsed);
+  printf("scanout.latches_per_sec %.0f\n", (double)c->latches / elapsed);
+  printf("scanout.scans_per_sec %.1f\n", (double)c->scans / elapsed);
+  printf("scanout.bits_per_sec %.0f\n", (double)c->bitsShifted / elapsed);
+  printf("scanout.ns_per_scan %.1f\n", elapsed * 1e9 / (double)c->scans);
+  printf("scanout.latches_per_scan %.0f\n", (double)c->latches / (double)c->scans);
+  printf("scanout.bits_per_scan %.0f\n", (double)c->bitsShifted / (double)c->scans);
+  printf("scanout.clocks_per_scan %.0f\n", (double)c->shiftClocks / (double)c->scans);
+  printf("scanout.wasted_bits_per_scan %.0f\n", (double)c->wastedBits / (double)c->scans);
+  printf("scanout.dwell_us_per_scan %.0f\n", (double)c->delayUs / (double)c->scans);
+  printf("scanout.dwell_us_per_row %.1f\n", (double)c->dwellUs / (double)c->rowVisits);
+}
+
+/*
+  runRefreshBenchmark
+
+  Time `scans` back-to-back updateDisplay() calls of the scanout benchmark's frame, sleeping for
+  the row dwells, and compare the refresh rate with the target.
+*/
+static void runRefreshBenchmark(uint64_t scans) {
+  panelNativeSetDelayEnabled(true);
+  updateDisplay(); // the first scan has no previous one to be timed against
+
+  double start = nowSeconds();
+  for (uint64_t i = 0; i < scans; i++) {
+    updateDisplay();
+  }
+  double elapsed = nowSeconds() - start;
+  panelNativeSetDelayEnabled(false);
+
+  GameRefreshStats refresh;
+  game_refresh_stats(&refresh);
+  printf("refresh.row_dwell_us %u\n", (unsigned)refresh.bitDwellUs);
+  printf("refresh.target_hz %.2f\n", 1e6 / (double)refresh.targetPeriodUs);
+  printf("refresh.measured_hz %.2f\n", (double)scans / elapsed);
+  printf("refresh.measured_period_us %u\n", (unsigned)refresh.measuredPeriodUs);
+}
+
+/*
+  runGameBenchmark
+
+  Run `ticks` iterations of the game loop with the scripted player.
+*/
+static void runGameBenchmark(uint64_t ticks) {
+  panelNativeSetInputHook(scriptedPlayerInput);
+  game_setup();
+  panelNativeSetDelayEnabled(false);
+
+  double start = nowSeconds();
+  for (uint64_t i = 0; i < ticks; i++) {
+    game_tick();
+  }
+  double elapsed = nowSeconds() - start;
+
+  const PanelNativeCounters* c = panelNativeCounters();
+  printf("game.ticks %d\n", cycle);
+  printf("game.seconds %.6f\n", elapsed);
+  printf("game.ticks_per_sec %.1f\n", (double)cycle / elapsed);
+  printf("game.latches_per_sec %.0f\n", (double)c->latches / elapsed);
+  printf("game.adc_reads_per_tick %.2f\n", (double)c->rawInputCalls / (double)cycle);
+  printf("game.mode_at_exit %d\n", gameMode);
+
+  panelNativeSetInputHook(NULL);
+}
+
+int main(int argc, char** argv) {
+  uint64_t scanoutScans = (argc > 1) ? strtoull(argv[1], NULL, 10) : DEFAULT_SCANOUT_SCANS;
+  uint64_t gameTicks = (argc > 2) ? strtoull(argv[2], NULL, 10) : DEFAULT_GAME_TICKS;
+
+  if (scanoutScans == 0 || gameTicks == 0) {
+    fprintf(stderr, "usage: %s [scanout_scans] [game_ticks]\n", argv[0]);
+    return 2;
+  }
+
+  runScanoutBenchmark(scanoutScans);
+  runRefreshBenchmark(REFRESH_SCANS);
+  runGameBenchmark(gameTicks);
+  return 0;
+}
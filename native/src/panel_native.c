@@ -0,0 +1,622 @@
+/*
+  panel_native.c
+
+  What this file does
+  -------------------
+  This file is the native (Linux/macOS host) implementation of the LED panel + joystick HAL
+  declared in panel.h. It lets src/game.c run unchanged on a development machine or in CI, with no
+  STM32 board and no browser.
+
+  Like panel_emu.c, it models the panel at the protocol level rather than exposing a framebuffer
+  API:
+
+  1) PushBit()/PushRow() clock bits into an emulated 192-bit shift register (the last 192 bits
+     win), or, in PANEL_PARALLEL_SHIFT builds, PushColumn()/PushRow() clock six-bit columns into
+     six 32-bit data chains (see panel.h).
+  2) SelectRow() records the multiplexed row address (using the game's 1-based convention).
+  3) LatchRegister() decodes the register into a latched 32x32 framebuffer for the selected
+     row-pair.
+  4) Every primitive is counted in the shared HAL counter layer (hal_stats.h): calls, bits
+     shifted and wasted, latches, complete scans and dwell time.
+
+  Differences from the browser emulator:
+  - There is no renderer; the latched framebuffer can be read back via panelNativeGetPixel().
+  - delay_ms()/delay_us() sleep with nanosleep(), or return immediately when delays are disabled
+    so the scanout hot path can be benchmarked at full speed. now_us() reads CLOCK_MONOTONIC; with
+    delays disabled it is a virtual clock that delay_us() advances, as in the emulator, so the
+    game's slot schedule stays deterministic and costs no clock reads.
+  - Joystick readings come from an optional callback (see panel_native.h); by default both
+    joysticks rest in their centre position.
+  - A scan limit can stop the game loop, which otherwise never returns.
+  - Every getRawInput() reading can be recorded (input_log.h) for replay with bin/pong_replay.
+  - getTimestamp() counts CLOCK_MONOTONIC nanoseconds. In GAME_PROFILE builds the game's per-phase
+    profile (game_profile_stats()) is printed to stderr when the process exits.
+  - The scan timer (startScanTimer(), GAME_SCANOUT_ISR builds) is a POSIX interval timer: its
+    SIGALRM handler runs the game's scan handler wherever the game happens to be, as an interrupt
+    would, so tearing between the game and the scan can be tested on the host.
+*/
+
+#define _XOPEN_SOURCE 600 // nanosleep, clock_gettime, sigaction, setitimer
+
+#include "panel.h"
+#include "panel_native.h"
+#include "game.h"
+#include "input_log.h"
+#include "hal_stats.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// Panel geometry and protocol constants (fixed by the coursework hardware)
+// -----------------------------------------------------------------------------
+
+#define PANEL_PIXEL_WIDTH   32
+#define PANEL_PIXEL_HEIGHT  32
+#define PANEL_ROW_PAIRS     16
+#define PANEL_SHIFT_BITS    192
+
+// Raw ADC value reported for a joystick at rest (midway between the game's calibration extremes
+// of 105 and 555).
+#define JOYSTICK_RAW_CENTRE 330
+
+// -----------------------------------------------------------------------------
+// Emulated panel internal state
+// -----------------------------------------------------------------------------
+
+/*
+  The 192-bit shift register is stored as three 64-bit words. Logical bit i (0 = oldest,
+  191 = most recently pushed) lives in shiftRegisterWords[i / 64], bit (i % 64). Pushing a bit
+  shifts the whole register one place towards index 0, dropping the oldest bit, which matches a
+  fixed-length register chain.
+
+  With the game's push order (top R, G, B planes, then bottom R, G, B planes, 32 bits each),
+  each 32-bit half-word therefore holds exactly one colour plane with pixel x in bit x.
+*/
+static uint64_t shiftRegisterWords[3];
+
+#ifdef PANEL_PARALLEL_SHIFT
+// HUB75 parallel data chains: chain c is fed by data line c (PANEL_COLUMN_* order), the newest
+// column entering at bit 31, so after 32 columns chain c holds payload word c.
+static uint32_t parallelChains[6];
+#endif
+
+// Latched framebuffer: one 32-bit mask per row and colour plane (bit x = pixel x).
+static uint32_t latchedPlanes[PANEL_PIXEL_HEIGHT][3];
+
+// Current multiplexed row address (0..15). This selects a row-pair: top=r, bottom=r+16.
+static int selectedRowPairIndex = 0;
+
+// Output-enable line (SetOutputEnable).
+static bool outputEnabled = true;
+
+// HAL call counters (hal_stats.h); panelNativeCounters() returns this struct.
+HalStats halStats;
+
+static bool delayEnabled = true;
+static uint32_t virtualNowUs = 0; // now_us() while delays are disabled
+static uint32_t (*inputHook)(int channel) = NULL;
+static uint64_t scanLimit = 0;
+static void (*scanLimitHandler)(void) = NULL;
+static void (*scanHook)(void) = NULL;
+
+// Scan timer (startScanTimer).
+static void (*volatile scanTimerHandler)(void) = NULL;
+static volatile sig_atomic_t waitingForInterrupt = 0;
+static volatile sig_atomic_t inScanTimerSignal = 0;
+static volatile sig_atomic_t scanLimitReached = 0;
+static PanelNativeTimerStats timerStats;
+
+// Input recording (panelNativeStartRecording).
+static InputLogWriter inputRecording;
+static char* inputRecordingPath = NULL;
+static bool stopRecordingAtExit = false;
+
+static bool printProfileAtExit = false;
+
+/*
+  readEnvironmentNumber
+
+  Parse a non-negative decimal environment variable, returning `fallback` when it is unset.
+*/
+static uint64_t readEnvironmentNumber(const char* name, uint64_t fallback) {
+  const char* text = getenv(name);
+  if (text == NULL || *text == '\0') return fallback;
+  return strtoull(text, NULL, 10);
+}
+
+/*
+  commitShiftRegisterToFramebufferForSelectedRow
+
+  Decode the 192-bit register into the latched framebuffer for the selected row-pair. Because each
+  colour plane occupies one 32-bit half of a register word, decoding is six word copies. In
+  parallel builds each data chain is already one plane.
+*/
+static void commitShiftRegisterToFramebufferForSelectedRow(void) {
+  const int topRowY = selectedRowPairIndex;
+  const int bottomRowY = selectedRowPairIndex + PANEL_ROW_PAIRS;
+
+#ifdef PANEL_PARALLEL_SHIFT
+  for (int plane = 0; plane < 3; plane++) {
+    latchedPlanes[topRowY][plane] = parallelChains[plane];
+    latchedPlanes[bottomRowY][plane] = parallelChains[plane + 3];
+  }
+#else
+  latchedPlanes[topRowY][0] = (uint32_t)shiftRegisterWords[0];
+  latchedPlanes[topRowY][1] = (uint32_t)(shiftRegisterWords[0] >> 32);
+  latchedPlanes[topRowY][2] = (uint32_t)shiftRegisterWords[1];
+  latchedPlanes[bottomRowY][0] = (uint32_t)(shiftRegisterWords[1] >> 32);
+  latchedPlanes[bottomRowY][1] = (uint32_t)shiftRegisterWords[2];
+  latchedPlanes[bottomRowY][2] = (uint32_t)(shiftRegisterWords[2] >> 32);
+#endif
+}
+
+/*
+  stopRecordingOnExit
+
+  atexit() handler: finish a recording that is still running when the process exits.
+*/
+static void stopRecordingOnExit(void) {
+  panelNativeStopRecording();
+}
+
+/*
+  printProfileOnExit
+
+  atexit() handler: print the game's per-phase profile, if the build has one (GAME_PROFILE).
+*/
+static void printProfileOnExit(void) {
+  GameProfileStats stats;
+  if (!game_profile_stats(GAME_PROFILE_TICK, &stats)) return;
+
+  fprintf(stderr, "profile: last %u ticks, ns per tick\n", (unsigned)stats.samples);
+  fprintf(stderr, "  %-8s %10s %10s %10s %10s\n", "phase", "min", "mean", "max", "p99");
+  for (int phase = 0; phase < GAME_PROFILE_PHASES; phase++) {
+    if (game_profile_stats(phase, &stats)) {
+      fprintf(stderr, "  %-8s %10u %10u %10u %10u\n", game_profile_phase_name(phase),
+              (unsigned)stats.minNs, (unsigned)stats.meanNs, (unsigned)stats.maxNs,
+              (unsigned)stats.p99Ns);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// panel_native.h controls
+// -----------------------------------------------------------------------------
+
+void panelNativeSetDelayEnabled(bool enabled) {
+  delayEnabled = enabled;
+}
+
+void panelNativeSetInputHook(uint32_t (*hook)(int channel)) {
+  inputHook = hook;
+}
+
+void panelNativeSetScanLimit(uint64_t scans, void (*onLimit)(void)) {
+  scanLimit = scans;
+  scanLimitHandler = onLimit;
+}
+
+void panelNativeSetScanHook(void (*hook)(void)) {
+  scanHook = hook;
+}
+
+const PanelNativeTimerStats* panelNativeTimerStats(void) {
+  return &timerStats;
+}
+
+void panelNativeResetCounters(void) {
+  halStatsReset(&halStats);
+  halStats.outputEnabled = outputEnabled;
+}
+
+const PanelNativeCounters* panelNativeCounters(void) {
+  return &halStats;
+}
+
+bool panelNativeStartRecording(const char* path) {
+  panelNativeStopRecording();
+
+  inputRecordingPath = malloc(strlen(path) + 1);
+  if (inputRecordingPath == NULL) return false;
+  strcpy(inputRecordingPath, path);
+  inputLogWriterInit(&inputRecording);
+
+  if (!stopRecordingAtExit) {
+    atexit(stopRecordingOnExit);
+    stopRecordingAtExit = true;
+  }
+  return true;
+}
+
+bool panelNativeStopRecording(void) {
+  if (inputRecordingPath == NULL) return true;
+
+  bool ok = inputLogWriteEnd(&inputRecording, game_cycle());
+  FILE* file = fopen(inputRecordingPath, "wb");
+  if (file == NULL) {
+    ok = false;
+  } else {
+    ok = (fwrite(inputRecording.bytes, 1, inputRecording.length, file) == inputRecording.length) && ok;
+    ok = (fclose(file) == 0) && ok;
+  }
+
+  inputLogWriterFree(&inputRecording);
+  free(inputRecordingPath);
+  inputRecordingPath = NULL;
+  return ok;
+}
+
+uint8_t panelNativeGetPixel(int x, int y) {
+  if (x < 0 || x >= PANEL_PIXEL_WIDTH || y < 0 || y >= PANEL_PIXEL_HEIGHT) return 0;
+  return (uint8_t)(((latchedPlanes[y][0] >> x) & 1u) |
+                   (((latchedPlanes[y][1] >> x) & 1u) << 1) |
+                   (((latchedPlanes[y][2] >> x) & 1u) << 2));
+}
+
+// -----------------------------------------------------------------------------
+// panel.h API implementations (native host)
+// -----------------------------------------------------------------------------
+
+/*
+  setupPanel
+
+  Clear the emulated shift register and framebuffer, reset the counters, and apply any
+  configuration supplied through the environment (PANEL_NATIVE_NO_DELAY, PANEL_NATIVE_SCANS,
+  PANEL_NATIVE_RECORD).
+*/
+void setupPanel(void) {
+  memset(shiftRegisterWords, 0, sizeof(shiftRegisterWords));
+#ifdef PANEL_PARALLEL_SHIFT
+  memset(parallelChains, 0, sizeof(parallelChains));
+#endif
+  memset(latchedPlanes, 0, sizeof(latchedPlanes));
+  selectedRowPairIndex = 0;
+  outputEnabled = true;
+  virtualNowUs = 0;
+  panelNativeResetCounters();
+
+  if (readEnvironmentNumber("PANEL_NATIVE_NO_DELAY", 0) != 0) {
+    delayEnabled = false;
+  }
+  if (scanLimit == 0) {
+    scanLimit = readEnvironmentNumber("PANEL_NATIVE_SCANS", 0);
+  }
+  if (!printProfileAtExit) {
+    atexit(printProfileOnExit);
+    printProfileAtExit = true;
+  }
+  const char* recordPath = getenv("PANEL_NATIVE_RECORD");
+  if (recordPath != NULL && *recordPath != '\0' && inputRecordingPath == NULL) {
+    panelNativeStartRecording(recordPath);
+  }
+}
+
+/*
+  setupInput
+
+  No hardware to initialise; readings come from the input hook (or the centre default).
+*/
+void setupInput(void) {
+}
+
+/*
+  stopAtScanLimit
+
+  Once LatchRegister() has reached the scan limit, stop the scan timer and call the limit handler,
+  then exit(0). Neither the handler nor exit()'s atexit handlers (the recording and the profile)
+  are async-signal-safe, so this only runs on the main thread: straight from LatchRegister() when
+  the game scans inline, and from the next getRawInput(), delay_us() or waitForInterrupt() when
+  LatchRegister() ran in the scan timer's signal handler.
+*/
+static void stopAtScanLimit(void) {
+  if (!scanLimitReached) return;
+  scanLimitReached = 0;
+
+  struct itimerval stopped;
+  memset(&stopped, 0, sizeof(stopped));
+  setitimer(ITIMER_REAL, &stopped, NULL);
+
+  if (scanLimitHandler != NULL) {
+    scanLimitHandler();
+  }
+  exit(0);
+}
+
+/*
+  getRawInput
+
+  Return a raw ADC-like reading for the requested channel, either from the installed input hook or
+  the resting centre value for the four joystick channels (1, 2, 6, 7). While recording, the
+  reading is logged with the current game cycle.
+*/
+uint32_t getRawInput(int channelValue) {
+  stopAtScanLimit();
+  halStatsRawInput(&halStats);
+  uint32_t value;
+  if (inputHook != NULL) {
+    value = inputHook(channelValue);
+  } else {
+    switch (channelValue) {
+      case 1: case 2: case 6: case 7:
+        value = JOYSTICK_RAW_CENTRE;
+        break;
+      default:
+        value = 0;
+        break;
+    }
+  }
+  if (inputRecordingPath != NULL) {
+    inputLogWrite(&inputRecording, game_cycle(), channelValue, value);
+  }
+  return value;
+}
+
+/*
+  delay_ms / delay_us
+
+  Sleep for the requested time, or return immediately when delays are disabled. The requested time
+  is accumulated in the counters either way.
+*/
+void delay_ms(uint32_t ms) {
+  delay_us(ms * 1000u);
+}
+
+void delay_us(uint32_t us) {
+  stopAtScanLimit();
+  halStatsDelay(&halStats, us);
+
+  if (!delayEnabled) {
+    virtualNowUs += us;
+    return;
+  }
+  if (us == 0) return;
+
+  struct timespec request;
+  request.tv_sec = (time_t)(us / 1000000u);
+  request.tv_nsec = (long)(us % 1000000u) * 1000L;
+  while (nanosleep(&request, &request) != 0) {
+    // Interrupted by a signal: sleep for the remainder.
+  }
+}
+
+/*
+  now_us
+
+  CLOCK_MONOTONIC in microseconds, truncated to 32 bits. Safe to call from the scan timer's
+  signal handler. While delays are disabled it is instead the virtual clock that delay_us()
+  advances, unless the scan timer runs: its interrupts come in real time.
+*/
+uint32_t now_us(void) {
+  if (!delayEnabled && scanTimerHandler == NULL) return virtualNowUs;
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000ull + (uint64_t)now.tv_nsec / 1000u);
+}
+
+/*
+  getTimestamp / getTimestampFrequency
+
+  CLOCK_MONOTONIC in nanoseconds, truncated to 32 bits (wraps every 4.3 s; intervals are taken as
+  unsigned differences).
+*/
+uint32_t getTimestamp(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec);
+}
+
+uint32_t getTimestampFrequency(void) {
+  return 1000000000u;
+}
+
+/*
+  onScanTimerSignal
+
+  SIGALRM from the scan timer: the simulated interrupt. Interrupts that arrive outside
+  waitForInterrupt() preempted the game.
+*/
+static void onScanTimerSignal(int signalNumber) {
+  (void)signalNumber;
+  timerStats.interrupts++;
+  if (!waitingForInterrupt) timerStats.preemptions++;
+  inScanTimerSignal = 1;
+  scanTimerHandler();
+  inScanTimerSignal = 0;
+}
+
+/*
+  startScanTimer
+
+  Run `handler` from SIGALRM every 1 / frequencyHz seconds (rounded down to whole microseconds;
+  the kernel may deliver short periods late).
+*/
+void startScanTimer(void (*handler)(void), uint32_t frequencyHz) {
+  scanTimerHandler = handler;
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = onScanTimerSignal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGALRM, &action, NULL);
+
+  long periodUs = (frequencyHz == 0) ? 1000000L : (long)(1000000u / frequencyHz);
+  if (periodUs < 1) periodUs = 1;
+  struct itimerval timer;
+  timer.it_interval.tv_sec = periodUs / 1000000L;
+  timer.it_interval.tv_usec = periodUs % 1000000L;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+/*
+  waitForInterrupt
+
+  pause() until a signal has been handled. A timer signal that arrives just before pause() is
+  handled but does not end the wait, which then lasts one more period; the caller re-checks its
+  condition either way.
+*/
+void waitForInterrupt(void) {
+  waitingForInterrupt = 1;
+  pause();
+  waitingForInterrupt = 0;
+  stopAtScanLimit();
+}
+
+/*
+  PrepareLatch
+
+  The latch line only matters at the moment it rises, so there is nothing to model here.
+*/
+void PrepareLatch(void) {
+  halStatsPrepareLatch(&halStats);
+}
+
+/*
+  LatchRegister
+
+  Commit the shift register to the selected row-pair, then count the latch. A scan completes when
+  all 16 row-pairs have been latched; back-to-back latches of one row-pair (BCM intensity bits)
+  count once. When a scan completes the scan hook runs, and if a scan limit has been reached, the
+  game stops (see stopAtScanLimit()).
+*/
+void LatchRegister(void) {
+  commitShiftRegisterToFramebufferForSelectedRow();
+
+  if (!halStatsLatch(&halStats)) return;
+  if (scanHook != NULL) {
+    scanHook();
+  }
+  if (scanLimit != 0 && halStats.scans >= scanLimit) {
+    scanLimitReached = 1;
+    if (!inScanTimerSignal) stopAtScanLimit();
+  }
+}
+
+/*
+  SelectRow
+
+  Record the multiplexed row address. The game passes a 1-based selector (SelectRow(i + 1) for
+  row-pair i), mirrored here as in panel_emu.c.
+*/
+void SelectRow(int row) {
+  halStatsSelectRow(&halStats, row);
+  selectedRowPairIndex = (row - 1) & 0x0F;
+}
+
+#ifdef PANEL_PARALLEL_SHIFT
+
+/*
+  clockColumn
+
+  Clock one column into the six data chains: bit c of `rgb6` enters bit 31 of chain c as every
+  chain moves one place towards bit 0.
+*/
+static void clockColumn(uint8_t rgb6) {
+  for (int c = 0; c < 6; c++) {
+    parallelChains[c] = (parallelChains[c] >> 1) | ((uint32_t)((rgb6 >> c) & 1u) << 31);
+  }
+}
+
+/*
+  PushColumn
+
+  Clock one column into the data chains (see panel.h).
+*/
+void PushColumn(uint8_t rgb6) {
+  halStatsPushColumn(&halStats);
+  clockColumn(rgb6);
+}
+
+/*
+  PushBit
+
+  No single data line in the parallel wiring: clock one column with `onoff` on all six lines.
+*/
+void PushBit(int onoff) {
+  halStatsPushBit(&halStats);
+  clockColumn(onoff ? 0x3Fu : 0x00u);
+}
+
+/*
+  loadPayload
+
+  Send a payload as 32 columns (column x = bit x of every word). After 32 columns chain c equals
+  payload word c, so the chains are loaded directly.
+*/
+static void loadPayload(const uint32_t payload[PANEL_ROW_WORDS]) {
+  memcpy(parallelChains, payload, sizeof(parallelChains));
+}
+
+#else
+
+/*
+  PushBit
+
+  Shift one bit into the packed register: every word moves one place towards the oldest end and
+  the new bit enters at logical index 191.
+*/
+void PushBit(int onoff) {
+  shiftRegisterWords[0] = (shiftRegisterWords[0] >> 1) | (shiftRegisterWords[1] << 63);
+  shiftRegisterWords[1] = (shiftRegisterWords[1] >> 1) | (shiftRegisterWords[2] << 63);
+  shiftRegisterWords[2] = (shiftRegisterWords[2] >> 1) | ((uint64_t)(onoff ? 1u : 0u) << 63);
+  halStatsPushBit(&halStats);
+}
+
+/*
+  loadPayload
+
+  Shift a full 192-bit payload. Since the payload exactly fills the register, every previous bit
+  is pushed out and the register becomes the payload: payload word w is logical bits
+  32*w .. 32*w+31, i.e. half of register word w / 2.
+*/
+static void loadPayload(const uint32_t payload[PANEL_ROW_WORDS]) {
+  shiftRegisterWords[0] = (uint64_t)payload[0] | ((uint64_t)payload[1] << 32);
+  shiftRegisterWords[1] = (uint64_t)payload[2] | ((uint64_t)payload[3] << 32);
+  shiftRegisterWords[2] = (uint64_t)payload[4] | ((uint64_t)payload[5] << 32);
+}
+
+#endif // PANEL_PARALLEL_SHIFT
+
+/*
+  PushRow
+
+  Shift one full row-pair payload (see loadPayload()).
+*/
+void PushRow(const uint32_t payload[PANEL_ROW_WORDS]) {
+  halStatsPushRow(&halStats);
+  loadPayload(payload);
+}
+
+/*
+  ClearRow
+
+  Select the row and shift a full payload of zeros, as the hardware driver does. The select and
+  the payload are counted as part of the ClearRow() call, not as SelectRow()/PushRow() calls.
+*/
+void ClearRow(int row) {
+  static const uint32_t zeroPayload[PANEL_ROW_WORDS] = {0};
+  halStatsClearRow(&halStats, row);
+  selectedRowPairIndex = (row - 1) & 0x0F;
+  loadPayload(zeroPayload);
+}
+
+/*
+  SetOutputEnable
+
+  Record the output-enable state and count the transitions. Blanking does not alter the latched
+  framebuffer, which is what panelNativeGetPixel() reports.
+*/
+void SetOutputEnable(bool enabled) {
+  halStatsOutputEnable(&halStats, enabled);
+  outputEnabled = enabled;
+}
@@ -0,0 +1,134 @@
+/*
+  panel_native.h
+
+  What this file does
+  -------------------
+  Declares the extra controls exposed by the native (Linux/macOS host) implementation of the
+  panel.h HAL in panel_native.c.
+
+  The game code never includes this header: it only talks to panel.h. Host-side drivers such as
+  the scanout benchmark use these functions to:
+    - run without delays (as fast as the CPU allows),
+    - supply synthetic joystick readings,
+    - stop the otherwise infinite game loop after a fixed number of panel scans, or watch every
+      scan as it completes,
+    - record the joystick readings for replay,
+    - and read back the emulated panel state and protocol counters.
+*/
+
+#ifndef PANEL_NATIVE_H
+#define PANEL_NATIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  PanelNativeCounters
+
+  The HAL call counters kept by panel_native.c: the shared HalStats layer (hal_stats.h), which
+  counts every panel.h primitive the game calls and the derived protocol totals (bits shifted,
+  shift clocks, wasted bits, latches, complete scans, delay and dwell time). All counters are
+  cumulative since the last setupPanel() or panelNativeResetCounters() call. The same struct is
+  also reachable as the global `halStats`.
+*/
+typedef HalStats PanelNativeCounters;
+
+/*
+  panelNativeSetDelayEnabled
+
+  Enable or disable real sleeping in delay_ms()/delay_us(). When disabled, they only record the
+  requested time and return immediately, and now_us() (outside GAME_SCANOUT_ISR builds) reads a
+  virtual clock that only those delays advance. The default is enabled, unless the environment variable
+  PANEL_NATIVE_NO_DELAY is set to a non-zero value when setupPanel() runs.
+*/
+void panelNativeSetDelayEnabled(bool enabled);
+
+/*
+  panelNativeSetInputHook
+
+  Install a callback that supplies raw ADC readings for getRawInput(channel). Passing NULL restores
+  the default, which reports every joystick as resting in its centre position.
+*/
+void panelNativeSetInputHook(uint32_t (*hook)(int channel));
+
+/*
+  panelNativeSetScanLimit
+
+  Stop the game after `scans` complete panel scans. When the limit is reached, `onLimit` is called
+  from inside LatchRegister(); it is expected not to return (e.g. exit() or longjmp()), and exit(0)
+  follows if it does. Passing NULL for `onLimit` selects exit(0) alone. A limit of 0 disables the
+  check.
+
+  In GAME_SCANOUT_ISR builds LatchRegister() runs in the scan timer's signal handler, so there it
+  only flags the limit; the scan timer is stopped and `onLimit` and exit(0) run on the main thread
+  at its next getRawInput(), delay_us() or waitForInterrupt().
+
+  The environment variable PANEL_NATIVE_SCANS sets an initial limit when setupPanel() runs.
+*/
+void panelNativeSetScanLimit(uint64_t scans, void (*onLimit)(void));
+
+/*
+  panelNativeSetScanHook
+
+  Call `hook` from LatchRegister() each time a scan completes (NULL removes it), e.g. to check
+  the latched frame with panelNativeGetPixel(). In GAME_SCANOUT_ISR builds it runs inside the scan
+  timer's signal handler.
+*/
+void panelNativeSetScanHook(void (*hook)(void));
+
+/*
+  PanelNativeTimerStats / panelNativeTimerStats
+
+  Scan timer interrupts (startScanTimer()) delivered so far, and how many of them preempted the
+  game rather than ending a waitForInterrupt().
+*/
+typedef struct {
+  uint64_t interrupts;
+  uint64_t preemptions;
+} PanelNativeTimerStats;
+
+const PanelNativeTimerStats* panelNativeTimerStats(void);
+
+/*
+  panelNativeResetCounters / panelNativeCounters
+
+  Reset or read the protocol counters described above.
+*/
+void panelNativeResetCounters(void);
+const PanelNativeCounters* panelNativeCounters(void);
+
+/*
+  panelNativeGetPixel
+
+  Return the latched colour of pixel (x, y) as a 3-bit value: bit 0 = red, bit 1 = green,
+  bit 2 = blue. This is what the physical panel would be showing for that pixel the last time
+  its row-pair was latched.
+*/
+uint8_t panelNativeGetPixel(int x, int y);
+
+/*
+  panelNativeStartRecording / panelNativeStopRecording
+
+  Record every getRawInput() reading as (cycle, channel, value) in the input_log.h format.
+  Recording should start before the first game_tick() for the log to be replayable
+  (bin/pong_replay). Stopping appends the end record at the current game cycle and writes the
+  stream to `path`; both return false on I/O errors. A recording still running at exit() is
+  stopped automatically.
+
+  The environment variable PANEL_NATIVE_RECORD starts a recording to that path when setupPanel()
+  runs.
+*/
+bool panelNativeStartRecording(const char* path);
+bool panelNativeStopRecording(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // PANEL_NATIVE_H
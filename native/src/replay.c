@@ -0,0 +1,287 @@
+/*
+  replay.c
+
+  What this file does
+  -------------------
+  Headless replayer for recorded input (input_log.h). It links the game code (src/game.c, built
+  with GAME_NO_MAIN) against panel_native.c with delays disabled, feeds the recorded
+  getRawInput() readings back through the native input hook and runs exactly as many ticks as the
+  recording covered, so a long match replays in a fraction of a second.
+
+  After every tick it hashes the game framebuffer (game_frame_hash()) and can write one
+  "tick hash" line per tick. Two hash files (e.g. from replays on different builds, or a live
+  run and a replay) can then be compared to find the first divergent tick.
+
+  If the game asks for a different channel, or at a different cycle, than the recording holds,
+  the replay has diverged from the recorded session; this is reported with the tick number.
+  Readings from the unfinished tick that the recording ended in are ignored.
+
+  Usage:
+    pong_replay <recording.pil> [hashes.txt]   replay, optionally writing per-tick hashes
+    pong_replay --compare <a.txt> <b.txt>       report the first tick at which two hash files differ
+
+  Output is one "key value" pair per line, like pong_bench. The exit status is 0 on success, 1 on
+  a divergence and 2 on usage or I/O errors.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "panel.h"
+#include "panel_native.h"
+#include "game.h"
+#include "input_log.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// -----------------------------------------------------------------------------
+// Recording
+// -----------------------------------------------------------------------------
+
+static InputLogRecord* records = NULL;
+static size_t recordCount = 0;
+static size_t nextRecord = 0;
+static int32_t recordedTicks = 0;
+
+// First input mismatch seen by the replay hook (-1 = none).
+static long inputDivergenceTick = -1;
+static char inputDivergence[160];
+
+/*
+  nowSeconds
+
+  Monotonic wall-clock time in seconds.
+*/
+static double nowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/*
+  readWholeFile
+
+  Read a file into a malloc'd buffer. Returns NULL on error.
+*/
+static uint8_t* readWholeFile(const char* path, size_t* length) {
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) return NULL;
+
+  size_t capacity = 4096;
+  size_t used = 0;
+  uint8_t* bytes = malloc(capacity);
+  while (bytes != NULL) {
+    used += fread(bytes + used, 1, capacity - used, file);
+    if (used < capacity) break;
+    capacity *= 2;
+    uint8_t* grown = realloc(bytes, capacity);
+    if (grown == NULL) {
+      free(bytes);
+      bytes = NULL;
+      break;
+    }
+    bytes = grown;
+  }
+  if (bytes != NULL && ferror(file)) {
+    free(bytes);
+    bytes = NULL;
+  }
+  fclose(file);
+  *length = used;
+  return bytes;
+}
+
+/*
+  loadRecording
+
+  Decode a whole recording into `records` and `recordedTicks`. Returns false on a bad stream.
+*/
+static bool loadRecording(const char* path) {
+  size_t length = 0;
+  uint8_t* bytes = readWholeFile(path, &length);
+  if (bytes == NULL) {
+    fprintf(stderr, "replay: cannot read %s\n", path);
+    return false;
+  }
+
+  InputLogReader reader;
+  if (!inputLogReaderInit(&reader, bytes, length)) {
+    fprintf(stderr, "replay: %s is not an input recording\n", path);
+    free(bytes);
+    return false;
+  }
+
+  size_t capacity = 0;
+  InputLogRecord record;
+  int status;
+  while ((status = inputLogRead(&reader, &record)) == 1) {
+    if (recordCount == capacity) {
+      capacity = (capacity != 0) ? capacity * 2 : 1024;
+      InputLogRecord* grown = realloc(records, capacity * sizeof(*records));
+      if (grown == NULL) {
+        status = -1;
+        break;
+      }
+      records = grown;
+    }
+    records[recordCount++] = record;
+  }
+  free(bytes);
+
+  if (status < 0) {
+    fprintf(stderr, "replay: %s is corrupt\n", path);
+    return false;
+  }
+  recordedTicks = reader.endCycle;
+  return true;
+}
+
+/*
+  replayInput
+
+  Input hook: return the next recorded reading, checking that the game asks for it on the same
+  cycle and channel as in the recorded session.
+*/
+static uint32_t replayInput(int channel) {
+  const int cycle = game_cycle();
+
+  if (nextRecord < recordCount && records[nextRecord].cycle == cycle &&
+      records[nextRecord].channel == channel) {
+    return records[nextRecord++].value;
+  }
+
+  if (inputDivergenceTick < 0) {
+    inputDivergenceTick = cycle;
+    if (nextRecord < recordCount) {
+      snprintf(inputDivergence, sizeof(inputDivergence),
+               "game read channel %d at tick %d, recording has channel %d at tick %ld",
+               channel, cycle, records[nextRecord].channel, (long)records[nextRecord].cycle);
+    } else {
+      snprintf(inputDivergence, sizeof(inputDivergence),
+               "game read channel %d at tick %d after the last recorded reading", channel, cycle);
+    }
+  }
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Modes
+// -----------------------------------------------------------------------------
+
+/*
+  runReplay
+
+  Replay `recordingPath`, writing per-tick hashes to `hashesPath` when it is not NULL.
+*/
+static int runReplay(const char* recordingPath, const char* hashesPath) {
+  if (!loadRecording(recordingPath)) return 2;
+
+  FILE* hashes = NULL;
+  if (hashesPath != NULL) {
+    hashes = fopen(hashesPath, "w");
+    if (hashes == NULL) {
+      fprintf(stderr, "replay: cannot write %s\n", hashesPath);
+      return 2;
+    }
+  }
+
+  panelNativeSetInputHook(replayInput);
+  game_setup();
+  panelNativeSetDelayEnabled(false);
+
+  double start = nowSeconds();
+  uint64_t hash = game_frame_hash();
+  for (int32_t tick = 0; tick < recordedTicks && inputDivergenceTick < 0; tick++) {
+    game_tick();
+    hash = game_frame_hash();
+    if (hashes != NULL) {
+      fprintf(hashes, "%ld %016llx\n", (long)tick, (unsigned long long)hash);
+    }
+  }
+  double elapsed = nowSeconds() - start;
+
+  if (hashes != NULL && fclose(hashes) != 0) {
+    fprintf(stderr, "replay: cannot write %s\n", hashesPath);
+    return 2;
+  }
+
+  printf("replay.ticks %d\n", game_cycle());
+  printf("replay.readings %zu\n", nextRecord);
+  printf("replay.seconds %.6f\n", elapsed);
+  printf("replay.ticks_per_sec %.1f\n", (elapsed > 0.0) ? (double)game_cycle() / elapsed : 0.0);
+  printf("replay.final_hash %016llx\n", (unsigned long long)hash);
+
+  // Readings logged by the tick that was in progress when the recording ended (e.g. a session
+  // stopped by PANEL_NATIVE_SCANS) are not replayed.
+  if (inputDivergenceTick < 0 && nextRecord < recordCount &&
+      records[nextRecord].cycle < recordedTicks) {
+    inputDivergenceTick = records[nextRecord].cycle;
+    snprintf(inputDivergence, sizeof(inputDivergence),
+             "%zu recorded readings were never requested", recordCount - nextRecord);
+  }
+  if (inputDivergenceTick >= 0) {
+    printf("replay.diverged_at %ld\n", inputDivergenceTick);
+    fprintf(stderr, "replay: input diverged: %s\n", inputDivergence);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  compareHashes
+
+  Report the first tick at which two hash files differ (or where one of them ends early).
+*/
+static int compareHashes(const char* pathA, const char* pathB) {
+  FILE* fileA = fopen(pathA, "r");
+  FILE* fileB = fopen(pathB, "r");
+  if (fileA == NULL || fileB == NULL) {
+    fprintf(stderr, "replay: cannot read %s\n", (fileA == NULL) ? pathA : pathB);
+    if (fileA != NULL) fclose(fileA);
+    if (fileB != NULL) fclose(fileB);
+    return 2;
+  }
+
+  char lineA[64];
+  char lineB[64];
+  long ticks = 0;
+  int result = 0;
+  for (;;) {
+    const bool hasA = fgets(lineA, sizeof(lineA), fileA) != NULL;
+    const bool hasB = fgets(lineB, sizeof(lineB), fileB) != NULL;
+    if (!hasA && !hasB) break;
+
+    if (!hasA || !hasB || strcmp(lineA, lineB) != 0) {
+      printf("compare.first_divergent_tick %ld\n", ticks);
+      printf("compare.a %s", hasA ? lineA : "(end)\n");
+      printf("compare.b %s", hasB ? lineB : "(end)\n");
+      result = 1;
+      break;
+    }
+    ticks++;
+  }
+
+  if (result == 0) {
+    printf("compare.identical_ticks %ld\n", ticks);
+  }
+  fclose(fileA);
+  fclose(fileB);
+  return result;
+}
+
+int main(int argc, char** argv) {
+  if (argc == 4 && strcmp(argv[1], "--compare") == 0) {
+    return compareHashes(argv[2], argv[3]);
+  }
+  if (argc == 2 || argc == 3) {
+    return runReplay(argv[1], (argc == 3) ? argv[2] : NULL);
+  }
+
+  fprintf(stderr, "usage: %s <recording.pil> [hashes.txt]\n", argv[0]);
+  fprintf(stderr, "       %s --compare <a.txt> <b.txt>\n", argv[0]);
+  return 2;
+}
@@ -0,0 +1,379 @@
+/*
+  scanout_bench.c
+
+  What this file does
+  -------------------
+  Micro-benchmark for the frame-to-bitstream conversion alone: turning a 32x32 frame into the 16
+  row-pair payloads that PushRow() shifts out (PANEL_ROW_WORDS words each: R, G, B of the top row,
+  then R, G, B of the bottom row, pixel x in bit x). No game logic and no shifting are timed.
+
+  The frames are captured once from a real game session (src/game.c with a scripted player, start
+  screen followed by play), then stored in each candidate framebuffer representation and converted
+  back to back:
+
+    char_switch       char colour codes, a switch per pixel per colour plane (the original
+                      displayRow())
+    char_lut          char colour codes through a 256-entry code-to-RGB table
+    palette_index     one 3-bit RGB palette index per pixel (uint8_t)
+    packed_bitplanes  three 32-bit plane words per row, converted with game.c's displayRow()
+    payload_cache     packed bitplanes plus a dirty mask of changed row-pairs: only those payloads
+                      are rebuilt, as game.c's prepareScanout() does
+
+  Every strategy's payloads are checked against packed_bitplanes before timing. Each strategy is
+  timed `runs` times over `frames` frames and the fastest run is reported, in ns per row-pair and,
+  on x86 (time-stamp counter), cycles per row-pair and payload bits per cycle.
+
+  Usage:
+    pong_scanout_bench [frames] [runs]
+
+  Output is a single JSON object; its keys and their order are stable (version 1):
+
+    {"benchmark": "scanout_conversion", "version": 1, "frames": N, "runs": R,
+     "row_pairs_per_frame": 16, "bits_per_row_pair": 192, "cycle_counter": "tsc" | "none",
+     "strategies": [{"name": "...", "ns_per_row_pair": x, "cycles_per_row_pair": x | null,
+                     "bits_per_cycle": x | null, "rebuilt_row_pairs_per_frame": x}, ...]}
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "panel.h"
+#include "panel_native.h"
+#include "game.h"
+#include "../tests/test_support.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER 1
+#else
+#define HAVE_CYCLE_COUNTER 0
+#endif
+
+#define FRAME_SIZE      32
+#define ROW_PAIRS       (FRAME_SIZE / 2)
+#define CAPTURED_FRAMES 256
+#define BITS_PER_ROW_PAIR (PANEL_ROW_WORDS * 32)
+
+#define DEFAULT_FRAMES 100000
+#define DEFAULT_RUNS   5
+
+// -----------------------------------------------------------------------------
+// Game symbols (src/game.c)
+// -----------------------------------------------------------------------------
+
+extern int gameMode;
+extern int cycle;
+extern int32_t ballY; // Q16.16
+
+char getPixel(int x, int y);
+uint8_t colourCodeToBits(char colour);
+void displayRow(const uint32_t matrixRow[3], uint32_t planes[3]);
+
+// -----------------------------------------------------------------------------
+// Captured frames in each representation
+// -----------------------------------------------------------------------------
+
+static char charFrames[CAPTURED_FRAMES][FRAME_SIZE][FRAME_SIZE];
+static uint8_t paletteFrames[CAPTURED_FRAMES][FRAME_SIZE][FRAME_SIZE];
+static uint32_t planeFrames[CAPTURED_FRAMES][FRAME_SIZE][3];
+static uint16_t dirtyMasks[CAPTURED_FRAMES]; // row-pairs that differ from the previous frame
+
+static uint8_t codeToBits[256];
+
+// Converted output. Global so that no strategy's stores can be optimised away.
+uint32_t payloads[ROW_PAIRS][PANEL_ROW_WORDS];
+
+/*
+  capturePlayerInput
+
+  The start screen is held for 32 ticks, then both sticks go up; during play the left paddle
+  tracks the ball and the right paddle sweeps, so frames show scores, serves and rallies.
+*/
+static uint32_t capturePlayerInput(int channel) {
+  const bool isLeft = (channel == 1 || channel == 2);
+  if (!isLeft && channel != 6 && channel != 7) return 0;
+
+  if (gameMode == 0) return (cycle < 32) ? (JOYSTICK_RAW_TOP + JOYSTICK_RAW_BOTTOM) / 2 : JOYSTICK_RAW_TOP;
+  if (gameMode != 1) return JOYSTICK_RAW_TOP;
+  if (isLeft) return paddleYToRaw((ballY >> 16) - 2);
+
+  int phase = cycle % (2 * PADDLE_MAX_Y);
+  return paddleYToRaw((phase < PADDLE_MAX_Y) ? phase : (2 * PADDLE_MAX_Y - phase));
+}
+
+/*
+  captureFrames
+
+  Run the game for CAPTURED_FRAMES ticks and store each frame in every representation.
+*/
+static void captureFrames(void) {
+  panelNativeSetInputHook(capturePlayerInput);
+  game_setup();
+  panelNativeSetDelayEnabled(false);
+
+  for (int c = 0; c < 256; c++) codeToBits[c] = colourCodeToBits((char)c);
+
+  for (int f = 0; f < CAPTURED_FRAMES; f++) {
+    game_tick();
+    for (int y = 0; y < FRAME_SIZE; y++) {
+      planeFrames[f][y][0] = planeFrames[f][y][1] = planeFrames[f][y][2] = 0;
+      for (int x = 0; x < FRAME_SIZE; x++) {
+        const char code = getPixel(x, y);
+        const uint8_t bits = colourCodeToBits(code);
+        charFrames[f][y][x] = code;
+        paletteFrames[f][y][x] = bits;
+        for (int p = 0; p < 3; p++) planeFrames[f][y][p] |= (uint32_t)((bits >> p) & 1u) << x;
+      }
+    }
+  }
+
+  for (int f = 0; f < CAPTURED_FRAMES; f++) {
+    const int previous = (f + CAPTURED_FRAMES - 1) % CAPTURED_FRAMES;
+    uint16_t mask = 0;
+    for (int i = 0; i < ROW_PAIRS; i++) {
+      if (memcmp(planeFrames[f][i], planeFrames[previous][i], sizeof(planeFrames[f][i])) != 0 ||
+          memcmp(planeFrames[f][i + ROW_PAIRS], planeFrames[previous][i + ROW_PAIRS],
+                 sizeof(planeFrames[f][i])) != 0) {
+        mask |= (uint16_t)(1u << i);
+      }
+    }
+    dirtyMasks[f] = mask;
+  }
+
+  panelNativeSetInputHook(NULL);
+}
+
+// -----------------------------------------------------------------------------
+// Strategies: convert captured frame `f` into payloads
+// -----------------------------------------------------------------------------
+
+/*
+  charSwitchRow
+
+  The original displayRow(): for each colour plane, decode every pixel's code with a switch.
+*/
+static void charSwitchRow(const char row[FRAME_SIZE], uint32_t planes[3]) {
+  for (int p = 0; p < 3; p++) {
+    uint32_t word = 0;
+    for (int x = 0; x < FRAME_SIZE; x++) {
+      uint8_t bits;
+      switch (row[x]) {
+        case 'R': bits = 1; break;
+        case 'G': bits = 2; break;
+        case 'Y': bits = 3; break;
+        case 'B': bits = 4; break;
+        case 'M': bits = 5; break;
+        case 'C': bits = 6; break;
+        case 'W': bits = 7; break;
+        default: bits = 0; break;
+      }
+      word |= (uint32_t)((bits >> p) & 1u) << x;
+    }
+    planes[p] = word;
+  }
+}
+
+static void convertCharSwitch(int f) {
+  for (int i = 0; i < ROW_PAIRS; i++) {
+    charSwitchRow(charFrames[f][i], &payloads[i][0]);
+    charSwitchRow(charFrames[f][i + ROW_PAIRS], &payloads[i][3]);
+  }
+}
+
+/*
+  bitsRow
+
+  Pack one row of 3-bit RGB values into its three plane words.
+*/
+static inline void bitsRow(const uint8_t* bits, const uint8_t* lut, const char* codes, uint32_t planes[3]) {
+  uint32_t r = 0, g = 0, b = 0;
+  for (int x = 0; x < FRAME_SIZE; x++) {
+    const uint32_t v = (lut != NULL) ? lut[(uint8_t)codes[x]] : bits[x];
+    r |= (v & 1u) << x;
+    g |= ((v >> 1) & 1u) << x;
+    b |= ((v >> 2) & 1u) << x;
+  }
+  planes[0] = r;
+  planes[1] = g;
+  planes[2] = b;
+}
+
+static void convertCharLut(int f) {
+  for (int i = 0; i < ROW_PAIRS; i++) {
+    bitsRow(NULL, codeToBits, charFrames[f][i], &payloads[i][0]);
+    bitsRow(NULL, codeToBits, charFrames[f][i + ROW_PAIRS], &payloads[i][3]);
+  }
+}
+
+static void convertPaletteIndex(int f) {
+  for (int i = 0; i < ROW_PAIRS; i++) {
+    bitsRow(paletteFrames[f][i], NULL, NULL, &payloads[i][0]);
+    bitsRow(paletteFrames[f][i + ROW_PAIRS], NULL, NULL, &payloads[i][3]);
+  }
+}
+
+static void convertPackedBitplanes(int f) {
+  for (int i = 0; i < ROW_PAIRS; i++) {
+    displayRow(planeFrames[f][i], &payloads[i][0]);
+    displayRow(planeFrames[f][i + ROW_PAIRS], &payloads[i][3]);
+  }
+}
+
+static void convertPayloadCache(int f) {
+  uint32_t dirty = dirtyMasks[f];
+  while (dirty) {
+    const int i = __builtin_ctz(dirty);
+    dirty &= dirty - 1;
+    displayRow(planeFrames[f][i], &payloads[i][0]);
+    displayRow(planeFrames[f][i + ROW_PAIRS], &payloads[i][3]);
+  }
+}
+
+typedef struct {
+  const char* name;
+  void (*convert)(int frame);
+  bool cached; // converts only dirty row-pairs (payloads persist between frames)
+} Strategy;
+
+static const Strategy strategies[] = {
+  {"char_switch", convertCharSwitch, false},
+  {"char_lut", convertCharLut, false},
+  {"palette_index", convertPaletteIndex, false},
+  {"packed_bitplanes", convertPackedBitplanes, false},
+  {"payload_cache", convertPayloadCache, true},
+};
+#define STRATEGY_COUNT ((int)(sizeof(strategies) / sizeof(strategies[0])))
+
+// -----------------------------------------------------------------------------
+// Verification and timing
+// -----------------------------------------------------------------------------
+
+/*
+  verifyStrategy
+
+  Check that `strategy` produces the reference payloads for every captured frame. A cached
+  strategy is run over the frames in order from a full conversion, as it would be used.
+*/
+static bool verifyStrategy(const Strategy* strategy) {
+  uint32_t expected[ROW_PAIRS][PANEL_ROW_WORDS];
+  if (strategy->cached) convertPackedBitplanes(CAPTURED_FRAMES - 1);
+
+  for (int f = 0; f < CAPTURED_FRAMES; f++) {
+    strategy->convert(f);
+    memcpy(expected, payloads, sizeof(expected));
+    convertPackedBitplanes(f);
+    if (memcmp(expected, payloads, sizeof(expected)) != 0) {
+      fprintf(stderr, "scanout_bench: %s differs from packed_bitplanes on frame %d\n",
+              strategy->name, f);
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+  nowSeconds
+
+  Monotonic wall-clock time in seconds.
+*/
+static double nowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/*
+  readCycles
+
+  Time-stamp counter where available, else 0.
+*/
+static uint64_t readCycles(void) {
+#if HAVE_CYCLE_COUNTER
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+typedef struct {
+  double seconds;
+  uint64_t cycles;
+  uint64_t rebuiltRowPairs;
+} Timing;
+
+/*
+  timeStrategy
+
+  Convert `frames` frames (cycling through the captured ones); keep the fastest of `runs` runs.
+*/
+static Timing timeStrategy(const Strategy* strategy, uint64_t frames, int runs) {
+  Timing best = {0.0, 0, 0};
+  for (int run = 0; run < runs; run++) {
+    uint64_t rebuilt = 0;
+    const double start = nowSeconds();
+    const uint64_t startCycles = readCycles();
+    for (uint64_t n = 0; n < frames; n++) {
+      const int f = (int)(n % CAPTURED_FRAMES);
+      strategy->convert(f);
+      rebuilt += strategy->cached ? (uint64_t)__builtin_popcount(dirtyMasks[f]) : ROW_PAIRS;
+    }
+    const uint64_t cycles = readCycles() - startCycles;
+    const double seconds = nowSeconds() - start;
+    if (run == 0 || seconds < best.seconds) {
+      best.seconds = seconds;
+      best.cycles = cycles;
+      best.rebuiltRowPairs = rebuilt;
+    }
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  const uint64_t frames = (argc > 1) ? strtoull(argv[1], NULL, 10) : DEFAULT_FRAMES;
+  const int runs = (argc > 2) ? atoi(argv[2]) : DEFAULT_RUNS;
+  if (frames == 0 || runs <= 0) {
+    fprintf(stderr, "usage: %s [frames] [runs]\n", argv[0]);
+    return 2;
+  }
+
+  captureFrames();
+  for (int s = 0; s < STRATEGY_COUNT; s++) {
+    if (!verifyStrategy(&strategies[s])) return 1;
+  }
+
+  printf("{\n");
+  printf("  \"benchmark\": \"scanout_conversion\",\n");
+  printf("  \"version\": 1,\n");
+  printf("  \"frames\": %llu,\n", (unsigned long long)frames);
+  printf("  \"runs\": %d,\n", runs);
+  printf("  \"row_pairs_per_frame\": %d,\n", ROW_PAIRS);
+  printf("  \"bits_per_row_pair\": %d,\n", BITS_PER_ROW_PAIR);
+  printf("  \"cycle_counter\": \"%s\",\n", HAVE_CYCLE_COUNTER ? "tsc" : "none");
+  printf("  \"strategies\": [\n");
+
+  for (int s = 0; s < STRATEGY_COUNT; s++) {
+    const Timing t = timeStrategy(&strategies[s], frames, runs);
+    const double rowPairs = (double)frames * ROW_PAIRS;
+
+    printf("    {\"name\": \"%s\", \"ns_per_row_pair\": %.3f", strategies[s].name,
+           t.seconds * 1e9 / rowPairs);
+    if (HAVE_CYCLE_COUNTER && t.cycles > 0) {
+      printf(", \"cycles_per_row_pair\": %.3f, \"bits_per_cycle\": %.3f",
+             (double)t.cycles / rowPairs, rowPairs * BITS_PER_ROW_PAIR / (double)t.cycles);
+    } else {
+      printf(", \"cycles_per_row_pair\": null, \"bits_per_cycle\": null");
+    }
+    printf(", \"rebuilt_row_pairs_per_frame\": %.3f}%s\n", (double)t.rebuiltRowPairs / (double)frames,
+           (s + 1 < STRATEGY_COUNT) ? "," : "");
+  }
+
+  printf("  ]\n");
+  printf("}\n");
+  return 0;
+}
@@ -0,0 +1,75 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Cross-target determinism check.
+#
+# Builds tests/determinism.c (game.c + panel_native.c, scripted input) for every target available
+# here and requires each trace to match tests/golden/determinism.trace byte for byte:
+#
+#   - the host compiler ($CC, default cc) at -O0 and -O2,
+#   - the host compiler at -O2 with the browser emulator's backend (emulator/src/panel_emu.c)
+#     in place of panel_native.c, so its decoder is checked on every host,
+#   - clang at -O2 with -ffp-contract=fast, if installed,
+#   - WebAssembly via emcc, run under node, if both are installed (the emulator's compiler and
+#     target, still with panel_native.c: panel_emu.c's browser bridge needs a page).
+#
+# Targets whose toolchain is missing are reported as skipped. Any mismatch prints the first
+# differing trace lines and exits non-zero.
+#
+# Usage: native/tests/cross_target.sh
+
+NATIVE_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+ROOT_DIR="$(cd "$NATIVE_DIR/.." && pwd)"
+GOLDEN="$NATIVE_DIR/tests/golden/determinism.trace"
+OUT_DIR="${OUT_DIR:-$NATIVE_DIR/bin/cross_target}"
+
+SOURCES=("$ROOT_DIR/src/game.c" "$ROOT_DIR/src/input_log.c" "$NATIVE_DIR/src/panel_native.c" "$NATIVE_DIR/tests/determinism.c")
+INCLUDES=(-I"$ROOT_DIR/src" -I"$NATIVE_DIR/src")
+
+mkdir -p "$OUT_DIR"
+failures=0
+
+# check NAME COMMAND...: run a built trace program and diff its output against the golden trace.
+check() {
+  local name="$1"
+  shift
+  "$@" > "$OUT_DIR/$name.trace"
+  if cmp -s "$GOLDEN" "$OUT_DIR/$name.trace"; then
+    echo "match    $name"
+  else
+    diff -u "$GOLDEN" "$OUT_DIR/$name.trace" | head -20 || true
+    echo "MISMATCH $name"
+    failures=$((failures + 1))
+  fi
+}
+
+CC="${CC:-cc}"
+for opt in -O0 -O2; do
+  "$CC" -std=c11 "$opt" -DGAME_NO_MAIN "${INCLUDES[@]}" -o "$OUT_DIR/host$opt" "${SOURCES[@]}"
+  check "host$opt" "$OUT_DIR/host$opt"
+done
+
+"$CC" -std=c11 -O2 -DGAME_NO_MAIN -DPANEL_EMU_NO_MAIN -DDETERMINISM_EMU -I"$ROOT_DIR/src" \
+  -o "$OUT_DIR/emulator-O2" "$ROOT_DIR/src/game.c" "$ROOT_DIR/src/input_log.c" \
+  "$ROOT_DIR/emulator/src/panel_emu.c" "$NATIVE_DIR/tests/determinism.c"
+check "emulator-O2" "$OUT_DIR/emulator-O2"
+
+if command -v clang >/dev/null 2>&1; then
+  clang -std=c11 -O2 -ffp-contract=fast -DGAME_NO_MAIN "${INCLUDES[@]}" -o "$OUT_DIR/clang-O2" "${SOURCES[@]}"
+  check "clang-O2" "$OUT_DIR/clang-O2"
+else
+  echo "skipped clang (not installed)"
+fi
+
+if command -v emcc >/dev/null 2>&1 && command -v node >/dev/null 2>&1; then
+  emcc -O2 -DGAME_NO_MAIN "${INCLUDES[@]}" -sENVIRONMENT=node -o "$OUT_DIR/wasm.js" "${SOURCES[@]}"
+  check "wasm" node "$OUT_DIR/wasm.js"
+else
+  echo "skipped wasm (emcc and node required)"
+fi
+
+if [[ "$failures" -ne 0 ]]; then
+  echo "cross-target determinism: $failures mismatching target(s)" >&2
+  exit 1
+fi
+echo "cross-target determinism: all traces match"
@@ -0,0 +1,256 @@
+/*
+  determinism.c
+
+  What this file does
+  -------------------
+  Determinism trace for the game logic. It links src/game.c (built with GAME_NO_MAIN) against
+  panel_native.c, drives game_tick() with a scripted, pseudo-random two-player input sequence and
+  prints a trace of what the panel showed:
+
+    - every tick, the latched 32x32 frame (panelNativeGetPixel) is folded into a running 64-bit
+      FNV-1a digest, so a single differing pixel on any tick changes every later line;
+    - every TRACE_INTERVAL ticks one line is printed with the digest, the game mode, the scores
+      and the raw Q16.16 ball state.
+
+  Because the physics is fixed point and the input script is integer-only, the trace must be
+  byte-identical on every compiler, optimisation level and target (x86, WASM, Cortex-M4).
+  `make test` compares it with tests/golden/determinism.trace; tests/cross_target.sh runs the same
+  program built for several targets (including WASM under node when emcc is available) and diffs
+  the traces against each other.
+
+  Built with -DDETERMINISM_HW it runs on the STM32 driver (hardware/panel_hw.c) and the
+  libopencm3 mock instead: the scripted readings are put on the mock ADC's channels before each
+  tick (in the order sampleInput() reads them), and the frames are read from the mock's pin-level
+  panel model, i.e. decoded from the clock, latch, data and address pins panel_hw.c drives. The
+  trace must still match tests/golden/determinism.trace (`make test-hw`).
+
+  Built with -DDETERMINISM_EMU it runs on the browser emulator's backend (emulator/src/panel_emu.c,
+  compiled for the host with PANEL_EMU_NO_MAIN): the scripted readings come through
+  emu_host_set_input() and the frames are the emulator's latched bits (emu_host_get_pixel()).
+  tests/cross_target.sh checks that trace against the golden one too.
+
+  Built with -DrefreshRateHz=N (not with DETERMINISM_HW) it also checks that the game still runs
+  at 60 ticks per second of simulated time (the delays' virtual clock, now_us()), i.e. that a
+  faster refresh rate does not make the game faster; the trace must still match the golden one.
+
+  With a second argument it also writes one "tick hash" line per tick (game_frame_hash(), the
+  format written by pong_replay), which `make test` uses to check that a recording of this
+  session (PANEL_NATIVE_RECORD) replays to the same frames.
+
+  Usage:
+    determinism_test [ticks] [hashes.txt]
+*/
+
+#include "panel.h"
+#include "game.h"
+#include "test_support.h"
+
+#ifdef DETERMINISM_HW
+#include "libopencm3_mock.h"
+#include "panel_hw_inline.h" // pin map
+#define readPixel mockPanelPixel
+#elif defined(DETERMINISM_EMU)
+void emu_host_set_input(uint32_t (*hook)(int channel)); // panel_emu.c, host builds
+uint8_t emu_host_get_pixel(int x, int y);
+#define readPixel emu_host_get_pixel
+#else
+#include "panel_native.h"
+#define readPixel panelNativeGetPixel
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TICKS  20000
+
+#if defined(refreshRateHz) && !defined(DETERMINISM_HW)
+// game.c's refreshRate, which every refresh rate must keep. The row dwell is rounded down to
+// whole microseconds, so the simulated tick period may be slightly short.
+#define GAME_TICK_HZ           60
+#define TICK_RATE_TOLERANCE_PC 2
+#endif
+#define TRACE_INTERVAL 100
+
+// -----------------------------------------------------------------------------
+// Game symbols (src/game.c)
+// -----------------------------------------------------------------------------
+
+extern int gameMode;
+extern int cycle;
+extern int lScore;
+extern int rScore;
+extern int32_t ballX; // Q16.16
+extern int32_t ballY; // Q16.16
+extern int32_t ballVelocityX;
+extern int32_t ballVelocityY;
+
+// -----------------------------------------------------------------------------
+// Scripted input
+// -----------------------------------------------------------------------------
+
+static uint32_t randomState = 0x2545F491u;
+
+/*
+  nextRandom
+
+  32-bit xorshift, so the input script is the same on every target.
+*/
+static uint32_t nextRandom(void) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+/*
+  scriptedInput
+
+  On the start and win screens both joysticks are held at full deflection. During play each
+  paddle follows the ball with a random error of up to +-4 pixels that changes every few ticks,
+  so rallies, misses, serves and wins all occur.
+*/
+static uint32_t paddleError[2];
+
+static uint32_t scriptedInput(int channel) {
+  const int paddle = (channel == 1 || channel == 2) ? 0 : 1;
+  if (paddle == 1 && channel != 6 && channel != 7) return 0;
+
+  if (gameMode == 0 || gameMode == 3) {
+    return JOYSTICK_RAW_TOP;
+  }
+
+  if ((cycle & 7) == 0 && (channel == 1 || channel == 6)) {
+    paddleError[paddle] = nextRandom() % 9u;
+  }
+  return paddleYToRaw((ballY >> 16) - 2 + (int)paddleError[paddle] - 4);
+}
+
+#ifdef DETERMINISM_HW
+/*
+  scanScriptedInput
+
+  Put the next tick's scripted readings on the mock ADC and let it complete one scan, which is
+  what the polled driver then converts or the DMA driver copies to memory.
+*/
+static void scanScriptedInput(void) {
+  static const int channels[4] = {1, 2, 6, 7}; // sampleInput() order
+  for (int i = 0; i < 4; i++) {
+    mockAdcSetChannel(channels[i], scriptedInput(channels[i]));
+  }
+  mockAdcRunSequences(ADC1, 1); // does nothing for the polled driver
+}
+
+/*
+  attachPanel
+
+  Wire the mock's panel model to panel_hw.c's pins (hardware/panel_hw_inline.h).
+*/
+static void attachPanel(void) {
+  const MockPanelWiring wiring = {
+    .port = LEDPANEL_PORT,
+    .addressPins = {A_PIN, B_PIN, C_PIN, D_PIN},
+    .clockPin = CLK_PIN,
+    .latchPin = LAT_PIN,
+    .dataPin = INP_PIN,
+    .rowOffset = 1,
+#ifdef PANEL_PARALLEL_SHIFT
+    .parallel = true,
+#endif
+    .dataPort = DATA_PORT,
+    .dataShift = DATA_PIN_SHIFT,
+  };
+  mockReset();
+  mockPanelAttach(&wiring);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Trace
+// -----------------------------------------------------------------------------
+
+static uint64_t frameDigest = 1469598103934665603ull;
+
+/*
+  foldFrame
+
+  Fold the latched panel contents into the running FNV-1a digest.
+*/
+static void foldFrame(void) {
+  for (int y = 0; y < 32; y++) {
+    for (int x = 0; x < 32; x++) {
+      frameDigest ^= readPixel(x, y);
+      frameDigest *= 1099511628211ull;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  const long ticks = (argc > 1) ? atol(argv[1]) : DEFAULT_TICKS;
+  if (ticks <= 0) {
+    fprintf(stderr, "usage: %s [ticks] [hashes.txt]\n", argv[0]);
+    return 2;
+  }
+
+  FILE* hashes = NULL;
+  if (argc > 2) {
+    hashes = fopen(argv[2], "w");
+    if (hashes == NULL) {
+      fprintf(stderr, "cannot write %s\n", argv[2]);
+      return 2;
+    }
+  }
+
+#ifdef DETERMINISM_HW
+  attachPanel();
+  game_setup();
+#elif defined(DETERMINISM_EMU)
+  emu_host_set_input(scriptedInput);
+  game_setup();
+#else
+  panelNativeSetInputHook(scriptedInput);
+  game_setup();
+  panelNativeSetDelayEnabled(false);
+#endif
+
+#ifdef GAME_TICK_HZ
+  uint64_t simulatedUs = 0;
+#endif
+  for (long tick = 1; tick <= ticks; tick++) {
+#ifdef DETERMINISM_HW
+    scanScriptedInput();
+#endif
+#ifdef GAME_TICK_HZ
+    const uint32_t tickStartUs = now_us();
+    game_tick();
+    simulatedUs += now_us() - tickStartUs;
+#else
+    game_tick();
+#endif
+    foldFrame();
+    if (hashes != NULL) {
+      fprintf(hashes, "%ld %016llx\n", tick - 1, (unsigned long long)game_frame_hash());
+    }
+    if (tick % TRACE_INTERVAL == 0) {
+      printf("tick %ld frames %016llx mode %d score %d-%d ball %08lx,%08lx vel %08lx,%08lx\n",
+             tick, (unsigned long long)frameDigest, gameMode, lScore, rScore,
+             (unsigned long)(uint32_t)ballX, (unsigned long)(uint32_t)ballY,
+             (unsigned long)(uint32_t)ballVelocityX, (unsigned long)(uint32_t)ballVelocityY);
+    }
+  }
+
+  if (hashes != NULL) {
+    fclose(hashes);
+  }
+
+#ifdef GAME_TICK_HZ
+  const double tickHz = (double)ticks * 1e6 / (double)simulatedUs;
+  if (tickHz < GAME_TICK_HZ * (100 - TICK_RATE_TOLERANCE_PC) / 100.0 ||
+      tickHz > GAME_TICK_HZ * (100 + TICK_RATE_TOLERANCE_PC) / 100.0) {
+    fprintf(stderr, "determinism: %.2f ticks per second at refreshRateHz=%d, expected %d\n", tickHz,
+            (int)(refreshRateHz), GAME_TICK_HZ);
+    return 1;
+  }
+#endif
+  return 0;
+}
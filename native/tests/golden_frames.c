@@ -0,0 +1,489 @@
+/*
+  golden_frames.c
+
+  What this file does
+  -------------------
+  Golden-frame regression suite for the game. It links src/game.c (built with GAME_NO_MAIN)
+  against panel_native.c with delays disabled and drives game_tick() through scripted input
+  scenarios:
+
+    start_screen     idle start screen, then the start gesture
+    serve_each_side  points lost on each side and the serve gesture from each server
+    paddle_offsets   both paddles return the ball at every offset along the paddle (-1..4)
+    wall_bounces     steep returns that bounce off the top and bottom borders
+    score_to_win     one player scores up to winScore
+    win_screen       the win screen's colour cycling and the gesture back to the start screen
+
+  For every tick a scenario records the game framebuffer hash (game_frame_hash()) and a hash of
+  what the panel latched (panelNativeGetPixel()), so both the drawing code and the scanout path
+  are covered. Game events (mode changes, scores, paddle hits with their offset, wall bounces,
+  win-screen colour changes) are logged as they happen, and the full latched frame is dumped as
+  32 lines of colour codes at the first and last tick and after every mode or colour change.
+
+  Each scenario's record is compared line by line with tests/golden/frames/<scenario>.txt; the
+  first differing line is reported. The golden files describe the default compile-time options
+  (colourDepth 1). Setting UPDATE_GOLDEN=1 rewrites them instead.
+
+  The game keeps its state in globals, so scenarios run in separate processes: one fork() per
+  scenario, up to one per online CPU at a time.
+
+  Usage:
+    golden_frames <golden_dir> <output_dir> [scenario...]
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "panel.h"
+#include "panel_native.h"
+#include "game.h"
+#include "test_support.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// Ticks a server holds the joystick centred in the serve pause before the serve gesture.
+#define SERVE_WAIT_TICKS 30
+
+// -----------------------------------------------------------------------------
+// Game symbols (src/game.c)
+// -----------------------------------------------------------------------------
+
+extern int gameMode;
+extern int cycle;
+extern int lScore;
+extern int rScore;
+extern bool lServe;
+extern int lPaddleY;
+extern int rPaddleY;
+extern int32_t ballX; // Q16.16
+extern int32_t ballY; // Q16.16
+extern int32_t ballVelocityX;
+extern int32_t ballVelocityY;
+extern char textColour;
+extern char textBackgroundColour;
+extern char borderColour;
+
+// -----------------------------------------------------------------------------
+// Scripted input helpers
+// -----------------------------------------------------------------------------
+
+/*
+  channelPaddle
+
+  0 for the left joystick's channels (1, 2), 1 for the right joystick's (6, 7), -1 otherwise.
+*/
+static int channelPaddle(int channel) {
+  if (channel == 1 || channel == 2) return 0;
+  if (channel == 6 || channel == 7) return 1;
+  return -1;
+}
+
+/*
+  ballRow
+
+  Whole-pixel row of the ball.
+*/
+static int ballRow(void) {
+  return (int)(ballY >> 16);
+}
+
+// Ticks spent in the current serve pause (mode 2).
+static int servePauseTicks = 0;
+
+/*
+  serveGestureInput
+
+  Input for the serve pause: both sticks centred for SERVE_WAIT_TICKS, then the server pushes
+  their stick fully up.
+*/
+static uint32_t serveGestureInput(int paddle) {
+  const bool isServer = (paddle == 0) == lServe;
+  if (isServer && servePauseTicks >= SERVE_WAIT_TICKS) return JOYSTICK_RAW_TOP;
+  return JOYSTICK_RAW_CENTRE;
+}
+
+// -----------------------------------------------------------------------------
+// Scenarios
+// -----------------------------------------------------------------------------
+
+// Paddle offset schedule for returns: ball row minus paddle top at the moment of the hit. These are
+// the rows that always connect; a ball with a fractional row of 5 is past the paddle's bottom edge.
+static const int returnOffsets[] = {-1, 0, 1, 2, 3, 4};
+#define RETURN_OFFSET_COUNT ((int)(sizeof(returnOffsets) / sizeof(returnOffsets[0])))
+static int nextOffsetIndex[2];
+
+/*
+  startScreenInput
+
+  Sticks centred for 180 ticks (the start screen stays up), then both fully up to start.
+*/
+static uint32_t startScreenInput(int channel) {
+  if (channelPaddle(channel) < 0) return 0;
+  return (cycle < 180) ? JOYSTICK_RAW_CENTRE : JOYSTICK_RAW_TOP;
+}
+
+/*
+  serveEachSideInput
+
+  Start at once, keep both paddles at the top so every serve is missed, and serve with the
+  gesture from whichever side is serving.
+*/
+static uint32_t serveEachSideInput(int channel) {
+  const int paddle = channelPaddle(channel);
+  if (paddle < 0) return 0;
+  if (gameMode == 2) return serveGestureInput(paddle);
+  return JOYSTICK_RAW_TOP;
+}
+
+/*
+  trackBallInput
+
+  Put `paddle` so that the ball meets it `offset` rows below the paddle's top.
+*/
+static uint32_t trackBallInput(int paddle, int offset) {
+  (void)paddle;
+  return paddleYToRaw(ballRow() - offset);
+}
+
+/*
+  paddleOffsetsInput
+
+  Both paddles track the ball; each return uses the next offset of returnOffsets for that paddle.
+*/
+static uint32_t paddleOffsetsInput(int channel) {
+  const int paddle = channelPaddle(channel);
+  if (paddle < 0) return 0;
+  if (gameMode == 0) return JOYSTICK_RAW_TOP;
+  if (gameMode == 2) return serveGestureInput(paddle);
+  return trackBallInput(paddle, returnOffsets[nextOffsetIndex[paddle] % RETURN_OFFSET_COUNT]);
+}
+
+/*
+  wallBouncesInput
+
+  Left returns off the paddle's bottom row and right off the row above its top, giving steep rallies that
+  bounce off both borders.
+*/
+static uint32_t wallBouncesInput(int channel) {
+  const int paddle = channelPaddle(channel);
+  if (paddle < 0) return 0;
+  if (gameMode == 0) return JOYSTICK_RAW_TOP;
+  if (gameMode == 2) return serveGestureInput(paddle);
+  return trackBallInput(paddle, (paddle == 0) ? 4 : -1);
+}
+
+/*
+  scoreToWinInput
+
+  The left paddle returns everything from its centre; the right paddle stays at the top, so the
+  left player scores until winScore. On the win screen the sticks are centred until the screen
+  has been up long enough to leave, then both go fully up.
+*/
+static uint32_t scoreToWinInput(int channel) {
+  const int paddle = channelPaddle(channel);
+  if (paddle < 0) return 0;
+  if (gameMode == 0) return (cycle < 10) ? JOYSTICK_RAW_TOP : JOYSTICK_RAW_CENTRE;
+  if (gameMode == 2) return serveGestureInput(paddle);
+  if (gameMode == 3) return JOYSTICK_RAW_CENTRE;
+  return (paddle == 0) ? trackBallInput(0, 2) : JOYSTICK_RAW_TOP;
+}
+
+// Tick at which win_screen leaves the win screen with the gesture.
+static int winScreenExitTick = -1;
+
+/*
+  winScreenInput
+
+  As score_to_win, then stay on the win screen for 660 ticks (colour cycling every 120 ticks)
+  before both sticks go up to return to the start screen.
+*/
+static uint32_t winScreenInput(int channel) {
+  if (gameMode == 3 && channelPaddle(channel) >= 0) {
+    if (winScreenExitTick < 0) winScreenExitTick = cycle + 660;
+    return (cycle >= winScreenExitTick) ? JOYSTICK_RAW_TOP : JOYSTICK_RAW_CENTRE;
+  }
+  if (winScreenExitTick >= 0 && gameMode == 0) return JOYSTICK_RAW_CENTRE;
+  return scoreToWinInput(channel);
+}
+
+typedef struct {
+  const char* name;
+  int ticks;
+  uint32_t (*input)(int channel);
+} Scenario;
+
+static const Scenario scenarios[] = {
+  {"start_screen", 190, startScreenInput},
+  {"serve_each_side", 320, serveEachSideInput},
+  {"paddle_offsets", 600, paddleOffsetsInput},
+  {"wall_bounces", 400, wallBouncesInput},
+  {"score_to_win", 620, scoreToWinInput},
+  {"win_screen", 1260, winScreenInput},
+};
+#define SCENARIO_COUNT ((int)(sizeof(scenarios) / sizeof(scenarios[0])))
+
+// -----------------------------------------------------------------------------
+// Recording a scenario
+// -----------------------------------------------------------------------------
+
+/*
+  colourCode
+
+  Colour code ('X', 'R', 'G', 'Y', 'B', 'M', 'C', 'W') of a latched 3-bit pixel.
+*/
+static char colourCode(uint8_t bits) {
+  static const char codes[8] = {'X', 'R', 'G', 'Y', 'B', 'M', 'C', 'W'};
+  return codes[bits & 7u];
+}
+
+/*
+  panelHash
+
+  FNV-1a hash of the latched 32x32 panel.
+*/
+static uint64_t panelHash(void) {
+  uint64_t hash = 1469598103934665603ull;
+  for (int y = 0; y < 32; y++) {
+    for (int x = 0; x < 32; x++) {
+      hash ^= panelNativeGetPixel(x, y);
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+/*
+  dumpFrame
+
+  Write the latched panel as 32 rows of colour codes.
+*/
+static void dumpFrame(FILE* out, int tick) {
+  fprintf(out, "frame %d\n", tick);
+  for (int y = 0; y < 32; y++) {
+    char row[33];
+    for (int x = 0; x < 32; x++) row[x] = colourCode(panelNativeGetPixel(x, y));
+    row[32] = '\0';
+    fprintf(out, "  %s\n", row);
+  }
+}
+
+/*
+  recordScenario
+
+  Run `scenario` from a fresh game and write its record (hashes, events, frames) to `out`.
+*/
+static void recordScenario(const Scenario* scenario, FILE* out) {
+  panelNativeSetInputHook(scenario->input);
+  game_setup();
+  panelNativeSetDelayEnabled(false);
+
+  fprintf(out, "scenario %s ticks %d\n", scenario->name, scenario->ticks);
+
+  int previousMode = gameMode;
+  int previousScore[2] = {lScore, rScore};
+  char previousColours[3] = {textColour, textBackgroundColour, borderColour};
+
+  for (int tick = 0; tick < scenario->ticks; tick++) {
+    const int32_t velocityXBefore = ballVelocityX;
+    const int32_t velocityYBefore = ballVelocityY;
+    const int rowBefore = ballRow(); // the row collisions are checked at during this tick
+
+    game_tick();
+    servePauseTicks = (gameMode == 2) ? servePauseTicks + 1 : 0;
+
+    bool dump = (tick == 0) || (tick == scenario->ticks - 1);
+    fprintf(out, "%d %016llx %016llx\n", tick, (unsigned long long)game_frame_hash(),
+            (unsigned long long)panelHash());
+
+    if (gameMode == 1 && previousMode == 1) {
+      if (velocityXBefore < 0 && ballVelocityX > 0) {
+        fprintf(out, "event %d hit left offset %d\n", tick, rowBefore - lPaddleY);
+        nextOffsetIndex[0]++;
+      } else if (velocityXBefore > 0 && ballVelocityX < 0) {
+        fprintf(out, "event %d hit right offset %d\n", tick, rowBefore - rPaddleY);
+        nextOffsetIndex[1]++;
+      } else if (velocityYBefore != 0 && (velocityYBefore < 0) != (ballVelocityY < 0)) {
+        fprintf(out, "event %d bounce %s\n", tick, (velocityYBefore < 0) ? "top" : "bottom");
+      }
+    }
+    if (gameMode != previousMode) {
+      fprintf(out, "event %d mode %d -> %d\n", tick, previousMode, gameMode);
+      previousMode = gameMode;
+      dump = true;
+    }
+    if (lScore != previousScore[0] || rScore != previousScore[1]) {
+      fprintf(out, "event %d score %d-%d\n", tick, lScore, rScore);
+      previousScore[0] = lScore;
+      previousScore[1] = rScore;
+    }
+    if (textColour != previousColours[0] || textBackgroundColour != previousColours[1] ||
+        borderColour != previousColours[2]) {
+      fprintf(out, "event %d colours text %c background %c border %c\n", tick, textColour,
+              textBackgroundColour, borderColour);
+      previousColours[0] = textColour;
+      previousColours[1] = textBackgroundColour;
+      previousColours[2] = borderColour;
+      dump = true;
+    }
+
+    if (dump) dumpFrame(out, tick);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Comparison and the parallel driver
+// -----------------------------------------------------------------------------
+
+/*
+  compareWithGolden
+
+  Compare two record files line by line. Returns true when identical; otherwise prints the first
+  difference.
+*/
+static bool compareWithGolden(const char* name, const char* goldenPath, const char* outputPath) {
+  FILE* golden = fopen(goldenPath, "r");
+  FILE* output = fopen(outputPath, "r");
+  if (golden == NULL || output == NULL) {
+    fprintf(stderr, "FAIL %s: cannot read %s\n", name, (golden == NULL) ? goldenPath : outputPath);
+    if (golden != NULL) fclose(golden);
+    if (output != NULL) fclose(output);
+    return false;
+  }
+
+  char expected[128];
+  char actual[128];
+  bool same = true;
+  for (long line = 1; same; line++) {
+    const bool hasExpected = fgets(expected, sizeof(expected), golden) != NULL;
+    const bool hasActual = fgets(actual, sizeof(actual), output) != NULL;
+    if (!hasExpected && !hasActual) break;
+    if (!hasExpected || !hasActual || strcmp(expected, actual) != 0) {
+      fprintf(stderr, "FAIL %s: first difference at line %ld\n", name, line);
+      fprintf(stderr, "  expected: %s", hasExpected ? expected : "(end of file)\n");
+      fprintf(stderr, "  actual:   %s", hasActual ? actual : "(end of file)\n");
+      same = false;
+    }
+  }
+
+  fclose(golden);
+  fclose(output);
+  return same;
+}
+
+/*
+  runScenarioProcess
+
+  Body of one child process: record the scenario, then compare or update its golden file.
+  Returns the child's exit status.
+*/
+static int runScenarioProcess(const Scenario* scenario, const char* goldenDir,
+                              const char* outputDir, bool updateGolden) {
+  char goldenPath[512];
+  char outputPath[512];
+  snprintf(goldenPath, sizeof(goldenPath), "%s/%s.txt", goldenDir, scenario->name);
+  snprintf(outputPath, sizeof(outputPath), "%s/%s.txt", updateGolden ? goldenDir : outputDir,
+           scenario->name);
+
+  FILE* out = fopen(outputPath, "w");
+  if (out == NULL) {
+    fprintf(stderr, "FAIL %s: cannot write %s\n", scenario->name, outputPath);
+    return 2;
+  }
+  recordScenario(scenario, out);
+  if (fclose(out) != 0) {
+    fprintf(stderr, "FAIL %s: cannot write %s\n", scenario->name, outputPath);
+    return 2;
+  }
+
+  if (updateGolden) {
+    printf("updated %s (%d ticks)\n", scenario->name, scenario->ticks);
+    return 0;
+  }
+  if (!compareWithGolden(scenario->name, goldenPath, outputPath)) return 1;
+  printf("ok      %s (%d ticks)\n", scenario->name, scenario->ticks);
+  return 0;
+}
+
+/*
+  nowSeconds
+
+  Monotonic wall-clock time in seconds.
+*/
+static double nowSeconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <golden_dir> <output_dir> [scenario...]\n", argv[0]);
+    return 2;
+  }
+  const char* goldenDir = argv[1];
+  const char* outputDir = argv[2];
+  const char* update = getenv("UPDATE_GOLDEN");
+  const bool updateGolden = (update != NULL && *update != '\0' && strcmp(update, "0") != 0);
+
+  // Selected scenarios (all by default).
+  const Scenario* selected[SCENARIO_COUNT];
+  int selectedCount = 0;
+  for (int i = 0; i < SCENARIO_COUNT; i++) {
+    bool wanted = (argc == 3);
+    for (int a = 3; a < argc; a++) {
+      if (strcmp(argv[a], scenarios[i].name) == 0) wanted = true;
+    }
+    if (wanted) selected[selectedCount++] = &scenarios[i];
+  }
+  if (selectedCount == 0) {
+    fprintf(stderr, "no such scenario\n");
+    return 2;
+  }
+
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (cpus < 1) cpus = 1;
+
+  const double start = nowSeconds();
+  int failures = 0;
+  int running = 0;
+  long totalTicks = 0;
+  fflush(stdout);
+
+  for (int next = 0; next < selectedCount || running > 0;) {
+    if (next < selectedCount && running < cpus) {
+      const pid_t pid = fork();
+      if (pid == 0) {
+        // _exit() skips the stdio flush (and the parent's atexit handlers), so flush the
+        // scenario's report first; stdout is fully buffered when it is a pipe or a file.
+        const int status = runScenarioProcess(selected[next], goldenDir, outputDir, updateGolden);
+        fflush(stdout);
+        _exit(status);
+      }
+      if (pid < 0) {
+        fprintf(stderr, "FAIL %s: fork failed\n", selected[next]->name);
+        failures++;
+      } else {
+        running++;
+      }
+      totalTicks += selected[next]->ticks;
+      next++;
+      continue;
+    }
+
+    int status = 0;
+    if (wait(&status) < 0) break;
+    running--;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failures++;
+  }
+
+  const double elapsed = nowSeconds() - start;
+  printf("golden frames: %d scenario(s), %ld ticks, %d failure(s), %.3f s (%.0f ticks/s)\n",
+         selectedCount, totalTicks, failures, elapsed, (double)totalTicks / elapsed);
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/*
+  hw_adc_test.c
+
+  What this file does
+  -------------------
+  Host test of the STM32 joystick input driver in hardware/panel_hw.c, built against the
+  libopencm3 mock in hardware/mock instead of a board.
+
+  1) Driver checks. After setupInput():
+     - default build: ADC1 must be scanning channels 1, 2, 6 and 7 continuously with DMA1
+       channel 1 copying the results into memory; getRawInput() must return each channel's
+       latest scanned value (following changes, across DMA wrap-around) without a single
+       adc_eoc() poll.
+     - PANEL_HW_ADC_POLLED build: getRawInput() must return the value of whichever channel it
+       asks for, one blocking conversion per call.
+  2) Game run. src/game.c runs on the hardware backend for a few hundred ticks with both sticks
+     pushed up (which must leave the start screen) and then held apart (which must put the
+     paddles at opposite ends). The ADC completes one scan between ticks, as the continuous scan
+     would many times over on the board.
+
+  It then prints what the input path cost per tick: conversions, adc_eoc() polls and the ADC
+  clocks (and microseconds at the reset 8 MHz clock) the CPU spent waiting for conversions.
+  `make test-hw` runs both builds, so the two sets of numbers can be compared directly.
+
+  Usage:
+    hw_adc_test [ticks]
+*/
+
+#include "libopencm3_mock.h"
+#include "panel.h"
+#include "game.h"
+#include "test_support.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TICKS 600
+
+extern int gameMode;
+extern int lPaddleY;
+extern int rPaddleY;
+
+/*
+  setJoysticks
+
+  Put each stick's reading on its "up" channel (1 or 6) with the "down" channel at 0, the way
+  getRawPaddleInput() expects a deflected stick.
+*/
+static void setJoysticks(uint32_t left, uint32_t right) {
+  mockAdcSetChannel(1, left);
+  mockAdcSetChannel(2, 0);
+  mockAdcSetChannel(6, right);
+  mockAdcSetChannel(7, 0);
+}
+
+/*
+  scanInputs
+
+  Let the ADC finish one scan of its sequence (nothing to do for the polled driver, which
+  converts on demand).
+*/
+static void scanInputs(void) {
+#ifndef PANEL_HW_ADC_POLLED
+  CHECK(mockAdcRunSequences(ADC1, 1));
+#endif
+}
+
+static void testDriver(void) {
+  mockReset();
+  setupInput();
+  CHECK(mockRccEnabled(RCC_ADC12));
+
+#ifndef PANEL_HW_ADC_POLLED
+  uint8_t sequence[16];
+  const int length = mockAdcSequence(ADC1, sequence, 16);
+  CHECK(mockRccEnabled(RCC_DMA1));
+  CHECK(mockAdcIsContinuous(ADC1));
+  CHECK(length == 4 && sequence[0] == 1 && sequence[1] == 2 && sequence[2] == 6 && sequence[3] == 7);
+
+  // Nothing has been converted yet.
+  CHECK(getRawInput(1) == 0 && getRawInput(7) == 0);
+#endif
+
+  mockAdcSetChannel(1, 101);
+  mockAdcSetChannel(2, 202);
+  mockAdcSetChannel(3, 303);
+  mockAdcSetChannel(6, 606);
+  mockAdcSetChannel(7, 707);
+  scanInputs();
+  CHECK(getRawInput(1) == 101);
+  CHECK(getRawInput(2) == 202);
+  CHECK(getRawInput(6) == 606);
+  CHECK(getRawInput(7) == 707);
+#ifndef PANEL_HW_ADC_POLLED
+  CHECK(getRawInput(3) == 0); // not a joystick channel, not scanned
+#else
+  CHECK(getRawInput(3) == 303);
+#endif
+
+  // New values after several more scans: the circular DMA keeps each channel in its slot.
+  mockAdcSetChannel(1, 4095);
+  mockAdcSetChannel(7, 1);
+#ifndef PANEL_HW_ADC_POLLED
+  CHECK(mockAdcRunSequences(ADC1, 3));
+  CHECK(mockDmaRemaining(DMA1, DMA_CHANNEL1) == 4);
+#endif
+  CHECK(getRawInput(1) == 4095);
+  CHECK(getRawInput(2) == 202);
+  CHECK(getRawInput(6) == 606);
+  CHECK(getRawInput(7) == 1);
+
+#ifndef PANEL_HW_ADC_POLLED
+  CHECK(mockAdcStats()->eocPolls == 0);
+  CHECK(mockAdcStats()->busyWaitClocks == 0);
+#else
+  CHECK(mockAdcStats()->blockingReads == 9);
+#endif
+}
+
+static void testGame(int ticks) {
+  mockReset();
+  game_setup();
+
+  int startedAt = -1;
+  for (int tick = 0; tick < ticks; tick++) {
+    if (tick < ticks / 2) {
+      setJoysticks(JOYSTICK_RAW_TOP, JOYSTICK_RAW_TOP);
+    } else {
+      setJoysticks(JOYSTICK_RAW_TOP, JOYSTICK_RAW_BOTTOM);
+    }
+    scanInputs();
+    game_tick();
+    if (startedAt < 0 && gameMode != 0) startedAt = tick;
+  }
+
+  CHECK(startedAt >= 0);
+  CHECK(lPaddleY < rPaddleY);
+
+  const MockAdcStats* stats = mockAdcStats();
+  const double clocksPerUs = (double)rcc_ahb_frequency / 1e6; // ADC clocked at HCLK / 1
+  printf("adc.driver %s\n",
+#ifdef PANEL_HW_ADC_POLLED
+         "polled"
+#else
+         "dma_scan"
+#endif
+  );
+  printf("adc.ticks %d\n", ticks);
+  printf("adc.started_at_tick %d\n", startedAt);
+  printf("adc.conversions_per_tick %.2f\n", (double)stats->conversions / ticks);
+  printf("adc.eoc_polls_per_tick %.2f\n", (double)stats->eocPolls / ticks);
+  printf("adc.busy_wait_clocks_per_tick %.1f\n", (double)stats->busyWaitClocks / ticks);
+  printf("adc.busy_wait_us_per_tick %.2f\n", (double)stats->busyWaitClocks / ticks / clocksPerUs);
+}
+
+int main(int argc, char** argv) {
+  const int ticks = testTicksArgument(argc, argv, DEFAULT_TICKS);
+  if (ticks <= 0) return 2;
+
+  testDriver();
+  testGame(ticks);
+
+  return testExitStatus("hw_adc_test");
+}
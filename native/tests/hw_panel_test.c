@@ -0,0 +1,203 @@
+/*
+  hw_panel_test.c
+
+  What this file does
+  -------------------
+  Host test of the STM32 panel driver (hardware/panel_hw.c) against the libopencm3 mock's
+  pin-level panel model, which decodes the clock, latch, data and address pins into a 32x32
+  framebuffer (see hardware/mock/libopencm3_mock.h).
+
+  1) Decoding. Known payloads are shifted into every row-pair with PushRow() (and, for one row,
+     PushBit()) and latched; the model's pixels must match the payload bits in the PANEL_ROW_WORDS
+     layout.
+  2) Timing. delay_us() must spin for its time in DWT cycles at the CPU clock (rcc_ahb_frequency),
+     at the reset clock and at 72 MHz, and now_us() must advance with it.
+  3) Game run. src/game.c plays for a few hundred ticks. The model's clock edges, latches and
+     complete frames must agree with the HAL counters (hal_stats.h), and the GPIO register writes
+     per frame are printed, so a driver change can be measured without a board. `make test-hw`
+     builds this file with the out-of-line primitives and with PANEL_HW_INLINE.
+
+  The frames themselves are compared with the native backend's by tests/determinism.c built with
+  -DDETERMINISM_HW.
+
+  Usage:
+    hw_panel_test [ticks]
+*/
+
+#include "libopencm3_mock.h"
+#include "panel.h"
+#include "game.h"
+#include "hal_stats.h"
+#include "panel_hw_inline.h" // pin map
+#include "test_support.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TICKS 400
+
+/*
+  resetWithPanel
+
+  Reset the mock with the panel model wired to panel_hw.c's pins; row-pair i is selected with
+  SelectRow(i + 1), as in the game.
+*/
+static void resetWithPanel(void) {
+  const MockPanelWiring wiring = {
+    .port = LEDPANEL_PORT,
+    .addressPins = {A_PIN, B_PIN, C_PIN, D_PIN},
+    .clockPin = CLK_PIN,
+    .latchPin = LAT_PIN,
+    .dataPin = INP_PIN,
+    .rowOffset = 1,
+#ifdef PANEL_PARALLEL_SHIFT
+    .parallel = true,
+#endif
+    .dataPort = DATA_PORT,
+    .dataShift = DATA_PIN_SHIFT,
+  };
+  mockReset();
+  mockPanelAttach(&wiring);
+}
+
+/*
+  expectedPixel
+
+  Colour of pixel x in row-pair half `half` (0 top, 1 bottom) for a payload.
+*/
+static uint8_t expectedPixel(const uint32_t payload[PANEL_ROW_WORDS], int half, int x) {
+  uint8_t rgb = 0;
+  for (int plane = 0; plane < 3; plane++) {
+    rgb |= (uint8_t)(((payload[3 * half + plane] >> x) & 1u) << plane);
+  }
+  return rgb;
+}
+
+static void testDecoding(void) {
+  resetWithPanel();
+  setupPanel();
+
+  uint32_t payload[PANEL_ROW_WORDS];
+  for (int pair = 0; pair < 16; pair++) {
+    for (int w = 0; w < PANEL_ROW_WORDS; w++) {
+      payload[w] = 0x9E3779B9u * (uint32_t)(pair * PANEL_ROW_WORDS + w + 1);
+    }
+    PrepareLatch();
+    SelectRow(pair + 1);
+    if (pair == 5) {
+      // the compatibility path: 192 single bits in payload order
+      for (int bit = 0; bit < 192; bit++) PushBit((payload[bit / 32] >> (bit % 32)) & 1u);
+    } else {
+      PushRow(payload);
+    }
+    LatchRegister();
+
+    int mismatches = 0;
+    for (int x = 0; x < 32; x++) {
+      if (mockPanelPixel(x, pair) != expectedPixel(payload, 0, x)) mismatches++;
+      if (mockPanelPixel(x, pair + 16) != expectedPixel(payload, 1, x)) mismatches++;
+    }
+#ifdef PANEL_PARALLEL_SHIFT
+    // PushBit() puts its bit on all six lines: only the all-ones/all-zeros columns survive
+    if (pair == 5) continue;
+#endif
+    CHECK(mismatches == 0);
+  }
+  CHECK(mockPanelStats()->scans == 1);
+
+  // Shifting without a latch leaves the frame alone; ClearRow() + latch blanks one row-pair.
+  uint8_t before[32];
+  for (int x = 0; x < 32; x++) before[x] = mockPanelPixel(x, 2);
+  ClearRow(3);
+  for (int x = 0; x < 32; x++) CHECK(mockPanelPixel(x, 2) == before[x]);
+  PrepareLatch();
+  LatchRegister();
+  for (int x = 0; x < 32; x++) {
+    CHECK(mockPanelPixel(x, 2) == 0 && mockPanelPixel(x, 18) == 0);
+  }
+}
+
+/*
+  checkDelayCycles
+
+  delay_us(us) at `ahbHz` must take us microseconds of cycles, give or take a few polls of the
+  counter, and advance now_us() by at least us.
+*/
+static void checkDelayCycles(uint32_t ahbHz, uint32_t us) {
+  rcc_ahb_frequency = ahbHz;
+  const uint32_t cyclesPerUs = ahbHz / 1000000u;
+  const uint32_t nowBefore = now_us();
+  const uint32_t cyclesBefore = dwt_read_cycle_counter();
+  delay_us(us);
+  const uint32_t cycles = dwt_read_cycle_counter() - cyclesBefore;
+  const uint32_t elapsedUs = now_us() - nowBefore;
+
+  CHECK(cycles >= us * cyclesPerUs - cyclesPerUs);
+  CHECK(cycles <= us * cyclesPerUs + 4 * MOCK_DWT_CYCLES_PER_READ + cyclesPerUs);
+  CHECK(elapsedUs >= us && elapsedUs <= us + 1 + (4 * MOCK_DWT_CYCLES_PER_READ) / cyclesPerUs);
+}
+
+static void testTiming(void) {
+  resetWithPanel();
+  setupPanel();
+
+  checkDelayCycles(8000000u, 1000);
+  checkDelayCycles(72000000u, 1000);
+  checkDelayCycles(72000000u, 3);
+  CHECK(halStats.delayCalls == 3);
+  CHECK(halStats.delayUs == 2003);
+
+  // delay_ms() is whole milliseconds of delay_us()
+  const uint32_t nowBefore = now_us();
+  delay_ms(2);
+  CHECK(now_us() - nowBefore >= 2000);
+  CHECK(halStats.delayUs == 4003);
+  rcc_ahb_frequency = 8000000u;
+}
+
+static void testGame(int ticks) {
+  resetWithPanel();
+  game_setup();
+
+  const uint64_t writesBefore = mockPanelStats()->gpioWrites;
+  for (int tick = 0; tick < ticks; tick++) {
+    mockAdcSetChannel(1, 555);
+    mockAdcSetChannel(6, (tick < ticks / 2) ? 555 : 0);
+    mockAdcRunSequences(ADC1, 1); // does nothing for the polled driver
+    game_tick();
+  }
+
+  const MockPanelStats* panelStats = mockPanelStats();
+  CHECK(panelStats->clockEdges == halStats.shiftClocks);
+  CHECK(panelStats->latches == halStats.latches);
+  CHECK(panelStats->scans == halStats.scans);
+  CHECK(panelStats->scans > 0);
+
+  const double scans = (double)panelStats->scans;
+  const double writes = (double)(panelStats->gpioWrites - writesBefore);
+  printf("panel.driver %s\n",
+#ifdef PANEL_HW_INLINE
+         "inline"
+#else
+         "out_of_line"
+#endif
+  );
+  printf("panel.ticks %d\n", ticks);
+  printf("panel.scans %llu\n", (unsigned long long)panelStats->scans);
+  printf("panel.clock_edges_per_scan %.1f\n", (double)panelStats->clockEdges / scans);
+  printf("panel.latches_per_scan %.1f\n", (double)panelStats->latches / scans);
+  printf("panel.gpio_writes_per_scan %.1f\n", writes / scans);
+  printf("panel.gpio_writes_per_bit %.3f\n", writes / (double)halStats.bitsShifted);
+}
+
+int main(int argc, char** argv) {
+  const int ticks = testTicksArgument(argc, argv, DEFAULT_TICKS);
+  if (ticks <= 0) return 2;
+
+  testDecoding();
+  testTiming();
+  testGame(ticks);
+
+  return testExitStatus("hw_panel_test");
+}
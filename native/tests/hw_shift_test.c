@@ -0,0 +1,134 @@
+/*
+  hw_shift_test.c
+
+  What this file does
+  -------------------
+  Host test of the STM32 panel output path in hardware/panel_hw.c, built against the libopencm3
+  mock in hardware/mock. `make test-hw` builds it twice: with the out-of-line primitives, and with
+  -DPANEL_HW_INLINE so that this file and src/game.c call the register-store versions in
+  hardware/panel_hw_inline.h. Both builds must print the same transcript:
+
+  1) Primitives. Every row address, data level, latch and output-enable call, followed by the
+     panel port's output pins (and the data port's in PANEL_PARALLEL_SHIFT builds). SelectRow()
+     is also checked directly against the A..D pins.
+  2) Game run. src/game.c plays for a few hundred ticks; the HAL counters and the final pin
+     levels are printed.
+
+  Both builds also compile setupPanel()'s PANEL_HW_SHIFT_TIMING measurement, which must leave the
+  HAL counters at zero (the mock's cycle counter does not move, so its cycle counts are not
+  printed).
+
+  Usage:
+    hw_shift_test [ticks]
+*/
+
+#include "libopencm3_mock.h"
+#include "panel.h"
+#include "game.h"
+#include "hal_stats.h"
+#include "test_support.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TICKS 400
+
+// Panel pins as wired in hardware/panel_hw_inline.h (GPIOC 2..9, parallel data on GPIOB 0..5).
+#define ROW_ADDRESS_SHIFT 2
+#define ROW_ADDRESS_MASK 0x0Fu
+
+extern HalStats halStats;
+
+/*
+  printPins
+
+  One transcript line: what was called, then the output register of the panel port (and of the
+  data port when the data lines are parallel).
+*/
+static void printPins(const char* call) {
+  mockGpioFlush();
+#ifdef PANEL_PARALLEL_SHIFT
+  printf("%-20s panel=%04x data=%04x\n", call, mockGpioOutput(GPIOC), mockGpioOutput(GPIOB));
+#else
+  printf("%-20s panel=%04x\n", call, mockGpioOutput(GPIOC));
+#endif
+}
+
+static void testPrimitives(void) {
+  static const uint32_t payload[PANEL_ROW_WORDS] = {0x80000001u, 0x00000000u, 0xFFFFFFFFu,
+                                                     0x12345678u, 0x0000FFFFu, 0xA5A5A5A5u};
+  char call[32];
+
+  mockReset();
+  setupPanel();
+  CHECK(halStats.pushBitCalls == 0 && halStats.pushRowCalls == 0 && halStats.bitsShifted == 0);
+  printPins("setupPanel()");
+
+  for (int row = 1; row <= 16; row++) {
+    SelectRow(row);
+    snprintf(call, sizeof call, "SelectRow(%d)", row);
+    printPins(call);
+    CHECK(((mockGpioOutput(GPIOC) >> ROW_ADDRESS_SHIFT) & ROW_ADDRESS_MASK) == ((unsigned)row & ROW_ADDRESS_MASK));
+  }
+
+  PrepareLatch();
+  printPins("PrepareLatch()");
+  for (int i = 0; i < 4; i++) {
+    const int bit = (0x6 >> i) & 1; // 0, 1, 1, 0
+    PushBit(bit);
+    snprintf(call, sizeof call, "PushBit(%d)", bit);
+    printPins(call);
+  }
+  PushRow(payload);
+  printPins("PushRow()");
+#ifdef PANEL_PARALLEL_SHIFT
+  PushColumn(PANEL_COLUMN_R1 | PANEL_COLUMN_B2);
+  printPins("PushColumn(0x21)");
+#endif
+  SetOutputEnable(false);
+  printPins("SetOutputEnable(0)");
+  LatchRegister();
+  printPins("LatchRegister()");
+  SetOutputEnable(true);
+  printPins("SetOutputEnable(1)");
+  ClearRow(7);
+  printPins("ClearRow(7)");
+  CHECK(((mockGpioOutput(GPIOC) >> ROW_ADDRESS_SHIFT) & ROW_ADDRESS_MASK) == 7u);
+
+  printf("primitives.bits_shifted %llu\n", (unsigned long long)halStats.bitsShifted);
+  printf("primitives.shift_clocks %llu\n", (unsigned long long)halStats.shiftClocks);
+}
+
+static void testGame(int ticks) {
+  mockReset();
+  game_setup();
+  for (int tick = 0; tick < ticks; tick++) {
+    mockAdcSetChannel(1, 555);
+    mockAdcSetChannel(6, (tick < ticks / 2) ? 555 : 0);
+#ifndef PANEL_HW_ADC_POLLED
+    mockAdcRunSequences(ADC1, 1);
+#endif
+    game_tick();
+  }
+
+  printf("game.ticks %d\n", ticks);
+  printf("game.push_row_calls %llu\n", (unsigned long long)halStats.pushRowCalls);
+  printf("game.clear_row_calls %llu\n", (unsigned long long)halStats.clearRowCalls);
+  printf("game.select_row_calls %llu\n", (unsigned long long)halStats.selectRowCalls);
+  printf("game.latches %llu\n", (unsigned long long)halStats.latches);
+  printf("game.bits_shifted %llu\n", (unsigned long long)halStats.bitsShifted);
+  printf("game.scans %llu\n", (unsigned long long)halStats.scans);
+  printPins("game end");
+  CHECK(halStats.scans > 0);
+}
+
+int main(int argc, char** argv) {
+  const int ticks = testTicksArgument(argc, argv, DEFAULT_TICKS);
+  if (ticks <= 0) return 2;
+
+  testPrimitives();
+  testGame(ticks);
+
+  return testExitStatus("hw_shift_test");
+}
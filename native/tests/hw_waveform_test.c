@@ -0,0 +1,163 @@
+/*
+  hw_waveform_test.c
+
+  What this file does
+  -------------------
+  Host test of the BSRR waveform generator (hardware/panel_waveform.h) and of panel_hw.c's
+  PANEL_HW_DMA_SHIFT driver, which plays the generated words to the panel port with
+  timer-triggered DMA, against the libopencm3 mock's pin-level panel model.
+
+  1) Slots. For every row-pair, random gameMatrix rows are packed with game.c's displayRow() and
+     turned into one slot waveform (panelWaveformBuildSlot()). The words are stored to the panel
+     port's BSRR one by one: the model must then show the two matrix rows bit for bit at that
+     row-pair, and the output must have been blanked (OE high) whenever the address changed and
+     at the latch.
+  2) Game run. src/game.c plays for a few hundred ticks on the DMA driver. The model's clock
+     edges, latches and frames must agree with the HAL counters, every panel GPIO store must have
+     been made by the DMA (none by the CPU), and the stores per frame are printed.
+
+  The frames themselves are compared with the golden trace by tests/determinism.c built with
+  -DDETERMINISM_HW -DPANEL_HW_DMA_SHIFT.
+
+  Usage:
+    hw_waveform_test [ticks]
+*/
+
+#include "libopencm3_mock.h"
+#include "panel.h"
+#include "game.h"
+#include "hal_stats.h"
+#include "panel_waveform.h" // pin map and the generator
+#include "test_support.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_TICKS 400
+
+// Defined in src/game.c.
+void displayRow(const uint32_t matrixRow[3], uint32_t planes[3]);
+
+#define ADDRESS_PINS (A_PIN | B_PIN | C_PIN | D_PIN)
+
+static uint32_t randomState = 0x9E3779B9u;
+
+static uint32_t nextRandom(void) {
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+/*
+  resetWithPanel
+
+  Reset the mock with the panel model wired to panel_hw.c's serial pins; row-pair i is selected
+  with SelectRow(i + 1), as in the game.
+*/
+static void resetWithPanel(void) {
+  const MockPanelWiring wiring = {
+    .port = LEDPANEL_PORT,
+    .addressPins = {A_PIN, B_PIN, C_PIN, D_PIN},
+    .clockPin = CLK_PIN,
+    .latchPin = LAT_PIN,
+    .dataPin = INP_PIN,
+    .rowOffset = 1,
+  };
+  mockReset();
+  mockPanelAttach(&wiring);
+}
+
+/*
+  matrixPixel
+
+  Colour of pixel x in a gameMatrix row (three plane words, pixel x in bit x).
+*/
+static uint8_t matrixPixel(const uint32_t row[3], int x) {
+  return (uint8_t)(((row[0] >> x) & 1u) | (((row[1] >> x) & 1u) << 1) | (((row[2] >> x) & 1u) << 2));
+}
+
+static void testSlots(void) {
+  resetWithPanel();
+
+  uint32_t words[PANEL_WAVEFORM_SLOT_WORDS];
+  for (int pair = 0; pair < 16; pair++) {
+    uint32_t top[3], bottom[3], payload[PANEL_ROW_WORDS];
+    for (int plane = 0; plane < 3; plane++) {
+      top[plane] = nextRandom();
+      bottom[plane] = nextRandom();
+    }
+    displayRow(top, &payload[0]);
+    displayRow(bottom, &payload[3]);
+
+    PanelWaveform waveform = {words, 0, PANEL_WAVEFORM_SLOT_WORDS};
+    panelWaveformBuildSlot(&waveform, pair + 1, payload);
+    CHECK(waveform.length == PANEL_WAVEFORM_SLOT_WORDS);
+
+    // play the words, watching the output enable around address changes and the latch edge
+    int unblankedChanges = 0;
+    for (uint32_t w = 0; w < waveform.length; w++) {
+      const uint16_t before = mockGpioOutput(LEDPANEL_PORT);
+      GPIO_BSRR(LEDPANEL_PORT) = words[w];
+      const uint16_t after = mockGpioOutput(LEDPANEL_PORT); // flushes the store
+      const bool blanked = (after & OE_PIN) != 0;
+      const bool addressChanged = ((before ^ after) & ADDRESS_PINS) != 0;
+      const bool latched = !(before & LAT_PIN) && (after & LAT_PIN);
+      if ((addressChanged || latched) && !blanked) unblankedChanges++;
+    }
+    CHECK(unblankedChanges == 0);
+    CHECK((mockGpioOutput(LEDPANEL_PORT) & OE_PIN) == 0); // lit again after the slot
+
+    int mismatches = 0;
+    for (int x = 0; x < 32; x++) {
+      if (mockPanelPixel(x, pair) != matrixPixel(top, x)) mismatches++;
+      if (mockPanelPixel(x, pair + 16) != matrixPixel(bottom, x)) mismatches++;
+    }
+    CHECK(mismatches == 0);
+  }
+  CHECK(mockPanelStats()->scans == 1);
+  CHECK(mockPanelStats()->clockEdges == 16 * 192);
+}
+
+static void testGame(int ticks) {
+  resetWithPanel();
+  game_setup();
+
+  const MockPanelStats* panelStats = mockPanelStats();
+  const uint64_t writesBefore = panelStats->gpioWrites;
+  const uint64_t dmaWritesBefore = panelStats->dmaGpioWrites;
+  for (int tick = 0; tick < ticks; tick++) {
+    mockAdcSetChannel(1, 555);
+    mockAdcSetChannel(6, (tick < ticks / 2) ? 555 : 0);
+    mockAdcRunSequences(ADC1, 1);
+    game_tick();
+  }
+
+  panelStats = mockPanelStats();
+  CHECK(panelStats->clockEdges == halStats.shiftClocks);
+  CHECK(panelStats->latches == halStats.latches);
+  CHECK(panelStats->scans == halStats.scans);
+  CHECK(panelStats->scans > 0);
+
+  const double scans = (double)panelStats->scans;
+  const uint64_t dmaWrites = panelStats->dmaGpioWrites - dmaWritesBefore;
+  const uint64_t cpuWrites = (panelStats->gpioWrites - writesBefore) - dmaWrites;
+  CHECK(cpuWrites == 0);
+
+  printf("waveform.slot_words %d\n", PANEL_WAVEFORM_SLOT_WORDS);
+  printf("waveform.ticks %d\n", ticks);
+  printf("waveform.scans %llu\n", (unsigned long long)panelStats->scans);
+  printf("waveform.dma_gpio_writes_per_scan %.1f\n", (double)dmaWrites / scans);
+  printf("waveform.cpu_gpio_writes_per_scan %.1f\n", (double)cpuWrites / scans);
+}
+
+int main(int argc, char** argv) {
+  const int ticks = testTicksArgument(argc, argv, DEFAULT_TICKS);
+  if (ticks <= 0) return 2;
+
+  testSlots();
+  testGame(ticks);
+
+  return testExitStatus("hw_waveform_test");
+}
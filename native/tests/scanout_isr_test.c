@@ -0,0 +1,181 @@
+/*
+  scanout_isr_test.c
+
+  What this file does
+  -------------------
+  Tearing test for the GAME_SCANOUT_ISR scan. src/game.c is built with -DGAME_SCANOUT_ISR against
+  panel_native.c, whose scan timer is a POSIX interval timer: the SIGALRM handler runs the game's
+  scan handler (scanoutIsr) wherever the game happens to be, as the STM32's TIM2 interrupt would,
+  while game_tick() redraws gameMatrix and rebuilds the back page.
+
+  1) Every completed scan is hashed from the latched frame (panelNativeGetPixel) inside the
+     signal handler, via panelNativeSetScanHook().
+  2) After every tick the frame the game flipped to is hashed from gameMatrix, and the latched
+     frame must already be that frame (updateDisplay() waits for full scans of the new page).
+  3) At the end, every scan seen by the handler must be one of the flipped frames (or the blank
+     page shown before the first flip). A scan that mixed two pages, or read a page while the
+     game was writing it, would show a frame that was never flipped.
+
+  The run must also have been preempted by the timer, or the test proves nothing.
+
+  Usage:
+    scanout_isr_test [ticks]
+*/
+
+#include "panel.h"
+#include "game.h"
+#include "panel_native.h"
+#include "test_support.h"
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef colourDepth
+#define colourDepth 1 // as in game.c
+#endif
+
+#define DEFAULT_TICKS 1500
+
+extern int gameMode;
+extern uint32_t gameMatrix[32][colourDepth][3];
+
+// Distinct consecutive scan hashes seen by the scan hook (written in the signal handler).
+#define MAX_SCAN_FRAMES 16384
+static uint64_t scanFrames[MAX_SCAN_FRAMES];
+static volatile sig_atomic_t scanFrameCount = 0;
+static volatile sig_atomic_t scanFramesOverflowed = 0;
+static volatile uint64_t scansSeen = 0;
+
+static int tick = 0;
+
+/*
+  fnv1a
+
+  Fold one byte into a 64-bit FNV-1a hash.
+*/
+static uint64_t fnv1a(uint64_t hash, uint8_t byte) {
+  return (hash ^ byte) * 1099511628211ull;
+}
+
+static uint64_t latchedFrameHash(void) {
+  uint64_t hash = 1469598103934665603ull;
+  for (int y = 0; y < 32; y++) {
+    for (int x = 0; x < 32; x++) hash = fnv1a(hash, panelNativeGetPixel(x, y));
+  }
+  return hash;
+}
+
+/*
+  flippedFrameHash
+
+  The frame the last tick flipped to, from gameMatrix: pixel (x, y) as panelNativeGetPixel()
+  returns it after a scan, i.e. the last latched (most significant) intensity bit of each plane.
+*/
+static uint64_t flippedFrameHash(void) {
+  uint64_t hash = 1469598103934665603ull;
+  for (int y = 0; y < 32; y++) {
+    const uint32_t* planes = gameMatrix[y][colourDepth - 1];
+    for (int x = 0; x < 32; x++) {
+      uint8_t rgb = 0;
+      for (int plane = 0; plane < 3; plane++) rgb |= (uint8_t)(((planes[plane] >> x) & 1u) << plane);
+      hash = fnv1a(hash, rgb);
+    }
+  }
+  return hash;
+}
+
+/*
+  onScan
+
+  Scan hook, run in the scan timer's signal handler once the last row-pair of a scan is latched.
+*/
+static void onScan(void) {
+  scansSeen++;
+  const uint64_t hash = latchedFrameHash();
+  const int count = scanFrameCount;
+  if (count > 0 && scanFrames[count - 1] == hash) return;
+  if (count == MAX_SCAN_FRAMES) {
+    scanFramesOverflowed = 1;
+    return;
+  }
+  scanFrames[count] = hash;
+  scanFrameCount = count + 1;
+}
+
+/*
+  scriptedInput
+
+  Both sticks up to leave the start screen, then the right stick swept between its ends so the
+  paddles and the ball keep changing the frame.
+*/
+static uint32_t scriptedInput(int channel) {
+  switch (channel) {
+    case 1: return JOYSTICK_RAW_TOP;
+    case 6: return ((tick / 40) % 2 == 0) ? JOYSTICK_RAW_TOP : JOYSTICK_RAW_BOTTOM;
+    default: return 0;
+  }
+}
+
+static int compareHashes(const void* a, const void* b) {
+  const uint64_t x = *(const uint64_t*)a;
+  const uint64_t y = *(const uint64_t*)b;
+  return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv) {
+  const int ticks = testTicksArgument(argc, argv, DEFAULT_TICKS);
+  if (ticks <= 0) return 2;
+
+  // Flipped frames, plus the blank page scanned before the first flip.
+  uint64_t* flipped = malloc(sizeof(uint64_t) * (size_t)(ticks + 1));
+  if (flipped == NULL) return 2;
+  int flippedCount = 0;
+
+  panelNativeSetInputHook(scriptedInput);
+  panelNativeSetScanHook(onScan);
+  game_setup();
+  flipped[flippedCount++] = latchedFrameHash();
+
+  int lateFlips = 0;
+  bool started = false;
+  for (tick = 0; tick < ticks; tick++) {
+    game_tick();
+    const uint64_t hash = flippedFrameHash();
+    flipped[flippedCount++] = hash;
+    if (latchedFrameHash() != hash) lateFlips++;
+    if (gameMode != 0) started = true;
+  }
+  panelNativeSetScanHook(NULL);
+
+  CHECK(started);
+  CHECK(lateFlips == 0);
+  CHECK(!scanFramesOverflowed);
+
+  qsort(flipped, (size_t)flippedCount, sizeof(uint64_t), compareHashes);
+  int tornScans = 0;
+  const int scanFrameTotal = scanFrameCount;
+  for (int i = 0; i < scanFrameTotal; i++) {
+    if (bsearch(&scanFrames[i], flipped, (size_t)flippedCount, sizeof(uint64_t), compareHashes) == NULL) {
+      tornScans++;
+    }
+  }
+  CHECK(tornScans == 0);
+
+  const PanelNativeTimerStats* timer = panelNativeTimerStats();
+  CHECK(timer->preemptions > 0);
+  CHECK(scansSeen >= (uint64_t)ticks);
+
+  printf("scanout_isr.ticks %d\n", ticks);
+  printf("scanout_isr.scans %llu\n", (unsigned long long)scansSeen);
+  printf("scanout_isr.distinct_scan_frames %d\n", scanFrameTotal);
+  printf("scanout_isr.torn_scans %d\n", tornScans);
+  printf("scanout_isr.late_flips %d\n", lateFlips);
+  printf("scanout_isr.timer_interrupts %llu\n", (unsigned long long)timer->interrupts);
+  printf("scanout_isr.timer_preemptions %llu\n", (unsigned long long)timer->preemptions);
+
+  free(flipped);
+  return testExitStatus("scanout_isr_test");
+}
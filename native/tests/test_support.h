@@ -0,0 +1,91 @@
+/*
+  test_support.h
+
+  What this file does
+  -------------------
+  Scaffolding shared by the host test programs in native/tests (and the scripted input of
+  src/scanout_bench.c):
+
+  - the raw joystick readings game.c expects and paddleYToRaw(), which turns a paddle position
+    into the reading that puts the paddle there;
+  - CHECK(), which reports a failed condition with its file and line and counts it without
+    stopping the test, and testExitStatus(), which turns the count into the exit status;
+  - testTicksArgument(), the optional [ticks] argument every test accepts.
+
+  Everything is static inline, so each program only pulls in what it uses.
+*/
+
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Joystick raw readings expected by game.c (same calibration as emulator.js).
+#define JOYSTICK_RAW_TOP     555
+#define JOYSTICK_RAW_BOTTOM  105
+#define JOYSTICK_RAW_CENTRE  330
+
+// Paddle travel used by game.c's convertInputToPaddlePosition.
+#define PADDLE_MAX_Y 27
+
+/*
+  paddleYToRaw
+
+  Raw reading that puts a paddle at y (integer inverse of convertInputToPaddlePosition).
+*/
+static inline uint32_t paddleYToRaw(int y) {
+  if (y < 0) y = 0;
+  if (y > PADDLE_MAX_Y) y = PADDLE_MAX_Y;
+  return (uint32_t)(JOYSTICK_RAW_TOP - (y * (JOYSTICK_RAW_TOP - JOYSTICK_RAW_BOTTOM)) / PADDLE_MAX_Y);
+}
+
+/*
+  testFailures
+
+  The program's count of failed checks.
+*/
+static inline int* testFailures(void) {
+  static int failures = 0;
+  return &failures;
+}
+
+#define CHECK(condition)                                                 \
+  do {                                                                   \
+    if (!(condition)) {                                                  \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      (*testFailures())++;                                               \
+    }                                                                    \
+  } while (0)
+
+/*
+  testExitStatus
+
+  0 when every check passed; otherwise report the number of failed checks for `program` and
+  return 1.
+*/
+static inline int testExitStatus(const char* program) {
+  if (*testFailures() != 0) {
+    fprintf(stderr, "%s: %d check(s) failed\n", program, *testFailures());
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  testTicksArgument
+
+  The optional first argument, the number of game ticks to run (`defaultTicks` when absent).
+  Prints the usage and returns 0 when it is not a positive number.
+*/
+static inline int testTicksArgument(int argc, char** argv, int defaultTicks) {
+  const int ticks = (argc > 1) ? atoi(argv[1]) : defaultTicks;
+  if (ticks <= 0) {
+    fprintf(stderr, "usage: %s [ticks]\n", argv[0]);
+    return 0;
+  }
+  return ticks;
+}
+
+#endif // TEST_SUPPORT_H
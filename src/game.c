@@ -8,30 +8,60 @@
  * High-level architecture
  * -----------------------
  * 1) Logical framebuffer (gameMatrix)
- *    - gameMatrix[y][x] stores a single character colour code for each pixel.
- *    - Colour codes used by this coursework are:
+ *    - gameMatrix[y][k][plane] stores one 32-bit mask per row, intensity bit k
+ *      (0..colourDepth-1) and colour plane (plane 0 = R, 1 = G, 2 = B); bit x
+ *      is pixel x. With the default colourDepth of 1 that is 384 bytes.
+ *    - Drawing code still speaks in character colour codes, which the small
+ *      accessor API (setPixel, getPixel, fillRowSpan, fillRect, getMatrixRow)
+ *      converts to and from the bit-planes (a lit channel is full intensity);
+ *      fillRowSpanLevels/getPixelLevel work with per-channel intensities:
  *        'X' = off/black, 'R' = red, 'G' = green, 'B' = blue,
  *        'C' = cyan, 'M' = magenta, 'Y' = yellow, 'W' = white.
  *
  * 2) Rendering model
  *    - Drawing functions (drawBorders, drawPaddle, drawBall, drawDigit, etc.)
- *      write into gameMatrix only; they do not talk to hardware directly.
- *    - updateDisplay() performs the physical refresh by scanning the panel:
+ *      write into gameMatrix only (with mask operations); they do not talk to
+ *      hardware directly. Every write marks its row-pair dirty.
+ *    - updateDisplay() first rebuilds the ready-to-shift payload of each dirty
+ *      row-pair (prepareScanout), then scans those cached payloads
+ *      scansPerTick times, so the refresh rate can be raised independently of
+ *      the game tick rate (-DrefreshRateHz=N sets the panel rate and derives
+ *      scansPerTick = N / refreshRate, so the game keeps refreshRate ticks per
+ *      second). With colourDepth > 1 each row-pair is shown once
+ *      per intensity bit with a dwell weighted by 2^k (Binary Code
+ *      Modulation). scanBlankMode selects how ghosting is suppressed
+ *      (ClearRow before each row, or output-enable blanking). Each scan:
  *        - The panel is multiplexed as two 16-row halves (top rows 0..15 and
  *          bottom rows 16..31).
  *        - For each row address i (0..15), updateDisplay shifts 192 bits:
  *            32 pixels x 3 colour planes x 2 halves = 192
- *          and then latches the data for the selected row pair (i and i+16).
+ *          and then latches the data for the selected row pair (i and i+16),
+ *          once per intensity bit.
+ *    - GAME_SCANOUT_ISR builds move the scan into a periodic timer interrupt
+ *      (startScanTimer in panel.h) that shows one row-pair slot per interrupt
+ *      from a front page of payloads. prepareScanout() fills the back page and
+ *      updateDisplay() flips the pages at the end of the tick, then waits for
+ *      scansPerTick complete scans of the new page, so the game speed is
+ *      unchanged and the panel keeps refreshing while the game logic runs.
  *    - The low-level I/O primitives (PrepareLatch, LatchRegister, SelectRow,
- *      PushBit, ClearRow, getRawInput, delay_ms, etc.) are provided by the
+ *      PushBit, PushRow, ClearRow, getRawInput, delay_us, etc.) are provided by the
  *      hardware abstraction layer declared in panel.h and implemented by:
  *        - panel_hw.c (STM32/libopencm3 target), or
- *        - panel_emu.c (web/WASM emulator target).
+ *        - panel_emu.c (web/WASM emulator target), or
+ *        - panel_native.c (native host target for benchmarks and CI).
  *
  * 3) Input model
  *    - Each paddle reads an analogue joystick via ADC channels using getRawInput.
+ *    - sampleInput() reads channels 1, 2, 6 and 7 once at the start of every
+ *      tick into inputSnapshot; all game logic reads the snapshot, never the ADC.
  *    - The raw readings are normalised between minPaddleVal/maxPaddleVal and
- *      mapped into a paddle Y position on screen.
+ *      mapped into a paddle Y position on screen (integer arithmetic).
+ *
+ * 3b) Physics
+ *    - Ball position and velocity are Q16.16 fixed point (int32_t, fixedOne =
+ *      one pixel) and collision response is integer-only, so every target
+ *      (Cortex-M4, WASM, x86) computes bit-identical frames from the same
+ *      inputs; see native/tests (make test) for the golden determinism trace.
  *
  * 4) Game state machine
  *    - gameMode controls which screen/logic runs:
@@ -40,6 +70,9 @@
  *        2: Point-won pause / serve wait
  *        3: Win screen
  *    - cycle is a coarse "tick" counter used for timing together with refreshRate.
+ *    - game_tick() (declared in game.h) runs one iteration of the state machine;
+ *      main() just calls it forever. Builds that need to own the loop (the web
+ *      emulator) define GAME_NO_MAIN and call game_tick() themselves.
  *
  * Important note on correctness
  * -----------------------------
@@ -54,6 +87,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "panel.h"
+#include "game.h"
 
 /* -----------------------------------------------------------------------------
  * Compile-time configuration constants
@@ -76,9 +110,57 @@
 #define maxPaddleVal 105
 #define minPaddleVal 555
 
-#define refreshDelay 1 // refresh rate of about 20 hz (20.8333.. not accounting for calculations)
-#define refreshRate 60 //  (1000)/(refreshDelay * 16)
+#define refreshRate 60 // ticks per second assumed by the screen timers and the ball speed; about the scan rate at the default rowDwellUs
+#ifdef refreshRateHz
+#if (refreshRateHz) % refreshRate != 0
+#error "refreshRateHz must be a multiple of refreshRate (60 ticks per second)"
+#endif
+#ifndef scansPerTick
+#define scansPerTick ((refreshRateHz) / refreshRate) // the panel scans refreshRateHz times a second, the game still ticks refreshRate times
+#elif (scansPerTick) * refreshRate != (refreshRateHz)
+#error "scansPerTick must be refreshRateHz / refreshRate, or the game speed changes with the refresh rate"
+#endif
+#endif
+#ifndef scansPerTick
+#define scansPerTick 1 // panel scans per game tick; the panel refreshes scansPerTick times as often as the game logic runs
+#endif
+#ifndef colourDepth
+#define colourDepth 1 // intensity bits per colour channel (1 = the original 8 colours); scanned with Binary Code Modulation
+#endif
+#define maxColourLevel ((1u << colourDepth) - 1u)
+#if defined(refreshRateHz) && !defined(rowDwellUs)
+#define rowDwellUs (1000000u / ((panelHeight / 2) * maxColourLevel * (refreshRateHz))) // a scan every 1 / refreshRateHz s
+#endif
+#ifndef rowDwellUs
+#define rowDwellUs 1000u // dwell of intensity bit 0 of a row-pair in us; a scan dwells 16 * maxColourLevel * rowDwellUs (62.5 Hz)
+#endif
+#if rowDwellUs < 1
+#error "refreshRateHz is too high for 16 row-pairs at this colourDepth"
+#endif
+#ifndef scanTimerHz
+#define scanTimerHz (1000000u / rowDwellUs) // GAME_SCANOUT_ISR: scan timer rate, one slot per rowDwellUs as inline
+#endif
+#ifdef GAME_SCANOUT_ISR
+#define slotDwellUs (1000000u / scanTimerHz) // dwell of intensity bit 0: one timer period
+#else
+#define slotDwellUs rowDwellUs
+#endif
+#define targetScanUs ((panelHeight / 2) * maxColourLevel * slotDwellUs) // refresh period the scan is scheduled for
+#ifdef GAME_SCANOUT_ISR
+#define scanoutPages 2 // payload pages: the one the scan timer shows and the one the game fills
+#else
+#define scanoutPages 1
+#endif
+#define scanBlankClearRow 0     // ghost suppression by shifting a row of zeros (ClearRow) before each row
+#define scanBlankOutputEnable 1 // ghost suppression by blanking with OE around address change and latch
+#ifndef scanBlankMode
+#define scanBlankMode scanBlankClearRow
+#endif
 #define screenLength 5 // 5 seconds for start and winning screen
+#define fixedShift 16                           // ball physics is Q16.16 fixed point
+#define fixedOne (1 << fixedShift)              // one pixel
+#define toFixed(n) ((int32_t)(n) * fixedOne)    // whole pixels to Q16.16
+#define fixedToInt(f) ((int)((f) >> fixedShift)) // Q16.16 to whole pixels (rounds down)
 
 char lPaddleColour = 'R';
 char rPaddleColour = 'B';
@@ -96,16 +178,16 @@ int lPaddleX;
 int rPaddleX;
 int lPaddleY;
 int rPaddleY;
-float ballX;
-float ballY;
+int32_t ballX; // Q16.16
+int32_t ballY; // Q16.16
 
 int oldLPaddleY;
 int oldRPaddleY;
-float oldBallX;
-float oldBallY;
+int32_t oldBallX; // Q16.16
+int32_t oldBallY; // Q16.16
 
-float ballVelocityX;
-float ballVelocityY;
+int32_t ballVelocityX; // Q16.16 pixels per tick
+int32_t ballVelocityY; // Q16.16 pixels per tick
 bool lServe = false;
 
 int lScore = 0;
@@ -124,10 +206,35 @@ int startPoint;
 bool newMode = true;
 int winCycle = 0;
 
+/* Joystick state for the current tick, taken once by sampleInput() at the start of game_tick(). Index 0 is the left
+ * paddle, 1 the right.
+ */
+typedef struct
+{
+  uint32_t channels[4]; // raw ADC readings of channels 1, 2 (left) and 6, 7 (right)
+  int raw[2];           // single-axis reading per paddle (see getRawPaddleInput)
+  int normalised[2];    // reading as percent * inputSpan (0 = top), unclamped, for inputCheck
+  int paddleY[2];       // paddle position for the reading (convertInputToPaddlePosition)
+} InputSnapshot;
+
+InputSnapshot inputSnapshot;
+
 void initGameMatrix(void);
+uint8_t colourCodeToBits(char colour);
+char colourBitsToCode(uint8_t bits);
+void setPixel(int x, int y, char colour);
+char getPixel(int x, int y);
+void fillRowSpan(int y, uint32_t mask, char colour);
+void fillRowSpanLevels(int y, uint32_t mask, uint8_t red, uint8_t green, uint8_t blue);
+uint8_t getPixelLevel(int x, int y, int channel);
+void fillRect(int x, int y, int width, int height, char colour);
+void getMatrixRow(int y, char matrixRow[]);
 void initGame(void);
 void updateDisplay(void);
-void displayRow(char matrixRow[]);
+void prepareScanout(void);
+void scanSlot(int i, int k, const uint32_t payload[PANEL_ROW_WORDS]);
+void scanPanel(void);
+void displayRow(const uint32_t matrixRow[3], uint32_t planes[3]);
 void drawPaddles(void);
 void eraseOldPaddles(int paddleX, int oldPaddleY);
 void drawPaddle(int paddleX, int paddleY, int oldPaddleY, char paddleColour);
@@ -153,21 +260,193 @@ void setupPanel(void);
 void setupInput(void);
 void updatePaddlePositions(void);
 int getRawPaddleInput(int whichPaddle);
-bool inputCheck(float minimumValue, float maximumValue, int chosePaddle);
+void sampleInput(void);
+bool inputCheck(int minimumPercent, int maximumPercent, int chosePaddle);
+
+/* -----------------------------------------------------------------------------
+ * Scan timer (GAME_SCANOUT_ISR builds)
+ * -----------------------------------------------------------------------------
+ * scanoutIsr() runs from the HAL's periodic scan timer (startScanTimer, scanTimerHz per second). Each call shows one
+ * slot, intensity bit k of row-pair i, from page scanPage with scanSlot(), then holds it for 2^k timer periods (BCM), so
+ * the slots of a scan follow the inline scan's order and weights. At the start of every scan it takes frontPage as the
+ * page to show, so a scan never mixes two pages.
+ *
+ * The game only writes the back page (backPage). flipPages() publishes it with one store to frontPage and waits until
+ * the interrupt has picked it up and completed scansPerTick scans of it; by then nothing reads the old front page, which
+ * becomes the next back page. pageDirtyRowPairs[p] remembers the row-pairs page p still has to rebuild.
+ * ----------------------------------------------------------------------------- */
+
+#ifdef GAME_SCANOUT_ISR
+volatile int frontPage = 0;            // last page flipped to by the game
+volatile int scanPage = 0;             // page the interrupt is scanning
+volatile uint32_t scanPageScans = 0;   // complete scans of scanPage
+int backPage = 1;
+uint32_t pageDirtyRowPairs[scanoutPages];
+int isrRowPair = 0;
+int isrBit = 0;
+int isrHold = 0;                       // timer periods left in the current slot's dwell
+
+void scanoutIsr(void);
+void flipPages(void);
+#endif
+
+/* -----------------------------------------------------------------------------
+ * Refresh timing
+ * -----------------------------------------------------------------------------
+ * The scan is timed in microseconds of the HAL's now_us() clock. scanPanel() holds each slot until a deadline
+ * (scanDeadlineUs) that advances by the slot's dwell (rowDwellUs << k), so shifting the next slot's payload takes time
+ * from the dwell of the slot still showing instead of adding to it. The deadline carries on from one scan to the next,
+ * which absorbs the game logic between scans in the same way, so a scan takes targetScanUs and the refresh rate is the
+ * target, not the target slowed down by everything else. noteScanStart() measures the period actually achieved for
+ * game_refresh_stats().
+ * ----------------------------------------------------------------------------- */
+
+volatile uint32_t refreshScanStartUs = 0; // now_us() at the start of the last scan
+volatile uint32_t refreshLastScanUs = 0;  // time between the starts of the last two scans
+volatile uint32_t refreshScans = 0;
+uint32_t scanDeadlineUs = 0;              // end of the last slot's dwell on the schedule
+
+/*
+ * noteScanStart
+ * Records the start of a scan at `nowUs` (inline scan or scan timer interrupt).
+ */
+
+static void noteScanStart(uint32_t nowUs)
+{
+  if (refreshScans > 0)
+  {
+    refreshLastScanUs = nowUs - refreshScanStartUs;
+  }
+  refreshScanStartUs = nowUs;
+  refreshScans++;
+}
+/*
+ * holdSlot
+ * Dwells on the slot just latched until scanDeadlineUs + dwellUs, and moves the deadline there. If the schedule has
+ * slipped by more than the dwell (the first scan, a long tick, or a HAL whose delays do not pass on now_us()), it restarts
+ * from now with the full dwell.
+ */
+
+static void holdSlot(uint32_t dwellUs)
+{
+  scanDeadlineUs += dwellUs;
+  uint32_t nowUs = now_us();
+  uint32_t remainingUs = scanDeadlineUs - nowUs;
+  if (remainingUs > dwellUs)
+  {
+    remainingUs = dwellUs;
+    scanDeadlineUs = nowUs + dwellUs;
+  }
+  delay_us(remainingUs);
+}
+
+/* -----------------------------------------------------------------------------
+ * Frame profile (GAME_PROFILE builds)
+ * -----------------------------------------------------------------------------
+ * profileEnter(phase) / profileLeave() bracket the phases of a tick (see GameProfilePhase in game.h). Time is charged
+ * to the innermost open phase using the HAL's getTimestamp(), so nested phases (delays inside updateDisplay, input
+ * reads inside the drawing block) are not counted twice; time outside any bracket is GAME_PROFILE_OTHER.
+ * profileTickBegin() / profileTickEnd() in game_tick() store each phase's total for the tick in a ring of the last
+ * GAME_PROFILE_WINDOW ticks, from which game_profile_stats() computes min/mean/max/p99.
+ *
+ * Without GAME_PROFILE the hooks are empty macros, so the instrumented code compiles exactly as before.
+ * ----------------------------------------------------------------------------- */
+
+#ifdef GAME_PROFILE
+#define profileMaxDepth 8
+
+uint32_t profileWindow[GAME_PROFILE_PHASES][GAME_PROFILE_WINDOW]; // per-tick totals in timestamp counts
+uint32_t profileTicks = 0;                                          // ticks recorded (ring slot = ticks % window)
+uint32_t profileTickTotals[GAME_PROFILE_PHASES];
+uint8_t profileStack[profileMaxDepth];
+int profileDepth = 0;
+uint32_t profileMark;
+uint32_t profileTickStart;
+
+/*
+ * profileCharge
+ * Adds the time since the last mark to the innermost open phase and moves the mark to now.
+ */
+
+static void profileCharge(void)
+{
+  uint32_t now = getTimestamp();
+  profileTickTotals[profileStack[profileDepth - 1]] += now - profileMark;
+  profileMark = now;
+}
+
+/*
+ * profileEnter / profileLeave
+ * Open a phase (charging the time so far to the enclosing one) / close the innermost phase.
+ */
+
+static void profileEnter(GameProfilePhase phase)
+{
+  profileCharge();
+  profileStack[profileDepth++] = (uint8_t)phase;
+}
+
+static void profileLeave(void)
+{
+  profileCharge();
+  profileDepth--;
+}
+
+/*
+ * profileTickBegin / profileTickEnd
+ * Start a tick with every phase at zero and GAME_PROFILE_OTHER open / close it and store its totals in the window.
+ */
+
+static void profileTickBegin(void)
+{
+  for (int phase = 0; phase < GAME_PROFILE_PHASES; phase++)
+  {
+    profileTickTotals[phase] = 0;
+  }
+  profileStack[0] = GAME_PROFILE_OTHER;
+  profileDepth = 1;
+  profileMark = getTimestamp();
+  profileTickStart = profileMark;
+}
+
+static void profileTickEnd(void)
+{
+  profileCharge();
+  profileTickTotals[GAME_PROFILE_TICK] = profileMark - profileTickStart;
+  uint32_t slot = profileTicks % GAME_PROFILE_WINDOW;
+  for (int phase = 0; phase < GAME_PROFILE_PHASES; phase++)
+  {
+    profileWindow[phase][slot] = profileTickTotals[phase];
+  }
+  profileTicks++;
+}
+#else
+#define profileEnter(phase) ((void)0)
+#define profileLeave() ((void)0)
+#define profileTickBegin() ((void)0)
+#define profileTickEnd() ((void)0)
+#endif
 
-// X R G B C Y M W
 /* -----------------------------------------------------------------------------
  * Framebuffer and glyph tables
  * -----------------------------------------------------------------------------
- * gameMatrix is the 32x32 logical framebuffer. Each cell stores a colour code.
+ * gameMatrix is the 32x32 logical framebuffer, stored as three bit-planes per row and intensity bit:
+ * gameMatrix[y][k][0] = red, [1] = green, [2] = blue for intensity bit k, with pixel x in bit x.
+ * This is the same layout PushRow() expects, so building a row-pair payload is a straight word copy.
  *
  * displayDigits is a small 6x4 bitmap font used for letters in "P1/P2 WINS START".
  * digits is a 5x4 bitmap font for numeric score rendering.
  *
- * colours maps a colour index (0..7) to {R,G,B} bit-planes used by displayRow().
+ * colourCodes maps a 3-bit RGB value (bit 0 = R, bit 1 = G, bit 2 = B) back to its colour code.
  * ----------------------------------------------------------------------------- */
 
-char gameMatrix[32][32];
+uint32_t gameMatrix[panelHeight][colourDepth][3];
+
+/* rowPayloads[page][i][k] is the packed PushRow() payload for row-pair i (rows i and i + 16) and intensity bit k, rebuilt
+ * by prepareScanout() only when bit i of dirtyRowPairs is set. The inline scan has one page; GAME_SCANOUT_ISR builds have
+ * a front page scanned by the timer interrupt and a back page the game fills (see the scan timer section). */
+uint32_t rowPayloads[scanoutPages][panelHeight / 2][colourDepth][PANEL_ROW_WORDS];
+uint32_t dirtyRowPairs = 0xFFFF;
 
 // P 1 2 W I N S ' ' T A R
 
@@ -197,13 +476,13 @@ int digits[10][5][4] = {{{0, 1, 1, 0}, {1, 1, 0, 1}, {1, 1, 1, 1}, {1, 0, 1, 1},
 {{0, 1, 1, 0}, {1, 0, 0, 1}, {0, 1, 1, 0}, {1, 0, 0, 1}, {1, 1, 1, 1}},
 {{1, 1, 1, 1}, {1, 0, 0, 1}, {0, 1, 1, 1}, {0, 0, 0, 1}, {1, 1, 1, 0}}};
 
-// X R G B Y C M
+// indexed by RGB bits: X R G Y B M C W
 
-int colours[8][3] = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0}, {0, 1, 1}, {1, 0, 1}, {1, 1, 1}};
+char colourCodes[8] = {'X', 'R', 'G', 'Y', 'B', 'M', 'C', 'W'};
 /*
  * initGameMatrix
- * Clears the 32x32 logical framebuffer (gameMatrix) to the background colour code 'X'.
- * The game draws everything (borders, paddles, ball, text) by writing colour codes into gameMatrix.
+ * Clears the 32x32 logical framebuffer (gameMatrix) to the background colour 'X' (all planes zero).
+ * The game draws everything (borders, paddles, ball, text) by writing colours into gameMatrix.
  * updateDisplay() later scans gameMatrix row-by-row and pushes the corresponding RGB bitstream
  * to the panel shift registers.
  */
@@ -212,11 +491,168 @@ void initGameMatrix(void)
 {
   for (int i = 0; i < panelHeight; i++)
   {
-    for (int j = 0; j < panelWidth; j++)
+    for (int k = 0; k < colourDepth; k++)
     {
-      gameMatrix[i][j] = 'X';
+      gameMatrix[i][k][0] = 0;
+      gameMatrix[i][k][1] = 0;
+      gameMatrix[i][k][2] = 0;
     }
   }
+  dirtyRowPairs = 0xFFFF;
+}
+/*
+ * colourCodeToBits / colourBitsToCode
+ * Convert between a colour code ('X', 'R', ..., 'W') and its 3-bit RGB value (bit 0 = R, bit 1 = G, bit 2 = B).
+ * Unknown codes are treated as 'X'.
+ */
+
+uint8_t colourCodeToBits(char colour)
+{
+  switch (colour)
+  {
+    case 'R': return 1;
+    case 'G': return 2;
+    case 'Y': return 3;
+    case 'B': return 4;
+    case 'M': return 5;
+    case 'C': return 6;
+    case 'W': return 7;
+    default:  return 0;
+  }
+}
+
+char colourBitsToCode(uint8_t bits)
+{
+  return colourCodes[bits & 7];
+}
+/*
+ * fillRowSpan
+ * Paints every pixel of row y whose bit is set in mask with the given colour, leaving the other pixels unchanged.
+ * This is the single primitive all colour-code drawing goes through: lit channels are set to full intensity.
+ */
+
+void fillRowSpan(int y, uint32_t mask, char colour)
+{
+  uint8_t bits = colourCodeToBits(colour);
+  fillRowSpanLevels(y, mask,
+                    (bits & 1u) ? maxColourLevel : 0,
+                    (bits & 2u) ? maxColourLevel : 0,
+                    (bits & 4u) ? maxColourLevel : 0);
+}
+/*
+ * fillRowSpanLevels
+ * Paints every pixel of row y whose bit is set in mask with the given per-channel intensities (0..maxColourLevel;
+ * higher bits are ignored). Each intensity bit plane of each channel is updated with one mask operation.
+ * If the row actually changes, its row-pair is marked dirty so prepareScanout() rebuilds that payload.
+ */
+
+void fillRowSpanLevels(int y, uint32_t mask, uint8_t red, uint8_t green, uint8_t blue)
+{
+  if (y < 0 || y >= panelHeight)
+  {
+    return;
+  }
+  const uint8_t levels[3] = {red, green, blue};
+  uint32_t changed = 0;
+  for (int k = 0; k < colourDepth; k++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      uint32_t current = gameMatrix[y][k][j];
+      uint32_t updated = ((levels[j] >> k) & 1u) ? (current | mask) : (current & ~mask);
+      changed |= updated ^ current;
+      gameMatrix[y][k][j] = updated;
+    }
+  }
+  if (changed)
+  {
+    dirtyRowPairs |= 1u << (y % (panelHeight / 2));
+  }
+}
+/*
+ * spanMask
+ * Returns a mask with bits [x, x + width) set, clipped to the panel width.
+ */
+
+static inline uint32_t spanMask(int x, int width)
+{
+  int end = x + width;
+  if (x < 0) x = 0;
+  if (end > panelWidth) end = panelWidth;
+  if (end <= x) return 0;
+  uint32_t upper = (end >= 32) ? 0xFFFFFFFFu : ((1u << end) - 1u);
+  return upper & ~((1u << x) - 1u);
+}
+/*
+ * fillRect
+ * Paints the rectangle x in [x, x + width), y in [y, y + height) with the given colour, clipped to the panel.
+ */
+
+void fillRect(int x, int y, int width, int height, char colour)
+{
+  uint32_t mask = spanMask(x, width);
+  for (int j = 0; j < height; j++)
+  {
+    fillRowSpan(y + j, mask, colour);
+  }
+}
+/*
+ * setPixel / getPixel
+ * Single-pixel accessors. Out-of-range writes are ignored and out-of-range reads return 'X'. getPixel reports a channel
+ * as lit when the most significant intensity bit is set, which round-trips every colour drawn with setPixel.
+ */
+
+void setPixel(int x, int y, char colour)
+{
+  if (x < 0 || x >= panelWidth)
+  {
+    return;
+  }
+  fillRowSpan(y, 1u << x, colour);
+}
+
+char getPixel(int x, int y)
+{
+  if (x < 0 || x >= panelWidth || y < 0 || y >= panelHeight)
+  {
+    return 'X';
+  }
+  const uint32_t* planes = gameMatrix[y][colourDepth - 1];
+  uint8_t bits = (uint8_t)(((planes[0] >> x) & 1u) |
+                           (((planes[1] >> x) & 1u) << 1) |
+                           (((planes[2] >> x) & 1u) << 2));
+  return colourBitsToCode(bits);
+}
+/*
+ * getPixelLevel
+ * Returns the intensity (0..maxColourLevel) of one channel (0 = R, 1 = G, 2 = B) of pixel (x, y), or 0 out of range.
+ */
+
+uint8_t getPixelLevel(int x, int y, int channel)
+{
+  if (x < 0 || x >= panelWidth || y < 0 || y >= panelHeight || channel < 0 || channel > 2)
+  {
+    return 0;
+  }
+  uint8_t level = 0;
+  for (int k = 0; k < colourDepth; k++)
+  {
+    level |= (uint8_t)(((gameMatrix[y][k][channel] >> x) & 1u) << k);
+  }
+  return level;
+}
+/*
+ * getMatrixRow
+ * Produces the character colour-code view of row y (panelWidth characters, no terminator). Used by tempDisplay()
+ * and for debugging; the scan path never needs it.
+ */
+
+void getMatrixRow(int y, char matrixRow[])
+{
+  for (int x = 0; x < panelWidth; x++)
+  {
+    matrixRow[x] = getPixel(x, y);
+  }
 }
 /*
  * initGame
@@ -236,107 +672,233 @@ void initGame(void)
   oldLPaddleY = lPaddleY;
   oldRPaddleY = rPaddleY;
   
-  ballX = panelWidth / 2 - 1;
-  ballY = panelHeight / 2 - 1;
+  ballX = toFixed(panelWidth / 2 - 1);
+  ballY = toFixed(panelHeight / 2 - 1);
   
   lServe = !lServe;
   if (lServe)
   {
-    ballX -= 2;
-    ballVelocityX = -ballSpeed;
+    ballX -= toFixed(2);
+    ballVelocityX = -toFixed(ballSpeed);
   }
   else
   {
-    ballX += 2;
-    ballVelocityX = ballSpeed;
+    ballX += toFixed(2);
+    ballVelocityX = toFixed(ballSpeed);
   }
   
   oldBallX = ballX;
   oldBallY = ballY;
 }
 /*
- * updateDisplay
- * Implements the panel refresh / scan routine for a multiplexed 32x32 LED matrix that is wired as two 16-row halves.
+ * prepareScanout
+ * Converts the framebuffer into the 16 ready-to-shift row-pair payloads, rebuilding only the row-pairs that drawing code
+ * has changed since the last call. For each intensity bit k:
+ *   - displayRow(gameMatrix[i][k]) copies the 96 bits for the top half row i (32 pixels * 3 colour planes) into
+ *     payload words 0..2.
+ *   - displayRow(gameMatrix[i+16][k]) copies the corresponding bottom half row (i+16) into payload words 3..5.
+ * In GAME_SCANOUT_ISR builds the payloads go to the back page, which also catches up with the rows changed before the
+ * last flip (they were only rebuilt in the other page).
+ */
+
+void prepareScanout(void)
+{
+#ifdef GAME_SCANOUT_ISR
+  const int page = backPage;
+  pageDirtyRowPairs[page ^ 1] |= dirtyRowPairs;
+  uint32_t dirty = pageDirtyRowPairs[page] | dirtyRowPairs;
+  pageDirtyRowPairs[page] = 0;
+#else
+  const int page = 0;
+  uint32_t dirty = dirtyRowPairs;
+#endif
+  dirtyRowPairs = 0;
+  while (dirty)
+  {
+    int i = __builtin_ctz(dirty);
+    dirty &= dirty - 1;
+    for (int k = 0; k < colourDepth; k++)
+    {
+      displayRow(gameMatrix[i][k], &rowPayloads[page][i][k][0]);
+      displayRow(gameMatrix[i + 16][k], &rowPayloads[page][i][k][3]);
+    }
+  }
+}
+/*
+ * scanPanel
+ * Implements one refresh / scan of the multiplexed 32x32 LED matrix (wired as two 16-row halves) from the cached
+ * row-pair payloads.
  *
- * For each row address i in [0..15]:
+ * scanBlankClearRow (default, the original coursework scan). For each row address i in [0..15]:
  *   1) ClearRow(i) shifts 0s for that row payload (prevents ghosting on hardware).
  *   2) PrepareLatch() sets the latch low so the display stops showing while we shift new bits.
  *   3) SelectRow(i+1) drives the A/B/C/D row address lines (this implementation uses i+1, matching the coursework
  *      wiring/driver conventions).
- *   4) displayRow(gameMatrix[i]) shifts 96 bits for the top half row i (32 pixels * 3 colour planes).
- *   5) displayRow(gameMatrix[i+16]) shifts 96 bits for the corresponding bottom half row (i+16).
- *   6) LatchRegister() commits the 192 shifted bits into the panel output register so the selected row-pair displays.
- *   7) delay_ms(refreshDelay) holds the row briefly before advancing to the next row-pair.
+ *   Then, for each intensity bit k in [0..colourDepth-1] (Binary Code Modulation):
+ *   4) PushRow() shifts the whole cached 192-bit payload for row-pair i, bit k in one HAL call.
+ *   5) LatchRegister() commits the 192 shifted bits into the panel output register so the selected row-pair displays.
+ *   6) holdSlot() shows the row for a dwell of rowDwellUs << k, weighted by 2^k, so a channel's perceived brightness is
+ *      proportional to its intensity level. PrepareLatch() precedes every latch after the first.
+ *
+ * scanBlankOutputEnable. For each row address i and intensity bit k:
+ *   1) PrepareLatch() and PushRow() shift the next payload while the previous row keeps displaying (shifting does not
+ *      change the outputs until the latch).
+ *   2) SetOutputEnable(false) blanks the panel, SelectRow(i+1) changes the address (first bit only) and
+ *      LatchRegister() commits the payload, so the old data never appears on the new row.
+ *   3) SetOutputEnable(true) shows the row, and holdSlot() holds it as above.
+ *   No zero rows are shifted, which halves the shift clocks per scan.
+ *
+ * With colourDepth 1 this is one latch per row. Each row-pair dwells (2^colourDepth - 1) * rowDwellUs in total, which is
+ * what bounds the achievable refresh rate at higher depths. The dwells are scheduled against deadlines (see the refresh
+ * timing section), so a scan takes targetScanUs however long the shifting takes, as long as shifting a slot takes less
+ * than the dwell of the one before it.
  *
  * The combination of fast row scanning and human persistence of vision yields an apparently stable full frame.
  */
 
-void updateDisplay(void)
+void scanPanel(void)
 {
+  noteScanStart(now_us());
   for (int i = 0; i < panelHeight / 2; i++)
   {
     // Scan one row address at a time (row-pair i and i+16 on a 32x32 panel).
+    for (int k = 0; k < colourDepth; k++)
+    {
+      scanSlot(i, k, rowPayloads[0][i][k]);
+      profileEnter(GAME_PROFILE_DELAY);
+      holdSlot(rowDwellUs << k);
+      profileLeave();
+    }
+  }
+}
+/*
+ * scanSlot
+ * Shows intensity bit k of row-pair i: the HAL calls of one (i, k) step of scanPanel() above, up to and including the
+ * latch, without the dwell. The row select (and, with scanBlankClearRow, the ClearRow) happens on bit 0.
+ */
+
+void scanSlot(int i, int k, const uint32_t payload[PANEL_ROW_WORDS])
+{
+#if scanBlankMode == scanBlankOutputEnable
+  PrepareLatch();
+  PushRow(payload);
+  SetOutputEnable(false);
+  if (k == 0)
+  {
+    SelectRow(i + 1);
+  }
+  LatchRegister();
+  SetOutputEnable(true);
+#else
+  if (k == 0)
+  {
     ClearRow(i);
     PrepareLatch();
     SelectRow(i + 1);
-    displayRow(gameMatrix[i]);
-    displayRow(gameMatrix[i + 16]);
-    LatchRegister();
-    delay_ms(refreshDelay);
   }
+  else
+  {
+    PrepareLatch();
+  }
+  PushRow(payload);
+  LatchRegister();
+#endif
 }
 /*
- * displayRow
- * Converts one logical row of 32 colour codes (matrixRow[0..31]) into the physical serial bitstream expected by the panel.
- *
- * The panel uses 3 bit-planes per pixel (R, G, B). This function loops colour-plane-first (j = 0..2) and then pixel index
- * (i = 0..31) to push bits in the order assumed by the coursework hardware driver.
+ * updateDisplay
+ * Called once per game tick: brings the cached row-pair payloads up to date with gameMatrix (prepareScanout), then scans
+ * the panel scansPerTick times. Raising scansPerTick raises the refresh rate (less flicker) without making the game
+ * logic, and so the ball, any faster per tick; repeated scans only re-shift the cached payloads.
  *
- * Each character in matrixRow is mapped to a colour index (0..7) and then into colours[colourIndex][j] where:
- *   colours[k] = {Rbit, Gbit, Bbit} for the colour k.
- * PushBit() is called once per bit to shift it into the panel.
+ * In GAME_SCANOUT_ISR builds the scans happen in the scan timer interrupt instead: the rebuilt back page is flipped to
+ * the front, and the tick waits for scansPerTick scans of it (flipPages).
  */
 
-void displayRow(char matrixRow[])
+void updateDisplay(void)
 {
-  int colourIndex;
-  for (int j = 0; j < 3; j++)
+  profileEnter(GAME_PROFILE_SCANOUT);
+  prepareScanout();
+#ifdef GAME_SCANOUT_ISR
+  flipPages();
+#else
+  for (int scan = 0; scan < scansPerTick; scan++)
+  {
+    scanPanel();
+  }
+#endif
+  profileLeave();
+}
+#ifdef GAME_SCANOUT_ISR
+/*
+ * scanoutIsr
+ * The scan timer's handler: one slot per call, then 2^k - 1 idle calls of dwell (see the scan timer section). A scan
+ * starts by taking the page the game last flipped to.
+ */
+
+void scanoutIsr(void)
+{
+  if (isrHold > 0)
+  {
+    isrHold--;
+    return;
+  }
+  if ((isrRowPair == 0) && (isrBit == 0))
   {
-    for (int i = 0; i < panelWidth; i++)
+    noteScanStart(now_us());
+    if (scanPage != frontPage)
     {
-      switch (matrixRow[i])
-      {
-        case 'X':
-        colourIndex = 0;
-        break;
-        case 'W':
-        colourIndex = 7;
-        break;
-        case 'R':
-        colourIndex = 1;
-        break;
-        case 'B':
-        colourIndex = 3;
-        break;
-        case 'C':
-        colourIndex = 5;
-        break;
-        case 'M':
-        colourIndex = 6;
-        break;
-        case 'Y':
-        colourIndex = 4;
-        break;
-        case 'G':
-        colourIndex = 2;
-        break;
-      }
-      
-      // Push the bit for the current colour plane (j=0..2) for this pixel.
-      PushBit(colours[colourIndex][j]);
+      scanPage = frontPage;
+      scanPageScans = 0;
+    }
+  }
+  __atomic_signal_fence(__ATOMIC_ACQUIRE); // read the page's payloads only after taking it
+  scanSlot(isrRowPair, isrBit, rowPayloads[scanPage][isrRowPair][isrBit]);
+  isrHold = (1 << isrBit) - 1;
+  if (++isrBit == colourDepth)
+  {
+    isrBit = 0;
+    if (++isrRowPair == panelHeight / 2)
+    {
+      isrRowPair = 0;
+      scanPageScans++;
     }
   }
 }
+/*
+ * flipPages
+ * Publishes the back page with a single store to frontPage (so the interrupt sees either the old or the new page, never
+ * a mix), then waits until the interrupt is scanning it and has completed scansPerTick scans. The old front page is the
+ * next back page: the interrupt no longer reads it.
+ */
+
+void flipPages(void)
+{
+  __atomic_signal_fence(__ATOMIC_RELEASE); // the back page is complete before it is published
+  frontPage = backPage;
+  backPage ^= 1;
+  profileEnter(GAME_PROFILE_DELAY);
+  while ((scanPage != frontPage) || (scanPageScans < scansPerTick))
+  {
+    waitForInterrupt();
+  }
+  profileLeave();
+}
+#endif
+/*
+ * displayRow
+ * Converts one logical row of gameMatrix (three colour-plane words) into the packed bit-planes expected by PushRow().
+ *
+ * The panel uses 3 bit-planes per pixel (R, G, B) and is loaded colour-plane-first: all 32 red bits, then all 32 green
+ * bits, then all 32 blue bits, matching the order assumed by the coursework hardware driver. gameMatrix already stores
+ * each row in that layout (planes[0] = R, planes[1] = G, planes[2] = B, pixel i in bit i), so this is a word copy.
+ */
+
+void displayRow(const uint32_t matrixRow[3], uint32_t planes[3])
+{
+  planes[0] = matrixRow[0];
+  planes[1] = matrixRow[1];
+  planes[2] = matrixRow[2];
+}
 /*
  * drawPaddles
  * Draws both paddles into gameMatrix and updates the stored "old" paddle positions so the next frame can erase and redraw
@@ -352,24 +914,14 @@ void drawPaddles(void)
 }
 /*
  * eraseOldPaddles
- * Clears the previous paddle rectangle from gameMatrix by writing the background code 'X' over the region defined by:
+ * Clears the previous paddle rectangle from gameMatrix by writing the background colour 'X' over the region defined by:
  *   x in [paddleX, paddleX + paddleWidth)
  *   y in [oldPaddleY, oldPaddleY + paddleHeight)
  * This is used to remove the paddle's previous position before drawing the paddle at its new position.
  */
 void eraseOldPaddles(int paddleX, int oldPaddleY)
 {
-  int x;
-  int y;
-  for (int i = 0; i < paddleWidth; i++)
-  {
-    x = paddleX + i;
-    for (int j = 0; j < paddleHeight; j++)
-    {
-      y = oldPaddleY + j;
-      gameMatrix[y][x] = 'X';
-    }
-  }
+  fillRect(paddleX, oldPaddleY, paddleWidth, paddleHeight, 'X');
 }
 /*
  * drawPaddle
@@ -385,18 +937,8 @@ void eraseOldPaddles(int paddleX, int oldPaddleY)
 
 void drawPaddle(int paddleX, int paddleY, int oldPaddleY, char paddleColour)
 {
-  int x;
-  int y;
   eraseOldPaddles(paddleX, oldPaddleY);
-  for (int i = 0; i < paddleWidth; i++)
-  {
-    x = paddleX + i;
-    for (int j = 0; j < paddleHeight; j++)
-    {
-      y = paddleY + j;
-      gameMatrix[y][x] = paddleColour;
-    }
-  }
+  fillRect(paddleX, paddleY, paddleWidth, paddleHeight, paddleColour);
 }
 /*
  * drawBall
@@ -407,20 +949,9 @@ void drawPaddle(int paddleX, int paddleY, int oldPaddleY, char paddleColour)
 
 void drawBall(void)
 {
-  int x;
-  int y;
   oldBallX = ballX;
   oldBallY = ballY;
-  for (int i = 0; i < ballSize; i++)
-  {
-    x = ((int)ballX) + i;
-    for (int j = 0; j < ballSize; j++)
-    {
-      y = ((int)ballY) + j;
-      gameMatrix[y][x] = ballColour;
-      
-    }
-  }
+  fillRect(fixedToInt(ballX), fixedToInt(ballY), ballSize, ballSize, ballColour);
 }
 /*
  * eraseOldBall
@@ -430,17 +961,7 @@ void drawBall(void)
 
 void eraseOldBall(void)
 {
-  int x;
-  int y;
-  for (int i = 0; i < ballSize; i++)
-  {
-    x = ((int)oldBallX) + i;
-    for (int j = 0; j < ballSize; j++)
-    {
-      y = ((int)oldBallY) + j;
-      gameMatrix[y][x] = 'X';
-    }
-  }
+  fillRect(fixedToInt(oldBallX), fixedToInt(oldBallY), ballSize, ballSize, 'X');
 }
 /*
  * drawNet
@@ -450,18 +971,12 @@ void eraseOldBall(void)
 
 void drawNet(void)
 {
-  int x;
-  int y;
-  for (int i = 0; i < netWidth; i++)
+  uint32_t netMask = spanMask(panelWidth / 2 - netWidth / 2, netWidth);
+  for (int y = 0; y < panelHeight; y++)
   {
-    x = panelWidth / 2 + i - netWidth / 2;
-    for (int j = 0; j < panelHeight; j++)
+    if ((y % (netWidth * 2)) < netWidth)
     {
-      y = j;
-      if ((y % (netWidth * 2)) < netWidth)
-      {
-        gameMatrix[y][x] = netColour;
-      }
+      fillRowSpan(y, netMask, netColour);
     }
   }
 }
@@ -473,14 +988,8 @@ void drawNet(void)
 
 void drawBorders(void)
 {
-  for (int j = 0; j < borderWidth; j++)
-  {
-    for (int i = 0; i < panelWidth; i++)
-    {
-      gameMatrix[j][i] = borderColour;
-      gameMatrix[panelHeight - 1 - j][i] = borderColour;
-    }
-  }
+  fillRect(0, 0, panelWidth, borderWidth, borderColour);
+  fillRect(0, panelHeight - borderWidth, panelWidth, borderWidth, borderColour);
 }
 /*
  * drawWinBorders
@@ -488,16 +997,10 @@ void drawBorders(void)
  */
 
 void drawWinBorders(void) {
-  for (int j = 0; j < borderWidth; j++)
-  {
-    for (int i = 0; i < panelWidth; i++)
-    {
-      gameMatrix[j][i] = borderColour;
-      gameMatrix[i][j] = borderColour;
-      gameMatrix[panelHeight - 1 - j][i] = borderColour;
-      gameMatrix[i][panelWidth - 1 - j] = borderColour;
-    }
-  }
+  fillRect(0, 0, panelWidth, borderWidth, borderColour);
+  fillRect(0, 0, borderWidth, panelHeight, borderColour);
+  fillRect(0, panelHeight - borderWidth, panelWidth, borderWidth, borderColour);
+  fillRect(panelWidth - borderWidth, 0, borderWidth, panelHeight, borderColour);
 }
 /*
  * detectCollisions
@@ -507,43 +1010,45 @@ void drawWinBorders(void) {
  *   - and potentially other playfield elements depending on the current state.
  *
  * Collision detection is performed using the ball's current position and the paddle rectangles. When a collision is
- * detected, the corresponding velocity component is inverted and/or adjusted.
+ * detected, the corresponding velocity component is inverted and/or adjusted. All of it is Q16.16 integer arithmetic:
+ * the paddle deflection (ballY offset from the paddle centre, divided by half the paddle height) is one integer
+ * division, and a ball stuck on a border gets half a pixel per tick of vertical speed.
  */
 
 void detectCollisions(void)
 {
-  float yRandom;
-  if ((((ballX - lPaddleX) <= paddleWidth) && ((ballX - lPaddleX) >= 0)) && (((ballY - lPaddleY) <= (paddleHeight + ballSize) && ((ballY - lPaddleY) >= (-ballSize)))))
+  int32_t yOffset;
+  if ((((ballX - toFixed(lPaddleX)) <= toFixed(paddleWidth)) && ((ballX - toFixed(lPaddleX)) >= 0)) && (((ballY - toFixed(lPaddleY)) <= toFixed(paddleHeight + ballSize) && ((ballY - toFixed(lPaddleY)) >= toFixed(-ballSize)))))
   {
     if (ballVelocityX < 0)
     {
       ballVelocityX *= -1;
     }
-    yRandom = ((-(lPaddleY + (paddleHeight/2)) + ballY)) / ((paddleHeight+1)/2);
-    ballVelocityY = (ballSpeed * yRandom);
+    yOffset = ballY - toFixed(lPaddleY + (paddleHeight/2));
+    ballVelocityY = (ballSpeed * yOffset) / ((paddleHeight+1)/2);
   }
-  else if ((((rPaddleX - ballX) <= ballSize) && ((rPaddleX - ballX) >= 0)) && (((ballY - rPaddleY) <= (paddleHeight + ballSize) && ((ballY - rPaddleY) >= (-ballSize)))))
+  else if ((((toFixed(rPaddleX) - ballX) <= toFixed(ballSize)) && ((toFixed(rPaddleX) - ballX) >= 0)) && (((ballY - toFixed(rPaddleY)) <= toFixed(paddleHeight + ballSize) && ((ballY - toFixed(rPaddleY)) >= toFixed(-ballSize)))))
   {
     if (ballVelocityX > 0)
     {
       ballVelocityX *= -1;
     }
-    yRandom = ((-(rPaddleY + (paddleHeight/2)) + ballY)) / ((paddleHeight+1)/2);
-    ballVelocityY = (ballSpeed * yRandom);
+    yOffset = ballY - toFixed(rPaddleY + (paddleHeight/2));
+    ballVelocityY = (ballSpeed * yOffset) / ((paddleHeight+1)/2);
   }
   
-  if (ballY >= (panelHeight - 1 - borderWidth))
+  if (ballY >= toFixed(panelHeight - 1 - borderWidth))
   {
     if (ballVelocityY > 0) {
       ballVelocityY *= -1;
     } else if (ballVelocityY == 0) {
-      ballVelocityY = -0.5;
+      ballVelocityY = -fixedOne / 2;
     }
-  } else if ((ballY <= borderWidth + 1)) {
+  } else if ((ballY <= toFixed(borderWidth + 1))) {
     if (ballVelocityY < 0) {
       ballVelocityY *= -1;
     } else if (ballVelocityY == 0) {
-      ballVelocityY = 0.5;
+      ballVelocityY = fixedOne / 2;
     }
   }
 }
@@ -562,7 +1067,7 @@ void detectCollisions(void)
 
 bool detectPointWin(void)
 {
-  if ((ballX >= (panelWidth - ballSize)))
+  if ((ballX >= toFixed(panelWidth - ballSize)))
   {
     lScore += 1;
     return true;
@@ -653,6 +1158,27 @@ void displayWinner(int winner)
   drawCharacter('S', (startOffsetX + (characterLength * 5)+4), ((panelHeight / 2) - 3));
   drawWinBorders();
 }
+/*
+ * drawGlyphRow
+ * Draws one 4-pixel row of a bitmap glyph at (startingX, y): pixels set in glyphRow are painted onColour and the rest
+ * offColour. The row is turned into two masks (clipped to the panel), so each glyph row costs two fillRowSpan() calls.
+ */
+
+static void drawGlyphRow(const int glyphRow[4], int startingX, int y, char onColour, char offColour)
+{
+  uint32_t onMask = 0;
+  uint32_t cellMask = spanMask(startingX, 4);
+  for (int j = 0; j < 4; j++)
+  {
+    int x = startingX + j;
+    if (glyphRow[j] == 1 && x >= 0 && x < panelWidth)
+    {
+      onMask |= 1u << x;
+    }
+  }
+  fillRowSpan(y, onMask, onColour);
+  fillRowSpan(y, cellMask & ~onMask, offColour);
+}
 /*
  * drawDigit
  * Draws a single numeric digit (0..9) into gameMatrix at a given top-left position using the digits[][][] bitmap table.
@@ -663,29 +1189,11 @@ void displayWinner(int winner)
 void drawDigit(int digit, int startingX, int startingY)
 {
   
-  int x;
-  int y;
   for (int i = 0; i < 5; i++)
   {
-    y = startingY + i;
-    for (int j = 0; j < 4; j++)
-    {
-      x = startingX + j;
-      if (y >= 0 && y < panelHeight &&
-        x >= 0 && x < panelWidth)
-        {
-          if (digits[digit][i][j] == 1)
-          {
-            gameMatrix[y][x] = scoreColour;
-          }
-          else
-          {
-            gameMatrix[y][x] = 'X';
-          }
-        }
-      }
-    }
+    drawGlyphRow(digits[digit][i], startingX, startingY + i, scoreColour, 'X');
   }
+}
 /*
  * drawCharacter
  * Draws one character used in the start/win screens into gameMatrix at the specified top-left position.
@@ -731,33 +1239,21 @@ void drawDigit(int digit, int startingX, int startingY)
       case 'R':
       index = 10;
       break;
+      default: // unknown characters draw as a blank cell
+      index = 7;
+      break;
     }
-    int x;
-    int y;
     for (int i = 0; i < 6; i++)
     {
-      y = startingY + i;
-      for (int j = 0; j < 4; j++)
-      {
-        x = startingX + j;
-        if (y >= 0 && y < panelHeight && x >= 0 && x < panelWidth)
-        {
-          if (displayDigits[index][i][j] == 1)
-          {
-            gameMatrix[y][x] = textColour;
-          }
-          else
-          {
-            gameMatrix[y][x] = textBackgroundColour;
-          }
-        }
-      }
+      drawGlyphRow(displayDigits[index][i], startingX, startingY + i, textColour, textBackgroundColour);
     }
   }
 /*
  * updateBall
  * Advances the ball position by adding the current velocity components (ballVelocityX/Y) to (ballX, ballY).
  * This is the core motion integration step; collision handling (which may flip velocity) is performed separately.
+ * A ball reaching a border is parked one Q16.16 step (1/65536 pixel) beyond it, so it stays drawn on the row next to
+ * the border and detectCollisions() sees it as touching on the next tick.
  */
   
   void updateBall(void)
@@ -765,11 +1261,11 @@ void drawDigit(int digit, int startingX, int startingY)
     ballX += ballVelocityX;
     ballY += ballVelocityY;
     
-  if (ballY >= (panelHeight - 1 - borderWidth))
+  if (ballY >= toFixed(panelHeight - 1 - borderWidth))
   {
-    ballY = (panelHeight - 1 - borderWidth) + 0.00001;
-  } else if ((ballY <= borderWidth + 1)) {
-    ballY = borderWidth + 1 - 0.00001;
+    ballY = toFixed(panelHeight - 1 - borderWidth) + 1;
+  } else if ((ballY <= toFixed(borderWidth + 1))) {
+    ballY = toFixed(borderWidth + 1) - 1;
   }
   }
 /*
@@ -784,7 +1280,7 @@ void drawDigit(int digit, int startingX, int startingY)
     {
       for (int j = 0; j < 32; j++)
       {
-        if (gameMatrix[i][j] == 'X')
+        if (getPixel(j, i) == 'X')
         {
           printf(" ");
         }
@@ -801,15 +1297,16 @@ void drawDigit(int digit, int startingX, int startingY)
     }
   }
 /*
- * bound
- * Utility clamp that constrains an integer value to the inclusive range [lowerBound, upperBound].
- * Used to keep paddles and other objects within the visible panel coordinates.
+ * inputDistance
+ * Integer form of the joystick normalisation: how far rawValue lies from minPaddleVal towards maxPaddleVal, in raw
+ * units. Dividing by inputSpan gives the normalised [0..1] reading; callers compare or scale it with integer
+ * arithmetic instead so input handling is exact on every target.
  */
   
-  static inline float bound(float x) {
-    if (x < 0.0f) return 0.0f;
-    if (x > 1.0f) return 1.0f;
-    return x;
+  #define inputSpan ((maxPaddleVal > minPaddleVal) ? (maxPaddleVal - minPaddleVal) : (minPaddleVal - maxPaddleVal))
+  
+  static inline int inputDistance(int rawValue) {
+    return (maxPaddleVal > minPaddleVal) ? (rawValue - minPaddleVal) : (minPaddleVal - rawValue);
   }
 /*
  * convertInputToPaddlePosition
@@ -818,19 +1315,19 @@ void drawDigit(int digit, int startingX, int startingY)
  * The raw joystick values are assumed to lie between minPaddleVal and maxPaddleVal, and are normalised to a [0..1] range.
  * The resulting normalised value is then scaled to the valid paddle travel range (0..panelHeight - paddleHeight - 1).
  *
- * This function uses floating-point normalisation to preserve smooth control.
+ * The normalisation and rounding are done in integers (distance * maxY / inputSpan, rounded half up).
  */
   
   int convertInputToPaddlePosition(int inputValue)
   {
-    // normalise to 0..1 (0 = top, 1 = bottom)
-    float norm = ((float)inputValue - (float)minPaddleVal) /
-    ((float)maxPaddleVal - (float)minPaddleVal);
+    // normalise to 0..inputSpan (0 = top, inputSpan = bottom)
+    int distance = inputDistance(inputValue);
     
-    norm = bound(norm);
+    if (distance < 0) distance = 0;
+    if (distance > inputSpan) distance = inputSpan;
     
     int maxY = panelHeight - paddleHeight - borderWidth;   // your existing convention
-    int y = (int)(norm * (float)maxY + 0.5f);    // round to nearest
+    int y = (2 * distance * maxY + inputSpan) / (2 * inputSpan);    // round to nearest
     
     if (y < borderWidth) y = borderWidth;
     if (y > maxY) y = maxY;
@@ -842,59 +1339,55 @@ void drawDigit(int digit, int startingX, int startingY)
  *
  * The coursework wiring uses two ADC channels per joystick (one for "up" direction and one for "down" direction).
  * This function reads both and selects whichever channel is currently active (non-zero) so the game logic can treat the
- * joystick as a single-axis input.
+ * joystick as a single-axis input. The readings are also kept in inputSnapshot.channels.
+ *
+ * Only sampleInput() calls this; everything else reads inputSnapshot.
  */
   
   int getRawPaddleInput(int whichPaddle)
   {
-    uint32_t leftUp;
-    uint32_t leftDown;
-    uint32_t rightUp;
-    uint32_t rightDown;
-    if (whichPaddle == 0)
+    uint32_t up = getRawInput(whichPaddle == 0 ? 1 : 6);
+    uint32_t down = getRawInput(whichPaddle == 0 ? 2 : 7);
+    inputSnapshot.channels[2 * whichPaddle] = up;
+    inputSnapshot.channels[2 * whichPaddle + 1] = down;
+    if (up != 0)
     {
-      int rawLeft;
-      leftUp = getRawInput(1);
-      leftDown = getRawInput(2);
-      if (leftUp != 0)
-      {
-        rawLeft = (int)leftUp;
-      }
-      else
-      {
-        rawLeft = (int)leftDown;
-      }
-      return rawLeft;
+      return (int)up;
     }
     else
     {
-      int rawRight;
-      rightUp = getRawInput(6);
-      rightDown = getRawInput(7);
-      if (rightUp != 0)
-      {
-        rawRight = (int)rightUp;
-      }
-      else
-      {
-        rawRight = (int)rightDown;
-      }
-      return rawRight;
+      return (int)down;
+    }
+  }
+/*
+ * sampleInput
+ * The input stage of a tick: reads both joysticks once (four ADC conversions: left 1, 2 then right 6, 7) and
+ * precomputes what the rest of the tick needs from them, so the screens can test the sticks as often as they like
+ * without touching the ADC again.
+ */
+  
+  void sampleInput(void)
+  {
+    profileEnter(GAME_PROFILE_INPUT);
+    for (int paddle = 0; paddle < 2; paddle++)
+    {
+      int raw = getRawPaddleInput(paddle);
+      inputSnapshot.raw[paddle] = raw;
+      inputSnapshot.normalised[paddle] = inputDistance(raw) * 100;
+      inputSnapshot.paddleY[paddle] = convertInputToPaddlePosition(raw);
     }
+    profileLeave();
   }
 /*
  * updatePaddlePositions
- * Reads both joysticks via getRawPaddleInput() and updates lPaddleY/rPaddleY by converting the raw ADC values to screen
- * coordinates with convertInputToPaddlePosition(). This updates only the logical positions; drawing occurs separately.
+ * Updates lPaddleY/rPaddleY from this tick's input snapshot (the raw ADC values converted to screen coordinates by
+ * convertInputToPaddlePosition() in sampleInput()). This updates only the logical positions; drawing occurs separately.
  */
   
   void updatePaddlePositions(void)
   {
-    int rawLeft = getRawPaddleInput(0);
-    int rawRight = getRawPaddleInput(1);
-    
-    lPaddleY = convertInputToPaddlePosition(rawLeft);
-    rPaddleY = convertInputToPaddlePosition(rawRight);
+    lPaddleY = inputSnapshot.paddleY[0];
+    rPaddleY = inputSnapshot.paddleY[1];
   }
 /*
  * inputCheck
@@ -902,31 +1395,20 @@ void drawDigit(int digit, int startingX, int startingY)
  * window.
  *
  * The function:
- *   - reads both paddles,
- *   - normalises each raw reading to [0..1] using minPaddleVal/maxPaddleVal,
- *   - and returns true when the selected paddle's normalised value is outside [minimumValue, maximumValue].
+ *   - takes the chosen paddle's reading from this tick's input snapshot, normalised to [0..100] percent using
+ *     minPaddleVal/maxPaddleVal (scaled, not divided),
+ *   - and returns true when that normalised value is outside [minimumPercent, maximumPercent].
  *
  * This is used to detect "any movement" or "return to centre" gestures without needing exact thresholds in the calling code.
  */
   
-  bool inputCheck(float minimumValue, float maximumValue, int chosenPaddle)
+  bool inputCheck(int minimumPercent, int maximumPercent, int chosenPaddle)
   {
-    int rawLeft = getRawPaddleInput(0);
-    int rawRight = getRawPaddleInput(1);
-    
-    float normaliseLeft = ((float)rawLeft - (float)minPaddleVal) /
-    ((float)maxPaddleVal - (float)minPaddleVal);
-    
-    float normaliseRight = ((float)rawRight - (float)minPaddleVal) /
-    ((float)maxPaddleVal - (float)minPaddleVal);
-    if ((((normaliseLeft <= minimumValue) || (normaliseLeft >= maximumValue)) && (chosenPaddle == 0)) || (((normaliseRight >= maximumValue) || (normaliseRight <= minimumValue)) && (chosenPaddle == 1)))
-    {
-      return true;
-    }
-    else
-    {
-      return false;
-    }
+    // normalised reading * 100 * inputSpan, compared against percent * inputSpan
+    int normalised = inputSnapshot.normalised[chosenPaddle];
+    int minimumValue = minimumPercent * inputSpan;
+    int maximumValue = maximumPercent * inputSpan;
+    return (normalised <= minimumValue) || (normalised >= maximumValue);
   }
 /*
  * startScreen
@@ -941,13 +1423,15 @@ void drawDigit(int digit, int startingX, int startingY)
   {
     if (newMode)
     {
+      profileEnter(GAME_PROFILE_DRAWING);
       initGameMatrix();
       drawBorders();
       displayStart();
+      profileLeave();
       newMode = false;
       startPoint = cycle;
     }
-    else if (inputCheck(0.1, 0.9, 0) && inputCheck(0.1, 0.9, 1))
+    else if (inputCheck(10, 90, 0) && inputCheck(10, 90, 1))
     {
       gameMode = 1;
       newMode = true;
@@ -971,9 +1455,11 @@ void drawDigit(int digit, int startingX, int startingY)
   {
     if (newMode)
     {
+      profileEnter(GAME_PROFILE_DRAWING);
       initGameMatrix();
       initGame();
       drawBorders();
+      profileLeave();
       newMode = false;
       startPoint = cycle;
     }
@@ -992,21 +1478,27 @@ void drawDigit(int digit, int startingX, int startingY)
     }
     else
     {
+      profileEnter(GAME_PROFILE_DRAWING);
       eraseOldBall();
       displayScores();
       drawBall();
       updatePaddlePositions();
       drawPaddles();
       drawNet();
+      profileLeave();
       if (gameMode == 1)
       {
+        profileEnter(GAME_PROFILE_DRAWING);
         drawNet();
+        profileLeave();
+        profileEnter(GAME_PROFILE_PHYSICS);
         detectCollisions();
         updateBall();
+        profileLeave();
         
         updateDisplay();
       }
-      else if ((gameMode == 2) && ((inputCheck(0.4, 0.6, 0)) && (lServe)) || ((inputCheck(0.4, 0.6, 1)) && (!lServe)))
+      else if ((gameMode == 2) && (((inputCheck(40, 60, 0)) && (lServe)) || ((inputCheck(40, 60, 1)) && (!lServe))))
       {
         updateDisplay();
         gameMode = 1;
@@ -1028,16 +1520,18 @@ void drawDigit(int digit, int startingX, int startingY)
   
   void winScreen(void)
   {
-    int winnerNumber;
+    static int winnerNumber; // kept from the entry tick for the colour-cycling redraws
     if (newMode)
     {
+      profileEnter(GAME_PROFILE_DRAWING);
       initGameMatrix();
       winnerNumber = handleWin();
       drawBorders();
+      profileLeave();
       newMode = false;
       startPoint = cycle;
     }
-    else if ((inputCheck(0.1, 0.9, 0) && inputCheck(0.1, 0.9, 1)) && (((cycle - startPoint) / refreshRate) >= screenLength))
+    else if ((inputCheck(10, 90, 0) && inputCheck(10, 90, 1)) && (((cycle - startPoint) / refreshRate) >= screenLength))
     {
       textColour = 'W';
       textBackgroundColour = 'X';
@@ -1053,44 +1547,183 @@ void drawDigit(int digit, int startingX, int startingY)
       textColour = coloursCycle[(winCycle)%7];
       textBackgroundColour = coloursCycle[(winCycle+2)%7];
       borderColour = coloursCycle[(winCycle+1)%7];
+      profileEnter(GAME_PROFILE_DRAWING);
       displayWinner(winnerNumber);
+      profileLeave();
 
     }
     updateDisplay();
   }
 /*
- * main
- * Program entry point for the STM32 target:
- *   - Initialises the LED panel GPIO/ADC via setupPanel() and setupInput().
- *   - Runs an infinite loop that dispatches to the current screen handler based on gameMode.
- *   - Increments the global cycle counter each iteration; cycle is used as a coarse timing source together with refreshRate.
- *
- * The loop never exits on embedded hardware; return 0 is included for completeness.
+ * game_setup
+ * Initialises the LED panel GPIO/ADC via setupPanel() and setupInput(). Called once before the first tick.
+ * GAME_SCANOUT_ISR builds also start the scan timer, which shows the (blank) front page until the first flip.
  */
   
-  int main(void)
+  void game_setup(void)
   {
-    
     setupPanel();
     setupInput();
-    
-    while (true)
+#ifdef GAME_SCANOUT_ISR
+    startScanTimer(scanoutIsr, scanTimerHz);
+#endif
+  }
+/*
+ * game_tick
+ * Runs one iteration of the game loop:
+ *   - Samples both joysticks into inputSnapshot (sampleInput), the only ADC reads of the tick.
+ *   - Dispatches to the current screen handler based on gameMode (each handler also refreshes the panel once).
+ *   - Increments the global cycle counter; cycle is used as a coarse timing source together with refreshRate.
+ */
+  
+  void game_tick(void)
+  {
+    profileTickBegin();
+    sampleInput();
+    if (gameMode == 0)
     {
-      
-      if (gameMode == 0)
-      {
-        startScreen();
-      }
-      else if (gameMode == 3)
+      startScreen();
+    }
+    else if (gameMode == 3)
+    {
+      winScreen();
+    }
+    else
+    {
+      mainGame();
+    }
+    cycle += 1;
+    profileTickEnd();
+  }
+/*
+ * game_cycle
+ * Returns the global cycle counter: the number of game_tick() calls so far, i.e. the index of the tick in progress.
+ * Used by the HAL backends to timestamp recorded input.
+ */
+  
+  int game_cycle(void)
+  {
+    return cycle;
+  }
+/*
+ * game_frame_hash
+ * Returns a 64-bit FNV-1a hash of the gameMatrix bit-planes (every intensity bit of every row), so replays can compare
+ * frames tick by tick without dumping the framebuffer.
+ */
+  
+  uint64_t game_frame_hash(void)
+  {
+    uint64_t hash = 1469598103934665603ull;
+    for (int y = 0; y < panelHeight; y++)
+    {
+      for (int k = 0; k < colourDepth; k++)
       {
-        winScreen();
+        for (int plane = 0; plane < 3; plane++)
+        {
+          uint32_t word = gameMatrix[y][k][plane];
+          for (int b = 0; b < 4; b++)
+          {
+            hash ^= (uint8_t)(word >> (8 * b));
+            hash *= 1099511628211ull;
+          }
+        }
       }
-      else
+    }
+    return hash;
+  }
+/*
+ * game_profile_stats
+ * Summarises the per-tick totals of one phase over the profile window (see the frame profile section): min, mean, max
+ * and the 99th percentile (nearest rank, from a sorted copy of the window), converted from timestamp counts to ns.
+ * Always false without GAME_PROFILE.
+ */
+  
+  bool game_profile_stats(int phase, GameProfileStats* stats)
+  {
+#ifdef GAME_PROFILE
+    if ((phase < 0) || (phase >= GAME_PROFILE_PHASES) || (profileTicks == 0))
+    {
+      return false;
+    }
+    uint32_t count = (profileTicks < GAME_PROFILE_WINDOW) ? profileTicks : GAME_PROFILE_WINDOW;
+    uint32_t sorted[GAME_PROFILE_WINDOW];
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      // insertion sort: the window is small and this only runs when a backend asks
+      uint32_t value = profileWindow[phase][i];
+      uint32_t j = i;
+      while ((j > 0) && (sorted[j - 1] > value))
       {
-        mainGame();
+        sorted[j] = sorted[j - 1];
+        j--;
       }
-      cycle += 1;
+      sorted[j] = value;
+      sum += value;
+    }
+    uint64_t frequency = getTimestampFrequency();
+    #define profileCountsToNs(counts) ((uint32_t)(((uint64_t)(counts) * 1000000000ull) / frequency))
+    stats->samples = count;
+    stats->minNs = profileCountsToNs(sorted[0]);
+    stats->meanNs = profileCountsToNs(sum / count);
+    stats->maxNs = profileCountsToNs(sorted[count - 1]);
+    stats->p99Ns = profileCountsToNs(sorted[(99 * count + 99) / 100 - 1]);
+    #undef profileCountsToNs
+    return true;
+#else
+    (void)phase;
+    (void)stats;
+    return false;
+#endif
+  }
+/*
+ * game_profile_phase_name
+ * Returns the short name of a GameProfilePhase, as used by the emulator page and the native exit report.
+ */
+  
+  const char* game_profile_phase_name(int phase)
+  {
+    static const char* const names[GAME_PROFILE_PHASES] = {"input", "drawing", "physics", "scanout", "delay", "other", "tick"};
+    if ((phase < 0) || (phase >= GAME_PROFILE_PHASES))
+    {
+      return NULL;
+    }
+    return names[phase];
+  }
+/*
+ * game_refresh_stats
+ * Reports the refresh timing (see the refresh timing section): the dwell and scan period the build targets and the scan
+ * period last measured.
+ */
+  
+  void game_refresh_stats(GameRefreshStats* stats)
+  {
+    stats->bitDwellUs = slotDwellUs;
+    stats->targetPeriodUs = targetScanUs;
+    stats->measuredPeriodUs = refreshLastScanUs;
+    stats->scans = refreshScans;
+  }
+
+#ifndef GAME_NO_MAIN
+/*
+ * main
+ * Program entry point for the STM32 and native targets:
+ *   - Initialises the panel and input via game_setup().
+ *   - Runs game_tick() in an infinite loop.
+ *
+ * The loop never exits on embedded hardware; return 0 is included for completeness.
+ * The web emulator builds with GAME_NO_MAIN and drives game_tick() from the browser's main loop instead.
+ */
+  
+  int main(void)
+  {
+    game_setup();
+    
+    while (true)
+    {
+      game_tick();
     }
     
     return 0;
-  }
\ No newline at end of file
+  }
+#endif
@@ -0,0 +1,163 @@
+/*
+  game.h
+
+  What this file does
+  -------------------
+  This header declares the entry points that let a platform drive the game loop in game.c one
+  tick at a time, instead of handing control to the infinite loop in main().
+
+  A tick is one iteration of the original loop: it dispatches to the current screen handler
+  (startScreen, mainGame or winScreen) based on gameMode, which also performs that tick's panel
+  scanout via updateDisplay(), and then advances the global cycle counter.
+
+  Who uses it:
+    - game.c's own main() (STM32 hardware and native builds) calls game_setup() once and then
+      game_tick() forever, exactly as before.
+    - The web emulator compiles game.c with -DGAME_NO_MAIN and calls game_tick() from a browser
+      main loop (emscripten_set_main_loop), so no Asyncify instrumentation is needed.
+    - Host-side drivers (benchmarks, tests, the input replayer) call game_tick() directly to run
+      an exact number of ticks, and can read the tick count and a framebuffer hash back.
+    - Builds with -DGAME_PROFILE time each phase of a tick (input, drawing, physics, scanout,
+      delay) with the HAL's getTimestamp() hook; backends read the results with
+      game_profile_stats(). Without GAME_PROFILE the timing compiles out entirely.
+    - Every build reports its panel refresh rate, target and measured, through
+      game_refresh_stats().
+*/
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  game_setup
+
+  Initialise the panel and input HAL (setupPanel(), setupInput()). Call once before the first
+  game_tick().
+*/
+void game_setup(void);
+
+/*
+  game_tick
+
+  Run one iteration of the game state machine, including one full panel scan, then increment the
+  cycle counter.
+*/
+void game_tick(void);
+
+/*
+  game_cycle
+
+  Return the number of game_tick() calls so far (the game's cycle counter). During a tick this is
+  the index of that tick, which is how recorded input is timestamped (see input_log.h).
+*/
+int game_cycle(void);
+
+/*
+  game_frame_hash
+
+  Return a 64-bit hash of the game's framebuffer (gameMatrix). Replays hash every tick so that two
+  runs can be compared and the first divergent tick found.
+*/
+uint64_t game_frame_hash(void);
+
+/*
+  GameProfilePhase
+
+  Phases of a tick timed in GAME_PROFILE builds. Phases nest (updateDisplay()'s delay_us() calls
+  count as delay, not scanout), so the phases of one tick add up to GAME_PROFILE_TICK:
+
+    GAME_PROFILE_INPUT    sampleInput(): the tick's four ADC reads and their normalising
+    GAME_PROFILE_DRAWING  writing gameMatrix (erasing/drawing ball, paddles, net, scores, screens)
+    GAME_PROFILE_PHYSICS  detectCollisions() and updateBall()
+    GAME_PROFILE_SCANOUT  updateDisplay() (payload rebuild and shifting) excluding its delays
+    GAME_PROFILE_DELAY    delay_us() dwell in the scan loop
+    GAME_PROFILE_OTHER    the rest of the tick (state machine, score checks)
+    GAME_PROFILE_TICK     the whole tick
+*/
+typedef enum {
+  GAME_PROFILE_INPUT,
+  GAME_PROFILE_DRAWING,
+  GAME_PROFILE_PHYSICS,
+  GAME_PROFILE_SCANOUT,
+  GAME_PROFILE_DELAY,
+  GAME_PROFILE_OTHER,
+  GAME_PROFILE_TICK,
+  GAME_PROFILE_PHASES
+} GameProfilePhase;
+
+/*
+  GAME_PROFILE_WINDOW
+
+  Number of most recent ticks the profile statistics cover.
+*/
+#define GAME_PROFILE_WINDOW 256
+
+/*
+  GameProfileStats
+
+  Per-tick time spent in one phase over the last `samples` ticks (at most GAME_PROFILE_WINDOW),
+  in nanoseconds.
+*/
+typedef struct {
+  uint32_t samples;
+  uint32_t minNs;
+  uint32_t meanNs;
+  uint32_t maxNs;
+  uint32_t p99Ns;
+} GameProfileStats;
+
+/*
+  game_profile_stats
+
+  Fill `stats` for `phase` (a GameProfilePhase). Returns false when the build has no GAME_PROFILE,
+  the phase is out of range or no tick has completed yet.
+*/
+bool game_profile_stats(int phase, GameProfileStats* stats);
+
+/*
+  game_profile_phase_name
+
+  Short lower-case name of a phase ("input", "drawing", ..., "tick"), or NULL when out of range.
+*/
+const char* game_profile_phase_name(int phase);
+
+/*
+  GameRefreshStats
+
+  Panel refresh timing in microseconds of the HAL's now_us() clock:
+
+    bitDwellUs        dwell of intensity bit 0 of a row-pair (bit k dwells bitDwellUs << k), set
+                      at build time with -DrowDwellUs=N or -DrefreshRateHz=N (see game.c; the
+                      latter also scans N / 60 times per tick, so the game keeps 60 ticks a second)
+    targetPeriodUs    the dwells of one scan, 16 * (2^colourDepth - 1) * bitDwellUs: the refresh
+                      period the scan is scheduled for, so the target rate is 1e6 / targetPeriodUs
+    measuredPeriodUs  time between the starts of the two most recent scans (0 until two scans
+                      have started); above the target by whatever runs between scans, such as the
+                      game logic when scansPerTick is 1
+    scans             scans started since the program began
+*/
+typedef struct {
+  uint32_t bitDwellUs;
+  uint32_t targetPeriodUs;
+  uint32_t measuredPeriodUs;
+  uint32_t scans;
+} GameRefreshStats;
+
+/*
+  game_refresh_stats
+
+  Fill `stats` with the current refresh timing.
+*/
+void game_refresh_stats(GameRefreshStats* stats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GAME_H
@@ -0,0 +1,249 @@
+/*
+  hal_stats.h
+
+  What this file does
+  -------------------
+  A backend-agnostic counter layer for the panel.h HAL. Every backend (panel_hw.c, panel_emu.c,
+  panel_native.c) owns one global
+
+      HalStats halStats;
+
+  and calls the matching halStats*() recorder at the top of each HAL primitive. The recorders are
+  static inline and only touch integers, so they cost a few instructions per call even on the
+  STM32; on hardware the struct is a plain global that a debugger can read while the game runs
+  (e.g. `print halStats` in gdb), and HalStats.version identifies the layout.
+
+  What is counted
+  ---------------
+  - calls per primitive: PushBit, PushRow, PushColumn, SelectRow, PrepareLatch, LatchRegister,
+    ClearRow, SetOutputEnable, getRawInput and delay_us (delay_ms included). Only calls made by the game are counted:
+    ClearRow's own row select and zero payload are shifted by the backends' internal helpers and
+    show up in the bit/clock totals, not in selectRowCalls/pushRowCalls.
+  - bitsShifted / shiftClocks: data bits and clock pulses sent down the panel chain (one clock per
+    bit on the serial chain, one per six-bit column in PANEL_PARALLEL_SHIFT builds).
+  - wastedBits: bits that were shifted but pushed out of the 192-bit register again before the
+    next latch, so the panel never showed them (e.g. ClearRow's zero payload, which the next
+    PushRow replaces before LatchRegister).
+  - scans: complete scans (all 16 row-pairs latched; back-to-back latches of one row-pair for
+    the BCM intensity bits count once), and rowVisits: latches that moved to a new row-pair.
+  - delayUs / dwellUs: time requested via delay_us() or delay_ms(), in microseconds, and the part
+    of it spent with a row-pair latched (the row's dwell).
+
+  halStatsDerive() turns two snapshots, with the time and the number of game ticks between them,
+  into the rates the tools display: bits and wasted bits per scan, scans per second, dwell per row
+  visit and ADC reads per tick.
+*/
+
+#ifndef HAL_STATS_H
+#define HAL_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAL_STATS_VERSION 2 // 2: delay and dwell in microseconds
+
+// Capacity of the panel's shift-register chain: 2 halves x 3 planes x 32 pixels.
+#define HAL_STATS_REGISTER_BITS 192
+
+#ifdef PANEL_PARALLEL_SHIFT
+#define HAL_STATS_BITS_PER_CLOCK 6
+#else
+#define HAL_STATS_BITS_PER_CLOCK 1
+#endif
+
+/*
+  HalStats
+
+  Cumulative counters since the last halStatsReset(). The fields after `dwellUs` are the layer's
+  own bookkeeping.
+*/
+typedef struct {
+  uint32_t version;
+
+  // Calls made by the game, per primitive.
+  uint64_t pushBitCalls;
+  uint64_t pushRowCalls;
+  uint64_t pushColumnCalls;
+  uint64_t selectRowCalls;
+  uint64_t prepareLatchCalls;
+  uint64_t latches;
+  uint64_t clearRowCalls;
+  uint64_t outputEnableCalls;
+  uint64_t rawInputCalls;
+  uint64_t delayCalls;
+
+  // Derived protocol totals.
+  uint64_t bitsShifted;
+  uint64_t shiftClocks;
+  uint64_t wastedBits;
+  uint64_t scans;
+  uint64_t rowVisits;
+  uint64_t outputEnableToggles;
+  uint64_t delayUs;
+  uint64_t dwellUs;
+
+  uint32_t pendingBits;      // bits shifted since the last latch
+  uint32_t latchedRowMask;   // row-pairs latched in the current scan
+  int32_t selectedRowPair;   // row address driven by the last SelectRow()/ClearRow()
+  int32_t lastLatchedRowPair;
+  bool outputEnabled;
+} HalStats;
+
+/*
+  HalStatsDerived
+
+  Rates between two HalStats snapshots (see halStatsDerive()). A rate whose denominator is zero
+  is reported as 0.
+*/
+typedef struct {
+  double seconds;
+  double scansPerSecond;
+  double latchesPerScan;
+  double bitsPerScan;
+  double wastedBitsPerScan;
+  double clocksPerScan;
+  double dwellMsPerRow;
+  double adcReadsPerTick;
+  double ticks;
+} HalStatsDerived;
+
+/*
+  halStatsReset
+
+  Zero every counter. The output-enable line is assumed on, as every backend's setupPanel()
+  leaves it.
+*/
+static inline void halStatsReset(HalStats* s) {
+  memset(s, 0, sizeof(*s));
+  s->version = HAL_STATS_VERSION;
+  s->lastLatchedRowPair = -1;
+  s->outputEnabled = true;
+}
+
+/*
+  halStatsShift
+
+  Account for `clocks` shift clocks of data (shared by the push recorders).
+*/
+static inline void halStatsShift(HalStats* s, uint32_t clocks) {
+  s->shiftClocks += clocks;
+  s->bitsShifted += (uint64_t)clocks * HAL_STATS_BITS_PER_CLOCK;
+  s->pendingBits += clocks * HAL_STATS_BITS_PER_CLOCK;
+}
+
+static inline void halStatsPushBit(HalStats* s) {
+  s->pushBitCalls++;
+  halStatsShift(s, 1);
+}
+
+static inline void halStatsPushColumn(HalStats* s) {
+  s->pushColumnCalls++;
+  halStatsShift(s, 1);
+}
+
+static inline void halStatsPushRow(HalStats* s) {
+  s->pushRowCalls++;
+  halStatsShift(s, HAL_STATS_REGISTER_BITS / HAL_STATS_BITS_PER_CLOCK);
+}
+
+static inline void halStatsSelectRow(HalStats* s, int row) {
+  s->selectRowCalls++;
+  s->selectedRowPair = (row - 1) & 0x0F;
+}
+
+/*
+  halStatsClearRow
+
+  ClearRow(row): one row select and one full payload of zeros.
+*/
+static inline void halStatsClearRow(HalStats* s, int row) {
+  s->clearRowCalls++;
+  s->selectedRowPair = (row - 1) & 0x0F;
+  halStatsShift(s, HAL_STATS_REGISTER_BITS / HAL_STATS_BITS_PER_CLOCK);
+}
+
+static inline void halStatsPrepareLatch(HalStats* s) {
+  s->prepareLatchCalls++;
+}
+
+/*
+  halStatsLatch
+
+  Count a latch of the selected row-pair: bits beyond the register's capacity since the previous
+  latch were never displayed. Returns true when this latch completes a scan.
+*/
+static inline bool halStatsLatch(HalStats* s) {
+  s->latches++;
+  if (s->pendingBits > HAL_STATS_REGISTER_BITS) {
+    s->wastedBits += s->pendingBits - HAL_STATS_REGISTER_BITS;
+  }
+  s->pendingBits = 0;
+
+  if (s->selectedRowPair == s->lastLatchedRowPair) return false;
+  s->lastLatchedRowPair = s->selectedRowPair;
+  s->rowVisits++;
+
+  s->latchedRowMask |= 1u << s->selectedRowPair;
+  if (s->latchedRowMask != 0xFFFFu) return false;
+  s->latchedRowMask = 0;
+  s->scans++;
+  return true;
+}
+
+static inline void halStatsOutputEnable(HalStats* s, bool enabled) {
+  s->outputEnableCalls++;
+  if (enabled != s->outputEnabled) s->outputEnableToggles++;
+  s->outputEnabled = enabled;
+}
+
+static inline void halStatsRawInput(HalStats* s) {
+  s->rawInputCalls++;
+}
+
+/*
+  halStatsDelay
+
+  A delay of `us` microseconds. Time spent after a latch with the output enabled is that
+  row-pair's dwell.
+*/
+static inline void halStatsDelay(HalStats* s, uint32_t us) {
+  s->delayCalls++;
+  s->delayUs += us;
+  if (s->lastLatchedRowPair >= 0 && s->outputEnabled) s->dwellUs += us;
+}
+
+/*
+  halStatsDerive
+
+  Fill `out` with the rates between snapshots `before` and `after`, taken `seconds` and `ticks`
+  game ticks apart.
+*/
+static inline void halStatsDerive(const HalStats* before, const HalStats* after, double seconds,
+                                  double ticks, HalStatsDerived* out) {
+  const double scans = (double)(after->scans - before->scans);
+  const double visits = (double)(after->rowVisits - before->rowVisits);
+
+  memset(out, 0, sizeof(*out));
+  out->seconds = seconds;
+  out->ticks = ticks;
+  if (seconds > 0) out->scansPerSecond = scans / seconds;
+  if (scans > 0) {
+    out->latchesPerScan = (double)(after->latches - before->latches) / scans;
+    out->bitsPerScan = (double)(after->bitsShifted - before->bitsShifted) / scans;
+    out->wastedBitsPerScan = (double)(after->wastedBits - before->wastedBits) / scans;
+    out->clocksPerScan = (double)(after->shiftClocks - before->shiftClocks) / scans;
+  }
+  if (visits > 0) out->dwellMsPerRow = (double)(after->dwellUs - before->dwellUs) / 1000.0 / visits;
+  if (ticks > 0) out->adcReadsPerTick = (double)(after->rawInputCalls - before->rawInputCalls) / ticks;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // HAL_STATS_H
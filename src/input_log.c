@@ -0,0 +1,182 @@
+/*
+  input_log.c
+
+  What this file does
+  -------------------
+  Implementation of the recorded-input codec declared in input_log.h. It is plain C with no
+  platform dependencies, shared by the emulator (panel_emu.c) and the native backend
+  (panel_native.c and the replayer).
+*/
+
+#include "input_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INPUT_LOG_VERSION 1
+#define INPUT_LOG_HEADER_BYTES 4
+
+#define TAG_CHANNEL_MASK   0x0Fu
+#define TAG_END_CHANNEL    0x0Fu
+#define TAG_CYCLE_ADVANCED 0x10u
+#define TAG_VALUE_REPEATED 0x20u
+
+// -----------------------------------------------------------------------------
+// Writer
+// -----------------------------------------------------------------------------
+
+/*
+  reserveBytes
+
+  Make room for `count` more bytes, doubling the buffer as needed.
+*/
+static bool reserveBytes(InputLogWriter* writer, size_t count) {
+  if (writer->length + count <= writer->capacity) return true;
+
+  size_t capacity = (writer->capacity != 0) ? writer->capacity : 256;
+  while (writer->length + count > capacity) capacity *= 2;
+
+  uint8_t* bytes = (uint8_t*)realloc(writer->bytes, capacity);
+  if (bytes == NULL) return false;
+  writer->bytes = bytes;
+  writer->capacity = capacity;
+  return true;
+}
+
+/*
+  putVarint
+
+  Append an unsigned base-128 varint (at most 5 bytes; room must already be reserved).
+*/
+static void putVarint(InputLogWriter* writer, uint32_t value) {
+  while (value >= 0x80u) {
+    writer->bytes[writer->length++] = (uint8_t)(value | 0x80u);
+    value >>= 7;
+  }
+  writer->bytes[writer->length++] = (uint8_t)value;
+}
+
+void inputLogWriterInit(InputLogWriter* writer) {
+  memset(writer, 0, sizeof(*writer));
+  if (reserveBytes(writer, INPUT_LOG_HEADER_BYTES)) {
+    memcpy(writer->bytes, "PIL", 3);
+    writer->bytes[3] = INPUT_LOG_VERSION;
+    writer->length = INPUT_LOG_HEADER_BYTES;
+  }
+}
+
+void inputLogWriterFree(InputLogWriter* writer) {
+  free(writer->bytes);
+  memset(writer, 0, sizeof(*writer));
+}
+
+/*
+  writeRecord
+
+  Encode a tag with its optional cycle delta and value delta (see the format in input_log.h).
+*/
+static bool writeRecord(InputLogWriter* writer, int32_t cycle, unsigned channel, uint32_t value,
+                        bool hasValue) {
+  if (writer->ended || writer->length == 0 || cycle < writer->lastCycle) return false;
+  if (!reserveBytes(writer, 1 + 5 + 5)) return false;
+
+  uint8_t tag = (uint8_t)channel;
+  if (cycle != writer->lastCycle) tag |= TAG_CYCLE_ADVANCED;
+  if (hasValue && value == writer->lastValue[channel]) tag |= TAG_VALUE_REPEATED;
+
+  writer->bytes[writer->length++] = tag;
+  if (tag & TAG_CYCLE_ADVANCED) {
+    putVarint(writer, (uint32_t)(cycle - writer->lastCycle));
+    writer->lastCycle = cycle;
+  }
+  if (hasValue && !(tag & TAG_VALUE_REPEATED)) {
+    const int32_t delta = (int32_t)(value - writer->lastValue[channel]);
+    putVarint(writer, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31)); // zigzag
+    writer->lastValue[channel] = value;
+  }
+  return true;
+}
+
+bool inputLogWrite(InputLogWriter* writer, int32_t cycle, int channel, uint32_t value) {
+  if (channel < 0 || channel >= INPUT_LOG_CHANNELS) return false;
+  return writeRecord(writer, cycle, (unsigned)channel, value, true);
+}
+
+bool inputLogWriteEnd(InputLogWriter* writer, int32_t cycle) {
+  if (!writeRecord(writer, cycle, TAG_END_CHANNEL, 0, false)) return false;
+  writer->ended = true;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Reader
+// -----------------------------------------------------------------------------
+
+/*
+  getVarint
+
+  Decode an unsigned varint. Returns false on truncation or overlong encodings.
+*/
+static bool getVarint(InputLogReader* reader, uint32_t* value) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (reader->position >= reader->length) return false;
+    const uint8_t byte = reader->bytes[reader->position++];
+    result |= (uint32_t)(byte & 0x7Fu) << shift;
+    if (!(byte & 0x80u)) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool inputLogReaderInit(InputLogReader* reader, const uint8_t* bytes, size_t length) {
+  memset(reader, 0, sizeof(*reader));
+  if (length < INPUT_LOG_HEADER_BYTES || memcmp(bytes, "PIL", 3) != 0 ||
+      bytes[3] != INPUT_LOG_VERSION) {
+    return false;
+  }
+  reader->bytes = bytes;
+  reader->length = length;
+  reader->position = INPUT_LOG_HEADER_BYTES;
+  return true;
+}
+
+int inputLogRead(InputLogReader* reader, InputLogRecord* record) {
+  if (reader->ended) return 0;
+  if (reader->position >= reader->length) {
+    reader->ended = true;
+    // Cut short (no end record): cover the last tick that has readings.
+    reader->endCycle = reader->lastCycle + 1;
+    return 0;
+  }
+
+  const uint8_t tag = reader->bytes[reader->position++];
+  if (tag & ~(TAG_CHANNEL_MASK | TAG_CYCLE_ADVANCED | TAG_VALUE_REPEATED)) return -1;
+
+  if (tag & TAG_CYCLE_ADVANCED) {
+    uint32_t delta;
+    if (!getVarint(reader, &delta)) return -1;
+    reader->lastCycle += (int32_t)delta;
+  }
+
+  const unsigned channel = tag & TAG_CHANNEL_MASK;
+  if (channel == TAG_END_CHANNEL) {
+    reader->endCycle = reader->lastCycle;
+    reader->ended = true;
+    return 0;
+  }
+
+  if (!(tag & TAG_VALUE_REPEATED)) {
+    uint32_t zigzag;
+    if (!getVarint(reader, &zigzag)) return -1;
+    const uint32_t delta = (zigzag >> 1) ^ (0u - (zigzag & 1u));
+    reader->lastValue[channel] += delta;
+  }
+
+  record->cycle = reader->lastCycle;
+  record->channel = (int)channel;
+  record->value = reader->lastValue[channel];
+  return 1;
+}
@@ -0,0 +1,137 @@
+/*
+  input_log.h
+
+  What this file does
+  -------------------
+  This header declares a compact binary codec for recorded joystick input: the stream of
+  (cycle, channel, value) readings the game takes through getRawInput() in panel.h.
+
+  Because the game logic is deterministic (fixed-point physics, integer input handling), the
+  readings taken since game_setup() are all that is needed to reproduce a session exactly. The
+  backends record at the getRawInput() boundary:
+
+    - panel_emu.c records every session from boot; the page's "Save input" button downloads it.
+    - panel_native.c records when PANEL_NATIVE_RECORD names an output file.
+
+  and native/src/replay.c (bin/pong_replay) feeds a stream back with delays disabled, hashing
+  each frame so that two runs can be compared tick by tick.
+
+  Stream format
+  -------------
+  A 4-byte header ("PIL" + version 1), then one record per reading. Each record starts with a tag
+  byte:
+
+    bits 0..3  channel (0..14; 15 marks the end record)
+    bit 4      the cycle advanced: a varint cycle delta follows
+    bit 5      the value is the same as the previous value on this channel: no value follows
+               (otherwise a zigzag varint of the value delta follows)
+
+  Varints are little-endian base-128. A steady joystick therefore costs one byte per reading.
+  The end record carries the cycle at which recording stopped, so a replay knows how many ticks
+  to run after the last reading.
+*/
+
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+  INPUT_LOG_CHANNELS
+
+  Number of ADC channel identifiers the format can carry (0..14); 15 is the end marker.
+*/
+#define INPUT_LOG_CHANNELS 15
+
+/*
+  InputLogRecord
+
+  One decoded reading: getRawInput(channel) returned `value` during game cycle `cycle`.
+*/
+typedef struct {
+  int32_t cycle;
+  int channel;
+  uint32_t value;
+} InputLogRecord;
+
+/*
+  InputLogWriter
+
+  Growable in-memory encoder. Zero-initialise (or call inputLogWriterInit()) before use.
+*/
+typedef struct {
+  uint8_t* bytes;
+  size_t length;
+  size_t capacity;
+  int32_t lastCycle;
+  uint32_t lastValue[INPUT_LOG_CHANNELS];
+  bool ended;
+} InputLogWriter;
+
+/*
+  InputLogReader
+
+  Decoder over a complete stream held in memory (the bytes are not copied).
+*/
+typedef struct {
+  const uint8_t* bytes;
+  size_t length;
+  size_t position;
+  int32_t lastCycle;
+  uint32_t lastValue[INPUT_LOG_CHANNELS];
+  int32_t endCycle; // valid once inputLogRead() has returned 0
+  bool ended;
+} InputLogReader;
+
+/*
+  inputLogWriterInit / inputLogWriterFree
+
+  Start an empty stream (writes the header) / release the writer's buffer.
+*/
+void inputLogWriterInit(InputLogWriter* writer);
+void inputLogWriterFree(InputLogWriter* writer);
+
+/*
+  inputLogWrite
+
+  Append one reading. Cycles must not decrease and channels must be below INPUT_LOG_CHANNELS.
+  Returns false (and appends nothing) if the reading cannot be encoded or memory runs out.
+*/
+bool inputLogWrite(InputLogWriter* writer, int32_t cycle, int channel, uint32_t value);
+
+/*
+  inputLogWriteEnd
+
+  Append the end record for a recording that stopped at `cycle` (the number of game ticks run).
+  No further readings can be written afterwards.
+*/
+bool inputLogWriteEnd(InputLogWriter* writer, int32_t cycle);
+
+/*
+  inputLogReaderInit
+
+  Bind a reader to `length` bytes of stream. Returns false if the header is missing or has an
+  unsupported version.
+*/
+bool inputLogReaderInit(InputLogReader* reader, const uint8_t* bytes, size_t length);
+
+/*
+  inputLogRead
+
+  Decode the next reading into `record`. Returns 1 for a reading, 0 at the end record and -1 if
+  the stream is corrupt. A stream that was cut short (no end record) also ends with 0, with
+  endCycle covering the last tick that has readings.
+*/
+int inputLogRead(InputLogReader* reader, InputLogRecord* record);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // INPUT_LOG_H
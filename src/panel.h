@@ -11,31 +11,77 @@
   At build time you choose exactly one implementation file that provides these
   functions:
 
-    - panel_hw.c   : STM32/libopencm3 implementation (real GPIO + ADC)
-    - panel_emu.c  : Web/WASM implementation (browser canvas + JS-controlled inputs)
+    - panel_hw.c     : STM32/libopencm3 implementation (real GPIO + ADC); with PANEL_HW_INLINE
+                       the shift primitives come from panel_hw_inline.h instead (see the end of
+                       this file)
+    - panel_emu.c    : Web/WASM implementation (browser canvas + JS-controlled inputs)
+    - panel_native.c : native host implementation (headless, for benchmarks and CI)
 
   This interface intentionally excludes any higher-level rendering helper such as
   updateDisplay(). Instead, it provides the low-level operations that the existing
-  coursework code already uses (PrepareLatch, PushBit, SelectRow, LatchRegister, etc.).
+  coursework code already uses (PrepareLatch, PushBit, SelectRow, LatchRegister, etc.), plus
+  PushRow() which shifts a whole packed row-pair payload in one call and SetOutputEnable()
+  which blanks the LED drivers.
+
+  Shift wiring (build-time choice)
+  --------------------------------
+  By default the panel's data input is one serial chain (INP_PIN): all 192 bits of a row-pair go
+  through a single data line, 192 clocks per row-pair.
+
+  Defining PANEL_PARALLEL_SHIFT (for every file of a build) selects HUB75-style wiring instead:
+  six data lines R1,G1,B1 (top row) and R2,G2,B2 (bottom row) are sampled on every clock, so a
+  row-pair takes 32 clocks, one per pixel column. PushColumn() is the primitive for that wiring,
+  and PushRow() is implemented on top of it with the same payload format, so the game's scan loop
+  is unchanged.
 
   Important behavioural notes
   ---------------------------
   - The physical panel is multiplexed: at any instant a single row address selects a
     *pair* of rows (one in the top half, one in the bottom half). The game code loads
     192 bits (2 halves * 3 colour planes * 32 pixels) and then latches them.
-  - delay_ms() must be non-blocking in the browser build (implemented in panel_emu.c)
-    so the UI thread remains responsive.
+  - delay_ms() and delay_us() must be non-blocking in the browser build (implemented in
+    panel_emu.c) so the UI thread remains responsive.
 */
 
 #ifndef PANEL_API_H
 #define PANEL_API_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+  PANEL_ROW_WORDS
+
+  Number of 32-bit words in a packed row-pair payload (192 bits). Word w holds the bits that
+  would otherwise be pushed as bits 32*w .. 32*w+31, least significant bit first. With the game's
+  bit order this is one colour plane per word:
+
+    word 0: top row red     word 3: bottom row red
+    word 1: top row green   word 4: bottom row green
+    word 2: top row blue    word 5: bottom row blue
+
+  and bit x of each word is pixel x.
+*/
+#define PANEL_ROW_WORDS 6
+
+/*
+  PANEL_COLUMN_*
+
+  Bit assignment of the six-bit column value taken by PushColumn() (PANEL_PARALLEL_SHIFT builds).
+  Bit c carries payload word c's bit for that column, so the data lines follow the same order as
+  the PANEL_ROW_WORDS planes.
+*/
+#define PANEL_COLUMN_R1 0x01u
+#define PANEL_COLUMN_G1 0x02u
+#define PANEL_COLUMN_B1 0x04u
+#define PANEL_COLUMN_R2 0x08u
+#define PANEL_COLUMN_G2 0x10u
+#define PANEL_COLUMN_B2 0x20u
+
 /*
   setupPanel
 
@@ -72,15 +118,62 @@ uint32_t getRawInput(int channelValue);
 /*
   delay_ms
 
-  Pause execution for approximately `ms` milliseconds.
+  Pause execution for `ms` milliseconds; the same as delay_us(ms * 1000).
 
-  On hardware this is typically a busy-wait (coarse timing).
   In the emulator this must yield control back to the browser event loop so that rendering
   and input continue to work. The panel_emu.c implementation uses Emscripten-friendly
   yielding.
 */
 void delay_ms(uint32_t ms);
 
+/*
+  delay_us / now_us
+
+  delay_us() pauses execution for `us` microseconds, and now_us() reads a monotonic microsecond
+  clock that wraps at 2^32 (about 71 minutes); the unsigned difference of two readings is the time
+  between them. A delay_us() advances now_us() by at least `us`. The game schedules each row's
+  dwell against now_us() (see scanPanel() in game.c), so the panel refreshes at an exact target
+  rate whatever the shifting costs.
+
+  On hardware both are calibrated from the DWT cycle counter at the CPU clock (rcc_ahb_frequency),
+  and delay_us() busy-waits. The native backend reads CLOCK_MONOTONIC and sleeps. The emulator's
+  clock is its virtual clock, which delay_us() advances (so now_us() is simulated time).
+*/
+void delay_us(uint32_t us);
+uint32_t now_us(void);
+
+/*
+  getTimestamp / getTimestampFrequency
+
+  Read a free-running 32-bit timestamp counter, and its rate in counts per second. The difference
+  of two readings (unsigned, so wrap-around is harmless) times an interval of up to a few seconds.
+  The game uses this for its optional per-phase profile (GAME_PROFILE builds, see game.h).
+
+  On hardware this is the Cortex-M DWT cycle counter (CPU clock). The emulator counts the browser's
+  high-resolution clock in microseconds and the native backend CLOCK_MONOTONIC in nanoseconds.
+*/
+uint32_t getTimestamp(void);
+uint32_t getTimestampFrequency(void);
+
+/*
+  startScanTimer / waitForInterrupt
+
+  startScanTimer() calls `handler` from a periodic timer interrupt, `frequencyHz` times per second,
+  from then on. The game's GAME_SCANOUT_ISR builds scan the panel from this handler (one row-pair
+  slot per interrupt) while game_tick() runs; the handler may preempt the game at any point, so
+  data shared with it must be published with care (see flipPages() in game.c).
+
+  waitForInterrupt() sleeps until the next interrupt has run; it may also return early. The game
+  calls it in a loop while it waits for the handler to make progress.
+
+  On hardware the timer is TIM2's update interrupt and the wait is WFI. The native backend
+  simulates the timer with a POSIX interval timer, whose signal preempts the game like an
+  interrupt. The emulator runs the handler from waitForInterrupt() and advances its virtual clock
+  one period per call.
+*/
+void startScanTimer(void (*handler)(void), uint32_t frequencyHz);
+void waitForInterrupt(void);
+
 /*
   PrepareLatch
 
@@ -125,22 +218,90 @@ void SelectRow(int row);
   The game code calls PushBit many times (192 bits per row-pair) to load the colour planes.
   On hardware this toggles GPIO pins for the data line and clock.
   In the emulator this appends the bit into an emulated shift-register buffer.
+
+  In PANEL_PARALLEL_SHIFT builds there is no single data line; PushBit() clocks one column with
+  `onoff` on all six data lines.
 */
 void PushBit(int onoff);
 
+/*
+  PushRow
+
+  Shift a complete packed row-pair payload (PANEL_ROW_WORDS words, see above) into the panel's
+  shift-register chain.
+
+  This is behaviourally identical to calling PushBit() 192 times in payload order, and is the
+  entry point the game's scan loop uses. Each backend implements it as a single tight loop (or,
+  in the emulators, as a few word copies) instead of 192 out-of-line PushBit() calls. PushBit()
+  remains available as the compatibility path.
+
+  In PANEL_PARALLEL_SHIFT builds the same payload is sent as 32 PushColumn() clocks (column x
+  carries bit x of every payload word), leaving the panel in the same state.
+*/
+void PushRow(const uint32_t payload[PANEL_ROW_WORDS]);
+
+#ifdef PANEL_PARALLEL_SHIFT
+/*
+  PushColumn
+
+  Clock one pixel column into the six parallel data chains (PANEL_PARALLEL_SHIFT builds only).
+  `rgb6` holds the R1,G1,B1,R2,G2,B2 bits (PANEL_COLUMN_*); the first column pushed after a latch
+  ends up at pixel 0 once 32 columns have been clocked in.
+
+  On hardware the six data pins are written with a single port write per clock.
+*/
+void PushColumn(uint8_t rgb6);
+#endif
+
 /*
   ClearRow
 
   Clear a specific row address by shifting zeros for a full row payload.
 
-  The coursework hardware implementation selects a row and then pushes 192 zero bits. The
+  The coursework hardware implementation selects a row and then pushes 192 zero bits (32 zero
+  columns in PANEL_PARALLEL_SHIFT builds). The
   emulator mirrors that behaviour so that game logic that assumes the clear occurs remains
   consistent.
 */
 void ClearRow(int row);
 
+/*
+  SetOutputEnable
+
+  Drive the panel's output-enable (OE) line. While output is disabled every LED is blanked,
+  regardless of the latched data and the selected row address; re-enabling shows the latched
+  data of the selected row-pair again.
+
+  This lets the scan loop hide address changes and latches without shifting a row of zeros
+  first (see scanBlankMode in game.c). On hardware OE is active-low (disabled = pin high).
+  Output is enabled after setupPanel().
+*/
+void SetOutputEnable(bool enabled);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
 
+/*
+  PANEL_HW_INLINE (STM32 builds)
+
+  Replaces the out-of-line shift primitives with the header-only register-store versions in
+  hardware/panel_hw_inline.h, so the game's scan loop inlines them. The names are mapped after the
+  prototypes above, which keeps panel_hw.c's out-of-line definitions valid; game code calls them
+  as before.
+*/
+#ifdef PANEL_HW_INLINE
+#include "panel_hw_inline.h"
+#define PrepareLatch panelHwPrepareLatch
+#define LatchRegister panelHwLatchRegister
+#define SelectRow panelHwSelectRow
+#define PushBit panelHwPushBit
+#define PushRow panelHwPushRow
+#ifdef PANEL_PARALLEL_SHIFT
+#define PushColumn panelHwPushColumn
+#endif
+#define ClearRow panelHwClearRow
+#define SetOutputEnable panelHwSetOutputEnable
+#endif
+
 #endif // PANEL_API_H